@@ -238,6 +238,46 @@ namespace yask {
                                       when the expression is valid
                                       or `nullptr` to remove the condition. */ ) =0;
 
+        /// Bitmask for sum reduction. Same value as yk_var::yk_sum_reduction.
+        static constexpr int yc_sum_reduction = 0x01;
+
+        /// Bitmask for sum-of-squares reduction. Same value as yk_var::yk_sum_squares_reduction.
+        static constexpr int yc_sum_squares_reduction = 0x02;
+
+        /// Bitmask for maximum-value reduction. Same value as yk_var::yk_max_reduction.
+        static constexpr int yc_max_reduction = 0x08;
+
+        /// Bitmask for minimum-value reduction. Same value as yk_var::yk_min_reduction.
+        static constexpr int yc_min_reduction = 0x10;
+
+        /// Request reductions of the values written by this equation.
+        /**
+           The generated kernel accumulates the requested reductions of
+           the values as they are computed, avoiding a separate pass over
+           the var.  The results are available after each call to
+           yk_solution::run_solution() via
+           yk_solution::get_reduction_result() for the var on the LHS.
+           If more than one equation writing the same var requests
+           reductions, the results are combined.
+
+           Typical C++ usage to track the energy and peak amplitude of a wavefield:
+
+           \code{.cpp}
+           auto eq = p(t+1, x, y, z) EQUALS next_p;
+           eq->set_reductions(yc_equation_node::yc_sum_squares_reduction |
+                              yc_equation_node::yc_max_reduction);
+           \endcode
+
+           Reductions are not allowed on equations that update scratch vars.
+        */
+        virtual void set_reductions(int reduction_mask
+                                    /**< [in] Bit-wise OR of the desired reduction masks
+                                       or zero (0) to disable reductions. */ ) =0;
+
+        /// Get the requested reductions.
+        /** @returns Bit-wise OR of the reduction masks set via set_reductions(). */
+        virtual int get_reductions() const =0;
+
         /// Create a deep copy of AST starting with this node.
         virtual yc_equation_node_ptr clone_ast() const =0;
     };
@@ -56,6 +56,21 @@ namespace yask {
     */
     const int yask_numa_interleave = -2;
 
+    /// Allocate each var in slabs on the NUMA nodes of the threads that compute them.
+    /**
+       The outermost domain dimension in the memory layout of each var is
+       divided into slabs that match the assignment of blocks to outer
+       OpenMP threads, and the pages of each slab are bound to the NUMA
+       node of its thread.
+       When any var uses this policy, blocks are assigned to outer
+       threads statically instead of dynamically so that the mapping
+       does not change between steps.
+       This is used in yk_solution::set_default_numa_preferred
+       and yk_var::set_numa_preferred.
+       In Python, specify as `yask_kernel.cvar.yask_numa_slabs`.
+    */
+    const int yask_numa_slabs = -3;
+
     /// Do not specify any NUMA binding.
     /**
        This is used in yk_solution::set_default_numa_preferred
@@ -799,6 +814,130 @@ namespace yask {
         virtual void
         exchange_halos() =0;
 
+        /// Write the state of the solution to a checkpoint file.
+        /**
+           Writes the contents of all allocated steps of every var,
+           the number of steps done, the valid step range of each var,
+           and the domain sizes and offsets of this rank.
+           Var data is written directly from the storage buffers (see
+           yk_var::get_raw_storage_buffer()), including padding.
+           The `-ckpt_codec xor` option compresses this data losslessly;
+           the lossy 'fixed' snapshot codec cannot be used for checkpoints.
+
+           When running on more than one rank, each rank writes its own
+           file named `file_name` with ".rank" and the rank index appended.
+
+           If the `-mpi_io` option is set, all ranks instead write one shared
+           file named `file_name` using collective MPI-IO.
+           That file contains a header describing the domain and each var,
+           followed by the global array of each var: the elements
+           (without padding) in row-major order of the var's dims, including
+           the halos outside of the overall domain and all valid steps.
+           Each array starts at a 4KiB-aligned byte offset given in the header.
+
+           This function should be called only *after* calling prepare_solution().
+        */
+        virtual void
+        write_checkpoint(const std::string& file_name
+                         /**< [in] Name of file to write. */ ) =0;
+
+        /// Restore the state of the solution from a checkpoint file.
+        /**
+           Reads a file written by write_checkpoint() and restores the var
+           contents, valid step ranges, and number of steps done.
+           The solution must have the same stencil, element size, number of ranks,
+           domain sizes, and var sizes (including padding) as the one that wrote the
+           checkpoint; an exception is thrown otherwise.
+           A shared file written with `-mpi_io` is detected automatically
+           and has fewer restrictions: it does not depend on padding or on
+           the number and layout of the ranks.  Each rank reads only the part
+           of each var in its own rank domain, so a run may be restarted on
+           a different number of ranks, e.g., to move to a smaller or larger
+           allocation; only the stencil, element size, and overall domain
+           sizes must match.  Without MPI support, it is read by the single rank
+           using plain file I/O.
+
+           This function should be called only *after* calling prepare_solution().
+        */
+        virtual void
+        read_checkpoint(const std::string& file_name
+                        /**< [in] Name of file to read. */ ) =0;
+
+        /// Wait until all pending snapshots have been written.
+        /**
+           Snapshots of the vars listed in the `-snapshot_vars` option
+           are copied to a staging area after each call to run_solution()
+           that ends at a multiple of `-snapshot_interval`.
+           They are written to files by a background thread while
+           the next steps are computed, using two staging areas so
+           a new snapshot can be taken while the previous one is written.
+           This function blocks until the background writes are done.
+           It is also called by end_solution().
+           An exception is thrown if any write failed.
+
+           Per-rank files may be compressed by the background thread with the
+           `-snapshot_codec` option; see read_snapshot() to read them back.
+           The 'xor' codec is lossless.  The 'fixed' codec is lossy block
+           quantization: each block of 64 values in row-major order is
+           scaled by its largest magnitude and rounded to `-snapshot_rate`
+           bits per value, so small values next to large ones lose the most
+           precision.  It is only available for snapshots, not checkpoints.
+
+           If the `-mpi_io` option is set, all ranks write each var at each
+           snapshot step to one shared file using collective MPI-IO.
+           The file contains only the elements in the overall domain in
+           row-major order of the var's dims, as if written by one rank.
+           If the MPI library does not support `MPI_THREAD_MULTIPLE`, these
+           writes are done by the calling thread instead of in the background.
+        */
+        virtual void
+        flush_snapshots() =0;
+
+        /// Read a snapshot file back into a var.
+        /**
+           Reads the file written for `var_name` at `step_index` using the
+           current `-snapshot_prefix` and `-mpi_io` settings and copies
+           its contents into the rank domain of the var at that step.
+           Files compressed with the `-snapshot_codec` option are decoded;
+           values from the lossy 'fixed' codec are approximate.
+           Any pending snapshots are written first.
+           If `-mpi_io` is set, this must be called on all ranks.
+
+           This function should be called only *after* calling prepare_solution().
+        */
+        virtual void
+        read_snapshot(const std::string& var_name
+                      /**< [in] Name of var to read. */,
+                      idx_t step_index
+                      /**< [in] Step index of snapshot. Ignored if the var has no step dim. */ ) =0;
+
+        /// Get the fused reductions of a var from the most recent run.
+        /**
+           Returns the reductions requested in the stencil via
+           yc_equation_node::set_reductions() for the values written
+           to `var_name` during the last step of the most recent call to
+           run_solution().
+           For example, after `run_solution(1, 10)`, the results
+           cover the values written to step 11 (or to step 10 for
+           a stencil that steps backward).
+           The reductions are computed while the stencil is evaluated,
+           so the var does not have to be read again.
+           Only points in the overall domain are included,
+           and the results are combined across all ranks.
+           Results are for the elements computed by the equations that
+           requested them; for equations with sub-domain or step
+           conditions, this may be a subset of the domain.
+           The number of elements reduced is available via
+           yk_var::yk_reduction_result::get_num_elements_reduced().
+
+           This function should be called only *after* calling run_solution().
+           @returns Pointer to the result object.
+        */
+        virtual yk_var::yk_reduction_result_ptr
+        get_reduction_result(const std::string& var_name
+                             /**< [in] Name of var written by
+                                the equation(s) with reductions. */ ) const =0;
+
         /// Finish using a solution.
         /**
            Releases shared ownership of memory used by the vars.  This will
@@ -1119,6 +1258,9 @@ namespace yask {
                                       local-node allocation,
                                       `yask_numa_interleave` for
                                       interleaving pages across all nodes,
+                                      `yask_numa_slabs` for placing slabs of
+                                      each var on the nodes of the threads
+                                      that compute them,
                                       or `yask_numa_none` for no explicit NUMA
                                       policy. These constants are defined in
                                       the _Variable Documentation_ section of
@@ -1195,6 +1337,48 @@ namespace yask {
         virtual void
         call_after_run_solution(hook_fn_2idx_t hook_fn
                                 /**< [in] callback function */) =0;
+
+        /// **[Advanced]** Visit the steps of a forward run in reverse order.
+        /**
+           Calls `adjoint_fn` for each step index from `last_step_index`
+           down to `first_step_index`, e.g., to run the adjoint of the
+           stencils for reverse-time migration.  Before each call, the
+           vars have the same values they had just before
+           run_solution() computed that step during a forward run from
+           `first_step_index`, i.e., the values at that step index are valid.
+           The step index is passed as both index parameters to `adjoint_fn`.
+
+           The current state of the vars must be the one at `first_step_index`.
+           Storing the state at every step is usually infeasible, so the
+           states at only some steps are saved, and the steps in between are
+           recomputed from them as needed.  Up to `-rev_mem_states` states are
+           kept in memory and `-rev_disk_states` more in checkpoint files
+           (see write_checkpoint()).  The steps at which states are saved
+           are chosen with the binomial ("revolve") schedule, which minimizes
+           the number of forward steps recomputed for the number of states
+           allowed.  For example, 1000 steps with 8 states need about
+           5 forward steps per step instead of 500 with no saved states.
+
+           Only the vars listed in the `-rev_vars` option are saved and
+           restored, or, if that list is empty, the vars updated by the
+           stencils.  Other vars keep the values set by `adjoint_fn`
+           across calls, so adjoint values can be accumulated in them,
+           e.g., in vars created with new_var().  Forward steps are
+           recomputed with the current values of those other vars.
+
+           When this returns, the vars are not in a defined state.
+           The hook functions registered with call_before_run_solution() and
+           call_after_run_solution() are called for each forward run.
+
+           @note Not available in the Python API.
+        */
+        virtual void
+        run_reverse(idx_t first_step_index
+                    /**< [in] First index in the step dimension */,
+                    idx_t last_step_index
+                    /**< [in] Last index in the step dimension */,
+                    hook_fn_2idx_t adjoint_fn
+                    /**< [in] Function called for each step */ ) =0;
         #endif
         
         /// **[Advanced]** Merge YASK variables with another solution.
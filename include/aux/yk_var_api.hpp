@@ -1075,7 +1075,137 @@ namespace yask {
                                  /**< [in] If true, indices must be within domain or padding.
                                     If false, only elements within the allocation of this var
                                     will be evaluated, and elements outside will be ignored. */ ) =0;
-        
+
+        /// Perform requested reductions over elements of a slice in all ranks.
+        /**
+           Like reduce_elements_in_slice(), but the slice may span the domains
+           of any number of MPI ranks, and the result contains the reductions
+           over all of them. Each rank reduces the elements of the slice in its
+           own domain, so halo and padding elements are never included and
+           no element is counted twice. The per-rank results are then
+           combined with `MPI_Allreduce()`, so all ranks get the same result.
+
+           Within each rank, whole SIMD vectors are reduced with vector operations
+           using the var's fold layout, and the results are accumulated
+           in double precision.
+
+           Indices are relative to the *overall* problem domain.
+           Indices in the domain dimensions may cover any part of the overall domain.
+           Indices in the other dimensions must be valid in every rank.
+           A var without all the domain dimensions is reduced only once
+           along each of its missing dimensions.
+           A var created with yk_solution::new_fixed_size_var() is reduced
+           only within each rank, since its elements are not shared.
+
+           This must be called on all ranks with the same arguments.
+
+           @returns Shared pointer to reduction result.
+
+           @throws yask_exception if storage has not been allocated.
+           @throws yask_exception if any non-domain index is not valid.
+        */
+        virtual yk_reduction_result_ptr
+        reduce_elements_in_global_slice(int reduction_mask /**< [in] Bit-wise OR of the desired reduction masks. */,
+                                        const idx_t_vec& first_indices
+                                        /**< [in] List of initial indices, one for each var dimension. */,
+                                        const idx_t_vec& last_indices
+                                        /**< [in] List of final indices, one for each var dimension. */ ) =0;
+
+        /// Interpolation type for new_point_set(): value at nearest element.
+        static constexpr int yk_nearest_interp = 0;
+
+        /// Interpolation type for new_point_set(): multi-linear interpolation
+        /// between the 2 nearest elements in each domain dim.
+        static constexpr int yk_linear_interp = 1;
+
+        /// Interpolation type for new_point_set(): Kaiser-windowed sinc
+        /// interpolation over the 8 nearest elements in each domain dim.
+        static constexpr int yk_sinc_interp = 2;
+
+        /// A set of points at arbitrary positions in a var.
+        /**
+           Created by new_point_set().
+           Used to add values at many points (e.g., to inject seismic
+           sources) and to get values at many points (e.g., to record
+           receivers) in one parallel pass each instead of one API call
+           per element.
+           The elements touched by each point and the interpolation weights
+           are found once when the set is created.
+        */
+        class yk_point_set {
+        public:
+            virtual ~yk_point_set() {}
+
+            /// Get the number of points.
+            /**
+               @returns Number of points in the set on all ranks.
+            */
+            virtual idx_t
+            get_num_points() const =0;
+
+            /// Get the number of points that touch elements in this rank's domain.
+            /**
+               @returns Number of points with at least one element with a non-zero
+               weight in this rank's domain.
+            */
+            virtual idx_t
+            get_num_local_points() const =0;
+
+            /// Add values at all points.
+            /**
+               The value for each point is multiplied by each of its interpolation
+               weights and added to the corresponding elements at `step_index`,
+               i.e., it is distributed to the elements around the point.
+               Each rank updates only the elements in its own domain; others
+               are updated by the next halo exchange.
+               All points must be given on all ranks.
+               `step_index` is ignored if the var does not use the step dim.
+               @returns Number of elements updated on this rank.
+            */
+            virtual idx_t
+            add_to_elements(const double* vals
+                            /**< [in] Pointer to one value per point. */,
+                            idx_t step_index
+                            /**< [in] Step index of elements to update. */ ) =0;
+
+            /// Get interpolated values at all points.
+            /**
+               The value for each point is the weighted sum of the elements around it
+               at `step_index`.
+               When using MPI, the parts of the sums from each rank are added
+               across all ranks, so this must be called on all ranks, and
+               every rank gets all values.
+               `step_index` is ignored if the var does not use the step dim.
+            */
+            virtual void
+            get_elements(double* vals
+                         /**< [out] Pointer to space for one value per point. */,
+                         idx_t step_index
+                         /**< [in] Step index of elements to read. */ ) const =0;
+        };
+
+        /// Shared pointer to \ref yk_point_set.
+        typedef std::shared_ptr<yk_point_set> yk_point_set_ptr;
+
+        /// Create a set of points for batched updates and interpolation.
+        /**
+           Provide the position of each point as one real-valued index per
+           domain dim, in the order returned by yk_solution::get_domain_dim_names(),
+           so `coords` holds `num_points * num_domain_dims` values.
+           Positions are relative to the *overall* problem domain, so a point at
+           index 2.5 in a dim lies halfway between elements 2 and 3.
+           Elements outside the overall domain are ignored.
+           The var must not have any misc dims or be a material-index var,
+           and its storage must be allocated.
+           The set must be re-created if the storage is re-allocated.
+           @returns Shared pointer to new point set.
+        */
+        virtual yk_point_set_ptr
+        new_point_set(const std::vector<double>& coords
+                      /**< [in] Positions of the points. */,
+                      int interp_type = yk_linear_interp
+                      /**< [in] One of the `yk_*_interp` types. */ ) =0;
+
         /// Format the indices for human-readable display.
         /**
            Provide indices in a list in the same order returned by get_dim_names().
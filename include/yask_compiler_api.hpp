@@ -846,6 +846,39 @@ namespace yask {
         set_step_alloc_size(idx_t size
                             /**< [in] Number of elements to allocate in the step dimension. */) =0;
 
+        /// **[Advanced]** Get the number of bytes in each element of a material-index var.
+        /**
+           See set_material_index_bytes().
+           @returns Number of bytes in each element or zero if this is
+           not a material-index var.
+        */
+        virtual int
+        get_material_index_bytes() const =0;
+
+        /// **[Advanced]** Store small integer material indices in this var.
+        /**
+           A material-index var stores an unsigned 8-bit or 16-bit integer
+           in each element instead of a floating-point value.
+           It is intended for piecewise-constant models with a limited
+           number of materials:
+           the index var is read to select an entry in a parameter table,
+           which is a var with a misc dimension, e.g.,
+           `vel(mat(x, y, z))`, where `mat` is the material-index var
+           and `vel` is a var with one misc dimension.
+           The parameter table is allocated to cover all possible index values,
+           so it never needs to be resized.
+
+           A material-index var cannot be written by any equation,
+           and it is never vector-folded.
+           Its values are set from the kernel via the usual \ref yk_var APIs;
+           values are truncated to integers and clamped to the range
+           of the index type, e.g., 0 to 255 for 1-byte indices.
+        */
+        virtual void
+        set_material_index_bytes(int nbytes
+                                 /**< [in] Number of bytes in each element:
+                                    1, 2, or 0 to store floating-point values as usual. */) =0;
+
         /// **[Deprecated]** Use new_var_point().
         YASK_DEPRECATED
         virtual yc_var_point_node_ptr
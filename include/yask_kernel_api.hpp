@@ -68,8 +68,8 @@ namespace yask {
     /** @}*/
 } // namespace yask.
 
-#include "aux/yk_solution_api.hpp"
 #include "aux/yk_var_api.hpp"
+#include "aux/yk_solution_api.hpp"
 
 namespace yask {
 
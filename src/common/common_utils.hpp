@@ -80,6 +80,8 @@ inline void omp_set_nested(int n) { }
 inline int omp_get_max_active_levels() { return 1; }
 inline void omp_set_max_active_levels(int n) { }
 inline int omp_get_level() { return 0; }
+typedef enum omp_sched_t { omp_sched_static = 1, omp_sched_dynamic = 2 } omp_sched_t;
+inline void omp_set_schedule(omp_sched_t kind, int chunk_size) { }
 inline void omp_init_lock(omp_lock_t* p) { }
 inline bool omp_set_lock(omp_lock_t* p) { return true; }
 inline void omp_unset_lock(omp_lock_t* p) { }
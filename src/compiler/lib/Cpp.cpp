@@ -32,6 +32,17 @@ IN THE SOFTWARE.
 
 namespace yask {
 
+    // Is 'res' the name of a C++ var rather than an expression
+    // that would be evaluated again wherever it is used?
+    static bool is_var_name(const string& res) {
+        if (res.empty())
+            return false;
+        for (char c : res)
+            if (!isalnum(c) && c != '_')
+                return false;
+        return true;
+    }
+
     /////////// Scalar code /////////////
 
     // Format a real, preserving precision.
@@ -52,12 +63,33 @@ namespace yask {
         return oss.str();
     }
 
+    // Replace each material-index arg, e.g., 'mat(x, y)' in
+    // 'vel(mat(x, y))', with code that reads the index.
+    var_point_ptr CppPrintHelper::resolve_lookup_args(ostream& os,
+                                                      const VarPoint& gp,
+                                                      const VarMap* var_map) {
+        auto rgp = gp.clone_var_point();
+        auto* var = gp._get_var();
+        for (int di = 0; di < var->get_num_dims(); di++) {
+            auto lp = gp.get_lookup_arg(di);
+            if (lp) {
+                string idx = read_lookup_arg(os, *lp, var_map);
+                rgp->set_arg_expr(var->get_dim_name(di), "idx_t(" + idx + ")");
+            }
+        }
+        return rgp;
+    }
+
     // Make call for a point.
     // This is a utility function used for both reads and writes.
     string CppPrintHelper::make_point_call(ostream& os,
                                            const VarPoint& gp,
                                            const string& fname,
                                            string opt_arg) {
+        if (gp.has_lookup_args()) {
+            auto rgp = resolve_lookup_args(os, gp);
+            return make_point_call(os, *rgp, fname, opt_arg);
+        }
 
         // Get/set local vars.
         string var_ptr = get_local_var(os, get_var_ptr(gp), _var_ptr_type, "expr");
@@ -80,9 +112,36 @@ namespace yask {
     // Return code to update a var point.
     string CppPrintHelper::write_to_point(ostream& os, const VarPoint& gp,
                                           const string& val) {
+        print_reduction(os, gp, val);
         return make_point_call(os, gp, "write_elem", val);
     }
 
+    // Print code to accumulate reductions of a scalar value
+    // directly into 'red_vals'.
+    void CppPrintHelper::print_reduction(ostream& os, const VarPoint& gp,
+                                         const string& val) {
+        auto& vname = gp._get_var()->_get_name();
+        auto it = _red_slots.find(vname);
+        if (it == _red_slots.end())
+            return;
+        int slot = it->second.first;
+        int mask = it->second.second;
+        os << "\n // Accumulate reduction(s) of value written to '" << vname << "'.\n"
+            " if constexpr (do_reduce) {\n"
+            "  double* red_p = red_vals + " << (slot * _red_slot_size) << ";\n"
+            "  double red_in = double(" << val << ");\n"
+            "  red_p[4] += 1.0;\n";
+        if (mask & yc_equation_node::yc_sum_reduction)
+            os << "  red_p[0] += red_in;\n";
+        if (mask & yc_equation_node::yc_sum_squares_reduction)
+            os << "  red_p[1] += red_in * red_in;\n";
+        if (mask & yc_equation_node::yc_min_reduction)
+            os << "  red_p[2] = std::min(red_p[2], red_in);\n";
+        if (mask & yc_equation_node::yc_max_reduction)
+            os << "  red_p[3] = std::max(red_p[3], red_in);\n";
+        os << " }\n";
+    }
+
     /////////// Vector code /////////////
 
     // Create call for a point.
@@ -95,6 +154,12 @@ namespace yask {
                                                   bool is_vec_norm,
                                                   const VarMap* var_map) {
 
+        if (gp.has_lookup_args()) {
+            auto rgp = resolve_lookup_args(os, gp, var_map);
+            return make_point_call_vec(os, *rgp, func_name, first_arg, last_arg,
+                                       is_vec_norm, var_map);
+        }
+
         // Vec-norm accesses must be from folded var.
         if (is_vec_norm)
             assert(gp.is_var_foldable());
@@ -144,16 +209,21 @@ namespace yask {
     }
 
     // Make inner-loop base point:
-    //  domain dim offset = 0;
+    //  domain dim offset = 0 (except march dim in a plane buffer);
     //  misc indices = min-val (local-offset);
     //  other indices = those from 'gp'.
     var_point_ptr CppVecPrintHelper::make_inner_loop_base_point(const VarPoint& gp) {
         var_point_ptr bgp = gp.clone_var_point();
+
+        // A point in a plane buffer keeps its march-dim offset
+        // because each plane is in a separate slot.
+        auto* pb = lookup_plane_buf(gp);
         for (auto& dim : gp.get_dims()) {
             auto& dname = dim->_get_name();
             auto type = dim->get_type();
             bool use_domain = (type == DOMAIN_INDEX) &&
-                (!_settings._use_many_ptrs || dname == _dims._inner_layout_dim);
+                (!_settings._use_many_ptrs || dname == _dims._inner_layout_dim) &&
+                !(pb && dname == _march_dim);
             bool use_misc = type == MISC_INDEX;
 
             // Set domain dims to current index only,
@@ -396,7 +466,40 @@ namespace yask {
             // Doesn't already exist?
             if (!lookup_inner_loop_base_ptr(gp)) {
                 const auto* vbp = lookup_var_base_ptr(gp);
-                if (vbp) {
+                auto* pb = lookup_plane_buf(gp);
+                if (pb) {
+
+                    // Make base point (domain offset = 0 except in march dim).
+                    auto bgp = make_inner_loop_base_point(gp);
+                    
+                    // Get temp var for ptr.
+                    string ptr_name = make_var_name(vname + "_plane_ptr");
+                    
+                    // Save for future use.
+                    _inner_loop_base_ptrs[*bgp] = ptr_name;
+
+                    // Slot of the plane at the march-dim offset.
+                    int mofs = bgp->get_arg_offsets()[_march_dim] / _dims._fold[_march_dim];
+                    string mexpr = _march_dim;
+                    if (mofs)
+                        mexpr += (mofs > 0 ? " + " : " - ") + to_string(abs(mofs));
+                    string ofs_expr = "(imod_flr<idx_t>(" + mexpr + ", " +
+                        to_string(pb->get_num_planes()) + ") * " + pb->plane_size + ")";
+
+                    // Position in the plane.
+                    for (auto& dim : _dims._domain_dims) {
+                        auto& dname = dim._get_name();
+                        if (dname != _march_dim)
+                            ofs_expr += " + ((" + dname + " - " + pb->begins.at(dname) +
+                                ") * " + pb->strides.at(dname) + ")";
+                    }
+
+                    // Print pointer creation.
+                    os << "\n // Pointer to " << bgp->make_str() << " in plane buffer\n";
+                    os << _line_prefix << _var_ptr_type << " " << ptr_name << " = " <<
+                        pb->name << " + " << ofs_expr << _line_suffix;
+                }
+                else if (vbp) {
 
                     // Make base point (domain offset = 0; inner-misc indices = min-val).
                     auto bgp = make_inner_loop_base_point(gp);
@@ -493,17 +596,28 @@ namespace yask {
     }
 
     // Print all aligned loads.
-    void CppVecPrintHelper::print_early_loads(ostream& os) {
+    int CppVecPrintHelper::print_early_loads(ostream& os, int max_loads) {
         get_point_stats();
 
-        os << "\n // Issuing all aligned loads early (before needed).\n";
+        int nloads = int(_aligned_reads.size());
+        if (max_loads >= 0 && max_loads < nloads) {
+            nloads = max_loads;
+            os << "\n // Issuing " << nloads << " of " << _aligned_reads.size() <<
+                " aligned loads early (before needed) to fit in registers.\n";
+        }
+        else
+            os << "\n // Issuing all aligned loads early (before needed).\n";
 
-        // Loop through all aligned read points.
+        // Loop through aligned read points.
         // TODO: ignore points in buffer.
+        int n = 0;
         for (auto& gp : _aligned_reads) {
+            if (n++ >= nloads)
+                break;
             read_from_point(os, gp);
         }
-        os << "\n // Done issuing all aligned loads early.\n";
+        os << "\n // Done issuing aligned loads early.\n";
+        return nloads;
     }
 
     // Print buffer-code for each inner-loop base pointer.
@@ -598,6 +712,545 @@ namespace yask {
         }
     }
     
+    // Get plane buffer containing 'gp' or null if none.
+    CppVecPrintHelper::PlaneBuf* CppVecPrintHelper::lookup_plane_buf(const VarPoint& gp) {
+        if (_plane_bufs.empty())
+            return 0;
+
+        // Need a simple, vec-aligned offset in every domain dim and no
+        // misc dims.
+        auto& offsets = gp.get_arg_offsets();
+        for (auto& dim : gp.get_dims()) {
+            auto& dname = dim->_get_name();
+            auto type = dim->get_type();
+            if (type == MISC_INDEX)
+                return 0;
+            if (type == DOMAIN_INDEX) {
+                auto* ofs = offsets.lookup(dname);
+                if (!ofs || *ofs % _dims._fold[dname] != 0)
+                    return 0;
+            }
+        }
+
+        // Find buffer.
+        auto key = gp.clone_var_point();
+        for (auto& dim : _dims._domain_dims) {
+            IntScalar idi(dim._get_name(), 0);
+            key->set_arg_offset(idi);
+        }
+        if (!_plane_bufs.count(*key))
+            return 0;
+        auto& pb = _plane_bufs.at(*key);
+
+        // Must be within the buffered range.
+        for (auto& dim : _dims._domain_dims) {
+            auto& dname = dim._get_name();
+            int vofs = offsets[dname] / _dims._fold[dname];
+            int lo = (dname == _march_dim) ? pb.lo : pb.plo.at(dname);
+            int hi = (dname == _march_dim) ? pb.hi : pb.phi.at(dname);
+            if (vofs < lo || vofs > hi)
+                return 0;
+        }
+        return &pb;
+    }
+
+    // Find input vars read at more than one offset in 'march_dim' that
+    // can be copied into plane buffers. A var written by this part can
+    // only be buffered at a step index that does not share memory with
+    // any written step index.
+    bool CppVecPrintHelper::find_plane_buffers(const string& march_dim) {
+        get_point_stats();
+        _plane_bufs.clear();
+        _march_dim = march_dim;
+        if (!_settings._use_ptrs || _settings._use_many_ptrs ||
+            !_dims._domain_dims.lookup(march_dim) ||
+            march_dim == _settings._inner_loop_dim)
+            return false;
+        auto& sdim = _dims._step_dim;
+
+        // Step offsets written to each var.
+        map<const Var*, set<int>> written;
+        set<const Var*> no_buf;
+        for (auto& wp : _vv._vec_writes) {
+            auto* var = wp._get_var();
+            auto* sofs = wp.get_arg_offsets().lookup(sdim);
+            if (sofs && !var->is_dynamic_step_alloc())
+                written[var].insert(*sofs);
+            else
+                no_buf.insert(var);
+        }
+
+        // Find range of offsets for each candidate buffer.
+        map<VarPoint, PlaneBuf> pbufs;
+        for (auto& gp : _aligned_reads) {
+            auto* var = gp._get_var();
+            assert(var);
+            if (no_buf.count(var) || !var->is_foldable() ||
+                gp.get_var_dep() != VarPoint::INNER_LOOP_OFFSET)
+                continue;
+
+            // Written at a step index that shares memory?
+            auto& offsets = gp.get_arg_offsets();
+            if (written.count(var)) {
+                auto* rofs = offsets.lookup(sdim);
+                if (!rofs)
+                    continue;
+                idx_t salloc = var->get_step_alloc_size();
+                bool shared = false;
+                for (int wofs : written.at(var))
+                    if (imod_flr<idx_t>(wofs - *rofs, salloc) == 0)
+                        shared = true;
+                if (shared)
+                    continue;
+            }
+
+            // Need all domain dims w/simple offsets and no misc dims.
+            int ndd = 0;
+            bool ok = true;
+            for (auto& dim : gp.get_dims()) {
+                auto type = dim->get_type();
+                if (type == MISC_INDEX)
+                    ok = false;
+                else if (type == DOMAIN_INDEX) {
+                    if (!offsets.lookup(dim->_get_name()))
+                        ok = false;
+                    ndd++;
+                }
+            }
+            if (!ok || ndd != _dims._domain_dims.get_num_dims())
+                continue;
+
+            // Update range in each dim.
+            auto key = gp.clone_var_point();
+            for (auto& dim : _dims._domain_dims) {
+                IntScalar idi(dim._get_name(), 0);
+                key->set_arg_offset(idi);
+            }
+            bool is_new = !pbufs.count(*key);
+            auto& pb = pbufs[*key];
+            for (auto& dim : _dims._domain_dims) {
+                auto& dname = dim._get_name();
+                int vofs = offsets[dname] / _dims._fold[dname];
+                int& lo = (dname == march_dim) ? pb.lo : pb.plo[dname];
+                int& hi = (dname == march_dim) ? pb.hi : pb.phi[dname];
+                if (is_new || vofs < lo)
+                    lo = vofs;
+                if (is_new || vofs > hi)
+                    hi = vofs;
+            }
+        }
+
+        // Keep buffers that are reused across planes.
+        for (auto& i : pbufs)
+            if (i.second.get_num_planes() > 1)
+                _plane_bufs.insert(i);
+        return !_plane_bufs.empty();
+    }
+
+    // Print thread-private storage for the plane buffers.
+    // The storage is kept between calls and only grows.
+    void CppVecPrintHelper::print_plane_buffer_storage(ostream& os) {
+        for (auto& i : _plane_bufs) {
+            auto& key = i.first;
+            auto& pb = i.second;
+            pb.name = make_var_name(key.get_var_name() + "_plane_buf");
+            os << "\n // Thread-private storage for " << pb.get_num_planes() <<
+                " plane(s) of " << key.make_str() << " in dim '" << _march_dim << "'.\n" <<
+                _line_prefix << "static thread_local std::vector<" << _var_type << "> " <<
+                pb.name << "_storage" << _line_suffix;
+        }
+    }
+
+    // Print start of loop over planes in the march dim inside the nano
+    // loops. Each iteration copies the furthest plane needed into each
+    // buffer, replacing the one no longer needed, and the first iterations
+    // only fill the buffers.
+    void CppVecPrintHelper::print_plane_buffer_march(ostream& os) {
+        auto& md = _march_dim;
+        int mdn = _dims._domain_dims.lookup_posn(md) + 1;
+        string mi = "plane_" + md;
+        int max_fill = 0;
+        for (auto& i : _plane_bufs)
+            max_fill = std::max(max_fill, i.second.get_num_planes() - 1);
+
+        os << "\n // March through dim '" << md << "' one vector-plane at a time.\n" <<
+            _line_prefix << "const idx_t plane_begin = NANO_BLOCK_BODY_START(" << mdn << ")" << _line_suffix <<
+            _line_prefix << "const idx_t plane_end = NANO_BLOCK_BODY_STOP(" << mdn << ")" << _line_suffix;
+
+        // Sizes of the buffers.
+        for (auto& i : _plane_bufs) {
+            auto& key = i.first;
+            auto& pb = i.second;
+            auto& vname = key.get_var_name();
+            os << "\n // Plane buffer for " << key.make_str() << " with " << md <<
+                " vector offsets in [" << pb.lo << "..." << pb.hi << "].\n";
+
+            // Range and stride in each other domain dim, inner-most last.
+            string stride = "idx_t(1)";
+            for (int j = _dims._domain_dims.get_num_dims() - 1; j >= 0; j--) {
+                auto& dname = _dims._domain_dims.get_dim_name(j);
+                if (dname == md)
+                    continue;
+                int dn = j + 1;
+                string begin = make_var_name(vname + "_plane_" + dname + "_begin");
+                string size = make_var_name(vname + "_plane_" + dname + "_size");
+                string sname = make_var_name(vname + "_plane_" + dname + "_stride");
+                os << _line_prefix << "const idx_t " << begin << " = NANO_BLOCK_BODY_START(" << dn <<
+                    ") + (" << pb.plo.at(dname) << ")" << _line_suffix <<
+                    _line_prefix << "const idx_t " << size << " = NANO_BLOCK_BODY_STOP(" << dn <<
+                    ") + (" << pb.phi.at(dname) << ") - " << begin << _line_suffix <<
+                    _line_prefix << "const idx_t " << sname << " = " << stride << _line_suffix;
+                stride = size + " * " + sname;
+                pb.begins[dname] = begin;
+                pb.sizes[dname] = size;
+                pb.strides[dname] = sname;
+            }
+            pb.plane_size = make_var_name(vname + "_plane_size");
+            os << _line_prefix << "const idx_t " << pb.plane_size << " = " << stride << _line_suffix <<
+                _line_prefix << "if (" << pb.name << "_storage.size() < size_t(" << pb.get_num_planes() <<
+                " * " << pb.plane_size << "))\n" <<
+                _line_prefix << " " << pb.name << "_storage.resize(" << pb.get_num_planes() <<
+                " * " << pb.plane_size << ")" << _line_suffix <<
+                _line_prefix << _var_type << "* __restrict " << pb.name << " = " <<
+                pb.name << "_storage.data()" << _line_suffix;
+        }
+
+        os << "\n // Loop over planes, starting early to fill the buffers.\n" <<
+            _line_prefix << "for (idx_t " << mi << " = plane_begin - " << max_fill << "; " <<
+            mi << " < plane_end; " << mi << "++) {\n";
+
+        // Copy next plane into each buffer.
+        for (auto& i : _plane_bufs) {
+            auto& key = i.first;
+            auto& pb = i.second;
+            auto* var = key._get_var();
+            auto& vname = var->get_name();
+            auto* vbp = lookup_var_base_ptr(key);
+            auto* mstride = lookup_stride(*var, md);
+            assert(vbp);
+            assert(mstride);
+
+            os << "\n // Copy plane at " << md << " + " << pb.hi << " of " << key.make_str() <<
+                " into " << pb.name << ".\n" <<
+                _line_prefix << "if (" << mi << " >= plane_begin - " << (pb.get_num_planes() - 1) << ") {\n" <<
+                _line_prefix << " const idx_t " << mi << "_next = " << mi << " + (" << pb.hi << ")" << _line_suffix <<
+                _line_prefix << " " << _var_type << "* __restrict dst = " << pb.name <<
+                " + imod_flr<idx_t>(" << mi << "_next, " << pb.get_num_planes() << ") * " <<
+                pb.plane_size << _line_suffix <<
+                _line_prefix << " const " << _var_type << "* __restrict src = " << *vbp << " + ";
+            if (_ptr_ofs.count(vname))
+                os << "(" << _ptr_ofs.at(vname) << ") + ";
+            os << "(" << mi << "_next * " << *mstride << ")" << _line_suffix;
+
+            // Nested loops over other domain dims.
+            string dst_ofs, src_ofs;
+            for (auto& dim : _dims._domain_dims) {
+                auto& dname = dim._get_name();
+                if (dname == md)
+                    continue;
+                auto* stride = lookup_stride(*var, dname);
+                assert(stride);
+                string ii = "plane_i_" + dname;
+                os << _line_prefix << " for (idx_t " << ii << " = 0; " << ii << " < " <<
+                    pb.sizes.at(dname) << "; " << ii << "++)\n";
+                if (dst_ofs.length()) {
+                    dst_ofs += " + ";
+                    src_ofs += " + ";
+                }
+                dst_ofs += "(" + ii + " * " + pb.strides.at(dname) + ")";
+                src_ofs += "((" + pb.begins.at(dname) + " + " + ii + ") * " + *stride + ")";
+            }
+            os << _line_prefix << "  dst[" << dst_ofs << "] = src[" << src_ofs << "]" << _line_suffix <<
+                _line_prefix << "}\n";
+        }
+
+        // Compute only after buffers are filled.
+        os << _line_prefix << "if (" << mi << " < plane_begin)\n" <<
+            _line_prefix << " continue" << _line_suffix <<
+            "\n // Pico loops over one plane.\n"
+            "#define PICO_BLOCK_BEGIN(dn) ((dn) == " << mdn << " ? " << mi <<
+            " : NANO_BLOCK_BODY_START(dn))\n"
+            "#define PICO_BLOCK_END(dn) ((dn) == " << mdn << " ? " << mi <<
+            " + 1 : NANO_BLOCK_BODY_STOP(dn))\n"
+            "#define PICO_BLOCK_STRIDE(dn) idx_t(1)\n";
+    }
+    
+    // Whether 'gp' can be carried in a semi-stencil sum: a full vector
+    // that varies only in the inner-loop dim and is aligned in every fold
+    // dim, so it and its copies shifted by whole vectors in the inner-loop
+    // dim can be read as aligned vectors.
+    bool CppVecPrintHelper::is_semi_point(const VarPoint& gp) const {
+        if (gp.get_var_dep() != VarPoint::INNER_LOOP_OFFSET ||
+            gp.get_vec_type() != VarPoint::VEC_FULL)
+            return false;
+        auto& offsets = gp.get_arg_offsets();
+        for (auto& dim : _dims._fold) {
+            auto* ofs = offsets.lookup(dim._get_name());
+            if (!ofs || *ofs % dim.get_val() != 0)
+                return false;
+        }
+        return true;
+    }
+
+    // Get index of the only operand of 'ce' that uses the inner-loop
+    // index, -1 if none does, or -2 if more than one does.
+    int CppVecPrintHelper::get_semi_dep_op(CommutativeExpr* ce) const {
+        int di = -1;
+        auto& ops = ce->get_ops();
+        for (size_t i = 0; i < ops.size(); i++) {
+            IndexDepVisitor idv(_settings._inner_loop_dim);
+            ops[i]->accept(&idv);
+            if (idv.is_dep()) {
+                if (di >= 0)
+                    return -2;
+                di = int(i);
+            }
+        }
+        return di;
+    }
+
+    // Look for sums in 'ep' and replace the terms that can be carried
+    // in partial sums.
+    void CppVecPrintHelper::semi_walk(num_expr_ptr& ep) {
+        auto& ildim = _settings._inner_loop_dim;
+        int vlen = _dims._fold[ildim];
+
+        // A sum: find points that vary only in the inner-loop dim in
+        // each term.
+        auto ae = dynamic_pointer_cast<AddExpr>(ep);
+        if (ae) {
+            auto& ops = ae->get_ops();
+            vector<SemiCand> cands;
+            for (auto& op : ops)
+                semi_collect(op, {}, cands);
+
+            // Group candidates by point w/o inner-loop offset.
+            map<VarPoint, vector<SemiCand*>> groups;
+            for (auto& c : cands) {
+                auto key = c.pt->clone_var_point();
+                key->set_arg_offset(IntScalar(ildim, 0));
+                groups[*key].push_back(&c);
+            }
+
+            // A group qualifies if it has a pivot point at a non-negative
+            // offset and at least two terms at negative offsets that can
+            // be carried from the pivot values of previous iterations.
+            set<Expr*> chosen;
+            size_t nsums = _semi_sums.size();
+            for (auto& g : groups) {
+                int q = -1;
+                for (auto* c : g.second) {
+                    int r = c->pt->get_arg_offsets()[ildim];
+                    if (r >= 0 && (q < 0 || r < q))
+                        q = r;
+                }
+                if (q < 0)
+                    continue;
+                SemiSum ss;
+                for (auto* c : g.second) {
+                    int r = c->pt->get_arg_offsets()[ildim];
+                    if (r >= 0)
+                        continue;
+                    SemiSum::Term t;
+                    if (c->coeffs.size() == 1)
+                        t.coeff = c->coeffs.front()->clone();
+                    else if (c->coeffs.size() > 1) {
+                        auto me = make_shared<MultExpr>();
+                        for (auto& f : c->coeffs)
+                            me->append_op(f);
+                        t.coeff = me;
+                    }
+                    t.pt = c->pt->clone_var_point();
+                    t.dist = (q - r) / vlen;
+                    ss.terms.push_back(t);
+                }
+                if (ss.terms.size() < 2)
+                    continue;
+                for (auto* c : g.second)
+                    if (c->pt->get_arg_offsets()[ildim] < 0)
+                        chosen.insert(c->pt);
+                ss.pivot = g.first.clone_var_point();
+                ss.pivot->set_arg_offset(IntScalar(ildim, q));
+                ss.name = "semi_sum_" + to_string(_semi_sums.size());
+                _semi_sums.push_back(ss);
+            }
+            if (chosen.empty())
+                return;
+
+            // Replace the chosen terms w/the partial sums.
+            for (size_t i = 0; i < ops.size(); ) {
+                if (semi_extract(ops[i], chosen))
+                    ops.erase(ops.begin() + i);
+                else
+                    i++;
+            }
+            for (size_t i = nsums; i < _semi_sums.size(); i++)
+                ae->append_op(make_shared<CodeExpr>(_semi_sums[i].name + "[0]"));
+            return;
+        }
+
+        // Otherwise, look for sums in the operands.
+        if (auto ue = dynamic_pointer_cast<UnaryNumExpr>(ep))
+            semi_walk(ue->_get_rhs());
+        else if (auto be = dynamic_pointer_cast<BinaryNumExpr>(ep)) {
+            semi_walk(be->_get_lhs());
+            semi_walk(be->_get_rhs());
+        }
+        else if (auto ce = dynamic_pointer_cast<CommutativeExpr>(ep)) {
+            for (auto& op : ce->get_ops())
+                semi_walk(op);
+        }
+        else if (auto fe = dynamic_pointer_cast<FuncExpr>(ep)) {
+            for (auto& op : fe->get_ops())
+                semi_walk(op);
+        }
+    }
+
+    // Collect candidate points in the terms of a sum. 'coeffs' are the
+    // loop-invariant factors that multiply 'ep'.
+    void CppVecPrintHelper::semi_collect(num_expr_ptr& ep, const num_expr_ptr_vec& coeffs,
+                                         vector<SemiCand>& cands) {
+        auto vp = dynamic_pointer_cast<VarPoint>(ep);
+        if (vp) {
+            if (is_semi_point(*vp))
+                cands.push_back({ coeffs, vp.get() });
+            return;
+        }
+        auto ae = dynamic_pointer_cast<AddExpr>(ep);
+        if (ae) {
+            for (auto& op : ae->get_ops())
+                semi_collect(op, coeffs, cands);
+            return;
+        }
+        auto me = dynamic_pointer_cast<MultExpr>(ep);
+        if (me) {
+            int di = get_semi_dep_op(me.get());
+            if (di == -1)
+                return;
+            if (di >= 0) {
+                auto& ops = me->get_ops();
+                auto mcoeffs = coeffs;
+                for (int i = 0; i < int(ops.size()); i++)
+                    if (i != di)
+                        mcoeffs.push_back(ops[i]);
+                semi_collect(ops[di], mcoeffs, cands);
+                return;
+            }
+        }
+
+        // Not a term of the sum; look for nested sums.
+        semi_walk(ep);
+    }
+
+    // Remove 'chosen' points from the terms of a sum, following the same
+    // path as semi_collect(). Return whether 'ep' should be removed.
+    bool CppVecPrintHelper::semi_extract(num_expr_ptr& ep, const set<Expr*>& chosen) {
+        if (chosen.count(ep.get()))
+            return true;
+        auto ae = dynamic_pointer_cast<AddExpr>(ep);
+        if (ae) {
+            auto& ops = ae->get_ops();
+            for (size_t i = 0; i < ops.size(); ) {
+                if (semi_extract(ops[i], chosen))
+                    ops.erase(ops.begin() + i);
+                else
+                    i++;
+            }
+            if (ops.empty())
+                return true;
+            if (ops.size() == 1) {
+                num_expr_ptr op = ops.front();
+                ep = op;
+            }
+            return false;
+        }
+        auto me = dynamic_pointer_cast<MultExpr>(ep);
+        if (me) {
+            int di = get_semi_dep_op(me.get());
+            if (di >= 0)
+                return semi_extract(me->get_ops()[di], chosen);
+        }
+        return false;
+    }
+
+    // Find semi-stencil sums in 'part'.
+    bool CppVecPrintHelper::find_semi_sums(Part& part) {
+        _semi_sums.clear();
+        _semi_coeffs.clear();
+        for (auto& eq : part.get_eqs())
+            semi_walk(eq->_get_rhs());
+        return !_semi_sums.empty();
+    }
+
+    // Print semi-stencil code.
+    // Partial sum 'name[m]' holds the terms of the sum for the vector 'm'
+    // iterations ahead that use pivot values already read.
+    void CppVecPrintHelper::print_semi_sum_code(ostream& os, bool in_loop) {
+        auto& ildim = _settings._inner_loop_dim;
+        int vlen = _dims._fold[ildim];
+
+        for (auto& ss : _semi_sums) {
+            int nslots = ss.get_num_slots();
+
+            // Shift partial sums and add terms using the current pivot.
+            if (in_loop) {
+                os << "\n // Update partial sums for " << ss.pivot->make_str() << endl;
+                string pv = read_from_point(os, *ss.pivot);
+                for (int m = 0; m < nslots; m++) {
+                    string sum;
+                    if (m + 1 < nslots)
+                        sum = ss.name + "[" + to_string(m + 1) + "]";
+                    for (auto& t : ss.terms) {
+                        if (t.dist != m + 1)
+                            continue;
+                        string term = pv;
+                        if (t.coeff)
+                            term = _semi_coeffs.at(t.coeff.get()) + " * " + term;
+                        sum = sum.length() ? sum + " + " + term : term;
+                    }
+                    if (sum.empty())
+                        sum = "0.0";
+                    os << _line_prefix << ss.name << "[" << m << "] = " << sum << _line_suffix;
+                }
+                continue;
+            }
+
+            // Before the loop, evaluate coefficients and init partial sums
+            // from points behind the pivot.
+            os << "\n // Partial sums of " << ss.terms.size() << " terms carried along " <<
+                ildim << " from " << ss.pivot->make_str() << endl;
+            os << _line_prefix << _var_type << " " << ss.name << "[" << nslots << "]" << _line_suffix;
+            for (auto& t : ss.terms) {
+                if (!t.coeff)
+                    continue;
+                PrintVisitorBottomUp pv(os, *this);
+                string res = t.coeff->accept(&pv);
+                if (!is_var_name(res)) {
+                    string vname = make_var_name("semi_coeff");
+                    os << _line_prefix << _var_type << " " << vname << " = " << res << _line_suffix;
+                    res = vname;
+                }
+                _semi_coeffs[t.coeff.get()] = res;
+            }
+            for (int m = 0; m < nslots; m++) {
+                string sum;
+                for (auto& t : ss.terms) {
+                    if (t.dist < m + 1)
+                        continue;
+                    auto ogp = t.pt->clone_var_point();
+                    ogp->set_arg_offset(IntScalar(ildim, t.pt->get_arg_offsets()[ildim] + m * vlen));
+                    string term = print_aligned_vec_read(os, *ogp);
+                    if (t.coeff)
+                        term = _semi_coeffs.at(t.coeff.get()) + " * " + term;
+                    sum = sum.length() ? sum + " + " + term : term;
+                }
+                if (sum.empty())
+                    sum = "0.0";
+                os << _line_prefix << ss.name << "[" << m << "] = " << sum << _line_suffix;
+            }
+        }
+    }
+
     // Print prefetches for each inner-loop base pointer.
     // 'in_loop' == 'true': prefetch at end of loop; otherwise before loop.
     void CppVecPrintHelper::print_prefetches(ostream& os, bool in_loop) {
@@ -641,8 +1294,9 @@ namespace yask {
                     ogp->set_arg_offset(idi);
 
                     // Get ptr to it.
+                    // Plane buffers are already in cache.
                     auto* p = lookup_inner_loop_base_ptr(*ogp);
-                    if (p) {
+                    if (p && !lookup_plane_buf(key)) {
                         string ptr_expr = *p;
                         string ptr_var = ptr_expr;
                         auto ofs_str = get_inner_loop_ptr_offset(os, *ogp);
@@ -685,7 +1339,9 @@ namespace yask {
         for (auto& i : _inner_loop_base_ptrs) {
             auto& vp = i.first;
             auto& ptr = i.second;
-            auto* stride = lookup_stride(*vp._get_var(), _settings._inner_loop_dim);
+            auto* pb = lookup_plane_buf(vp);
+            auto* stride = pb ? &pb->strides.at(ild) :
+                lookup_stride(*vp._get_var(), ild);
             assert(stride);
             os << _line_prefix << ptr << " += " << *stride << _line_suffix;
         }
@@ -756,6 +1412,10 @@ namespace yask {
         string ofs_str;
         int nterms = 0;
 
+        // Offsets in a plane buffer use its strides, and the march dim
+        // is selected by the base pointer.
+        auto* pb = lookup_plane_buf(gp);
+
         // Construct the point-specific linear offset by adding the products
         // of each index with the var's stride in that dim.
         for (int i = 0; i < var->get_num_dims(); i++) {
@@ -763,7 +1423,8 @@ namespace yask {
             auto dname = dimi->_get_name();
             auto type = dimi->get_type();
             bool use_domain = (type == DOMAIN_INDEX) &&
-                (!_settings._use_many_ptrs || dname == _dims._inner_layout_dim);
+                (!_settings._use_many_ptrs || dname == _dims._inner_layout_dim) &&
+                !(pb && dname == _march_dim);
             bool use_misc = type == MISC_INDEX;
 
             // Need to create an expression for offsets.
@@ -800,7 +1461,7 @@ namespace yask {
                 }
 
                 // Get stride in this dim.
-                auto* stride = lookup_stride(*var, dname);
+                auto* stride = pb ? &pb->strides.at(dname) : lookup_stride(*var, dname);
                 assert(stride);
 
                 // Mult & add to offset expression.
@@ -902,9 +1563,105 @@ namespace yask {
         // so we only need to handle vectorized writes.
         // TODO: relax this restriction.
         print_aligned_vec_write(os, gp, val);
+        print_reduction(os, gp, val);
 
         return "";              // no returned expression.
     }
+
+    // Print code to accumulate reductions of a vector value in
+    // the accumulators created by print_reduction_prefix().
+    void CppVecPrintHelper::print_reduction(ostream& os, const VarPoint& gp,
+                                            const string& val) {
+        auto& vname = gp._get_var()->_get_name();
+        auto it = _red_slots.find(vname);
+        if (it == _red_slots.end())
+            return;
+        string sfx = "_" + to_string(it->second.first);
+        int mask = it->second.second;
+
+        // Lanes outside the write mask are set to the identity value.
+        auto masked_in = [&](const string& ident) {
+            if (!_write_mask.length())
+                return val;
+            os << "  real_vec_t red_in = " << ident << ";\n"
+                "  red_in.copy_from_masked(" << val << ", " << _write_mask << ");\n";
+            return string("red_in");
+        };
+        os << "\n // Accumulate reduction(s) of value written to '" << vname << "'.\n"
+            " if constexpr (do_reduce) {\n";
+        if (_write_mask.length())
+            os << "  red_n" << sfx << " += __builtin_popcountll(" << _write_mask <<
+                " & ((bit_mask_t(1) << VLEN) - 1));\n";
+        else
+            os << "  red_n" << sfx << " += VLEN;\n";
+        if (mask & (yc_equation_node::yc_sum_reduction |
+                    yc_equation_node::yc_sum_squares_reduction)) {
+            os << " {\n";
+            auto in = masked_in("0.0");
+            if (mask & yc_equation_node::yc_sum_reduction)
+                os << "  red_sum" << sfx << " = red_sum" << sfx << " + " << in << ";\n";
+            if (mask & yc_equation_node::yc_sum_squares_reduction)
+                os << "  red_sum_sq" << sfx << " = red_sum_sq" << sfx << " + " <<
+                    in << " * " << in << ";\n";
+            os << " }\n";
+        }
+        if (mask & yc_equation_node::yc_min_reduction) {
+            os << " {\n";
+            auto in = masked_in("std::numeric_limits<real_t>::max()");
+            os << "  red_min" << sfx << " = yask_min(red_min" << sfx << ", " << in << ");\n"
+                " }\n";
+        }
+        if (mask & yc_equation_node::yc_max_reduction) {
+            os << " {\n";
+            auto in = masked_in("std::numeric_limits<real_t>::lowest()");
+            os << "  red_max" << sfx << " = yask_max(red_max" << sfx << ", " << in << ");\n"
+                " }\n";
+        }
+        os << " }\n";
+    }
+
+    // Print the vector reduction accumulators.
+    void CppVecPrintHelper::print_reduction_prefix(ostream& os) {
+        if (_red_slots.empty())
+            return;
+        os << "\n // Reduction accumulators for this thread.\n";
+        for (auto& rs : _red_slots) {
+            string sfx = "_" + to_string(rs.second.first);
+            os << " real_vec_t red_sum" << sfx << " = 0.0, red_sum_sq" << sfx << " = 0.0;\n"
+                " real_vec_t red_min" << sfx << " = std::numeric_limits<real_t>::max();\n"
+                " real_vec_t red_max" << sfx << " = std::numeric_limits<real_t>::lowest();\n"
+                " idx_t red_n" << sfx << " = 0;\n";
+        }
+    }
+
+    // Print code to combine the lanes of the vector accumulators
+    // into 'red_vals'.
+    void CppVecPrintHelper::print_reduction_suffix(ostream& os) {
+        if (_red_slots.empty())
+            return;
+        os << "\n // Save reductions for this thread.\n"
+            " if constexpr (do_reduce) {\n";
+        for (auto& rs : _red_slots) {
+            int slot = rs.second.first;
+            int mask = rs.second.second;
+            string sfx = "_" + to_string(slot);
+            os << " {\n"
+                "  double* red_p = red_vals + " << (slot * _red_slot_size) << ";\n"
+                "  red_p[4] += double(red_n" << sfx << ");\n"
+                "  REAL_VEC_LOOP(i) {\n";
+            if (mask & yc_equation_node::yc_sum_reduction)
+                os << "   red_p[0] += red_sum" << sfx << "[i];\n";
+            if (mask & yc_equation_node::yc_sum_squares_reduction)
+                os << "   red_p[1] += red_sum_sq" << sfx << "[i];\n";
+            if (mask & yc_equation_node::yc_min_reduction)
+                os << "   red_p[2] = std::min(red_p[2], double(red_min" << sfx << "[i]));\n";
+            if (mask & yc_equation_node::yc_max_reduction)
+                os << "   red_p[3] = std::max(red_p[3], double(red_max" << sfx << "[i]));\n";
+            os << "  }\n"
+                " }\n";
+        }
+        os << " }\n";
+    }
     
     // Print aligned memory read.
     // This should be the most common type of var read.
@@ -948,7 +1705,7 @@ namespace yask {
 
             if (in_buf)
                 os << _line_prefix << "#ifdef CHECK\n" <<
-                    _line_prefix << " // Check consistency of buffer.\n {";
+                    _line_prefix << " // Check consistency of buffer.\n {\n";
 
             // Ptr expression.
             string ptr_expr = *p;
@@ -962,9 +1719,12 @@ namespace yask {
             }
 
             // Check addr.
-            auto rpn = make_point_call_vec(os, gp, "get_vec_ptr_norm", "", "", true);
-            os << _line_prefix << "host_assert(" <<
-                ptr_var << " == " << rpn << ")" << _line_suffix;
+            // A plane buffer holds a copy, so its addr is not in the var.
+            if (!lookup_plane_buf(gp)) {
+                auto rpn = make_point_call_vec(os, gp, "get_vec_ptr_norm", "", "", true);
+                os << _line_prefix << "host_assert(" <<
+                    ptr_var << " == " << rpn << ")" << _line_suffix;
+            }
 
             // Output load.
             // We don't use masked loads because several aligned loads might
@@ -1011,6 +1771,10 @@ namespace yask {
     string CppVecPrintHelper::read_from_scalar_point(ostream& os, const VarPoint& gp,
                                                      const VarMap* var_map) {
         assert(var_map);
+        if (gp.has_lookup_args()) {
+            auto rgp = resolve_lookup_args(os, gp, var_map);
+            return read_from_scalar_point(os, *rgp, var_map);
+        }
         auto* var = gp._get_var();
         assert(!var->is_foldable()); // Assume all scalar reads are from non-vec vars.
 
@@ -1042,6 +1806,28 @@ namespace yask {
             return make_point_call_vec(os, gp, "read_elem_local", "", "", false, var_map);
     }
 
+    // Read a material index into a scalar var.
+    // Return var name.
+    string CppVecPrintHelper::read_lookup_arg(ostream& os, const VarPoint& lp,
+                                              const VarMap* var_map) {
+
+        // Vectorized accesses use the indices of the first elem in the
+        // vector; this only happens when the index is the same across the
+        // vector.
+        if (!var_map)
+            var_map = &_vec2elem_local_map;
+
+        string stmt = read_from_scalar_point(os, lp, var_map);
+        auto* varname = lookup_elem_var(stmt);
+        if (!varname) {
+            string vname = make_var_name("mat_idx");
+            os << _line_prefix << "const idx_t " << vname <<
+                " = idx_t(" << stmt << ")" << _line_suffix;
+            varname = save_elem_var(stmt, vname);
+        }
+        return *varname;
+    }
+
     // Read from multiple points that are not vectorized.
     // Return var name.
     string CppVecPrintHelper::print_partial_vec_read(ostream& os, const VarPoint& gp) {
@@ -1112,6 +1898,25 @@ namespace yask {
         return mv_name;
     }
 
+    // Simple register-pressure model: each vector read by more than one
+    // of the 'u' computed vectors is kept in a register until all of them
+    // have used it, and each one needs a register for each value written.
+    // Return the largest 'u' whose estimate fits in the registers, leaving
+    // a couple for temporaries, that also reduces the reads per write.
+    int CppVecPrintHelper::choose_unroll_factor(const vector<int>& nreads,
+                                                int nwrites) const {
+        int nregs = get_num_vec_regs() - 2;
+        int best = 1;
+        for (int u = 2; u <= int(nreads.size()); u++) {
+            int nshared = u * nreads.at(0) - nreads.at(u - 1);
+            if (u * nwrites + nshared > nregs)
+                break;
+            if (double(nreads.at(u - 1)) / u < double(nreads.at(best - 1)) / best)
+                best = u;
+        }
+        return best;
+    }
+
     // Print aligned memory write.
     void CppVecPrintHelper::print_aligned_vec_write(ostream& os, const VarPoint& gp,
                                                     const string& val) {
@@ -1139,8 +1944,18 @@ namespace yask {
                 ptr_var << " == " << rpn << ")" << _line_suffix;
 
             // Output store.
+            // Use a streaming store if the var is not reused, unless
+            // the kernel is tiling in the step dim.
             os << _line_prefix << val;
-            if (_write_mask.length())
+            if (_stream_vars.count(gp.get_var_name())) {
+                string use_stream = "core_data->_common_core._use_streaming";
+                if (_write_mask.length())
+                    os << ".stream_to_masked(" << ptr_expr << ", " << _write_mask <<
+                        ", " << use_stream << ")";
+                else
+                    os << ".stream_to(" << ptr_expr << ", " << use_stream << ")";
+            }
+            else if (_write_mask.length())
                 os << ".store_to_masked(" << ptr_expr << ", " << _write_mask << ")";
             else
                 os << ".store_to(" << ptr_expr << ")";
@@ -1291,5 +2106,46 @@ namespace yask {
         return "";
     }
 
+    // Hoist a var read if it depends on some domain dim(s) but
+    // not the inner-loop dim. Invariant reads are already done
+    // before the outer loops.
+    string CppPreInnerLoopPrintVisitor::visit(VarPoint* gp) {
+        assert(gp);
+        if (gp->get_var_dep() == VarPoint::DOMAIN_VAR_DEPENDENT)
+            try_hoist(gp);
+        return "";
+    }
+
+    // Print and save 'ep' if it does not depend on the inner-loop dim.
+    bool CppPreInnerLoopPrintVisitor::try_hoist(Expr* ep) {
+        assert(ep);
+
+        // Already done?
+        if (_cvph.lookup_expr_var(ep))
+            return true;
+
+        // Uses inner-loop index?
+        IndexDepVisitor idv(_cvph.get_settings()._inner_loop_dim);
+        ep->accept(&idv);
+        if (idv.is_dep())
+            return false;
+
+        if (_num_hoisted == 0)
+            _os << "\n // Values that do not depend on the inner-loop dim.\n";
+        string res = ep->accept(&_pv);
+
+        // Make sure the value is held in a var, not just an expression
+        // that would be evaluated again in the loop body.
+        if (!is_var_name(res)) {
+            string vname = _cvph.make_var_name("hoisted");
+            _os << _cvph.get_line_prefix() << _cvph.get_var_type() << " " <<
+                vname << " = " << res << _cvph.get_line_suffix();
+            res = vname;
+        }
+        _cvph.save_expr_var(ep, res);
+        _num_hoisted++;
+        return true;
+    }
+
 } // namespace yask.
 
@@ -39,6 +39,16 @@ namespace yask {
     // Outputs C++ scalar code for YASK.
     class CppPrintHelper : public PrintHelper {
 
+    protected:
+
+        // Reductions of written values.
+        // Key: var name; value: slot in 'red_vals' and reduction mask.
+        map<string, pair<int, int>> _red_slots;
+
+        // Number of doubles in 'red_vals' per slot:
+        // sum, sum of squares, min, max, and count.
+        static constexpr int _red_slot_size = 5;
+
     public:
         static constexpr const char* _var_ptr_type = "auto*";
         static constexpr const char* _var_ptr_restrict_type = "auto* __restrict";
@@ -79,6 +89,18 @@ namespace yask {
             return get_var_ptr(*var);
         }        
         
+        // Return code to read a material index used as an arg.
+        virtual string read_lookup_arg(ostream& os, const VarPoint& lp,
+                                       const VarMap* var_map) {
+            return read_from_point(os, lp);
+        }
+
+        // Return a copy of 'gp' with each material-index arg replaced
+        // by code that reads the index.
+        virtual var_point_ptr resolve_lookup_args(ostream& os,
+                                                  const VarPoint& gp,
+                                                  const VarMap* var_map = 0);
+
         // Make call for a point.
         // This is a utility function used for both reads and writes.
         virtual string make_point_call(ostream& os,
@@ -92,10 +114,45 @@ namespace yask {
         // Return code to update a var point.
         virtual string write_to_point(ostream& os, const VarPoint& gp,
                                       const string& val) override;
+
+        // Set the reductions to accumulate as from Part::get_reductions().
+        virtual void set_reductions(const vector<pair<string, int>>& reds) {
+            _red_slots.clear();
+            for (auto& r : reds) {
+                int slot = int(_red_slots.size());
+                _red_slots[r.first] = { slot, r.second };
+            }
+        }
+
+        // Print code to accumulate reductions of 'val' if it is
+        // written to a var with reductions.
+        virtual void print_reduction(ostream& os, const VarPoint& gp,
+                                     const string& val);
     };
 
     /////////// Vector code /////////////
 
+    // A sum along the inner-loop dim whose terms at negative offsets are
+    // carried across inner-loop iterations in partial sums (semi-stencil).
+    struct SemiSum {
+        struct Term {
+            num_expr_ptr coeff;     // loop-invariant coefficient (null => 1).
+            var_point_ptr pt;       // point at a negative offset.
+            int dist = 0;           // 'pivot' value at iteration i is 'pt' value at i + 'dist'.
+        };
+        string name;                // array of partial sums.
+        var_point_ptr pivot;        // point read at lowest non-negative offset.
+        vector<Term> terms;
+
+        // Number of partial sums carried.
+        int get_num_slots() const {
+            int n = 0;
+            for (auto& t : terms)
+                n = std::max(n, t.dist);
+            return n;
+        }
+    };
+
     // Output generic C++ vector code for YASK.
     class CppVecPrintHelper : public CppPrintHelper,
                               public VecPrintHelper {
@@ -144,6 +201,40 @@ namespace yask {
         // Set to var name of write mask if/when used.
         string _write_mask = "";
 
+        // Names of vars to write w/streaming stores.
+        set<string> _stream_vars;
+
+        // Plane buffers along the march dim.
+        // Offsets are in vec-lengths.
+        struct PlaneBuf {
+            string name;               // ptr to buffer.
+            int lo = 0, hi = 0;        // read offsets in march dim.
+            map<string, int> plo, phi; // read offsets in other domain dims.
+            map<string, string> begins, sizes, strides; // vars in other domain dims.
+            string plane_size;         // var containing vecs in one plane.
+            int get_num_planes() const { return hi - lo + 1; }
+        };
+
+        // Key: point w/no domain-dim offsets.
+        map<VarPoint, PlaneBuf> _plane_bufs;
+        string _march_dim;
+
+        // Semi-stencil sums.
+        vector<SemiSum> _semi_sums;
+        struct SemiCand {
+            num_expr_ptr_vec coeffs; // factors of coefficient.
+            VarPoint* pt;
+        };
+        map<Expr*, string> _semi_coeffs; // printed coefficients.
+
+        // Helpers for find_semi_sums().
+        virtual bool is_semi_point(const VarPoint& gp) const;
+        virtual int get_semi_dep_op(CommutativeExpr* ce) const;
+        virtual void semi_walk(num_expr_ptr& ep);
+        virtual void semi_collect(num_expr_ptr& ep, const num_expr_ptr_vec& coeffs,
+                                  vector<SemiCand>& cands);
+        virtual bool semi_extract(num_expr_ptr& ep, const set<Expr*>& chosen);
+
         // A simple constant.
         virtual string add_const_expr(ostream& os, double v) override {
             return CppPrintHelper::format_real(v);
@@ -199,6 +290,10 @@ namespace yask {
         virtual string read_from_scalar_point(ostream& os, const VarPoint& gp,
                                               const VarMap* var_map) override;
 
+        // Read a material index into a scalar var.
+        virtual string read_lookup_arg(ostream& os, const VarPoint& lp,
+                                       const VarMap* var_map) override;
+
         // Read from multiple points that are not vectorizable.
         // Return var name.
         virtual string print_partial_vec_read(ostream& os, const VarPoint& gp) override;
@@ -210,6 +305,9 @@ namespace yask {
             print_unaligned_vec_simple(os, gp, pv_name, _line_prefix);
         }
 
+        // Get plane buffer containing 'gp' or null if none.
+        virtual PlaneBuf* lookup_plane_buf(const VarPoint& gp);
+
         // Get offset from base pointer.
         virtual string get_var_base_ptr_offset(ostream& os, const VarPoint& gp,
                                                const VarMap* var_map = 0);
@@ -237,6 +335,17 @@ namespace yask {
             return _write_mask;
         }
 
+        // Vars to write w/streaming stores.
+        virtual void set_stream_vars(const set<string>& vnames) {
+            _stream_vars = vnames;
+        }
+
+        // Choose the number of vectors to compute in each iteration in
+        // the unroll-jam dim. 'nreads[i]' is the number of aligned vectors
+        // read when computing 'i+1' vectors, and 'nwrites' is the number
+        // of vectors written when computing one.
+        virtual int choose_unroll_factor(const vector<int>& nreads, int nwrites) const;
+
        // Set stage name.
         virtual void set_stage_name(const string& sname) {
             _stage_name = sname;
@@ -254,6 +363,15 @@ namespace yask {
         // if all writes were printed.
         virtual string write_to_point(ostream& os, const VarPoint& gp, const string& val) override;
 
+        // Print code to accumulate reductions of vector 'val'.
+        virtual void print_reduction(ostream& os, const VarPoint& gp,
+                                     const string& val) override;
+
+        // Print reduction accumulators before the loops and
+        // code to save their values after the loops.
+        virtual void print_reduction_prefix(ostream& os);
+        virtual void print_reduction_suffix(ostream& os);
+
         // Make var base point (first allocated point).
         virtual var_point_ptr make_var_base_point(const VarPoint& gp);
 
@@ -266,8 +384,9 @@ namespace yask {
         // Print things needed before inner loop.
         virtual void print_inner_loop_prefix(ostream& os);
 
-        // Print all aligned loads before they're needed.
-        virtual void print_early_loads(ostream& os);
+        // Print aligned loads before they're needed, up to 'max_loads'
+        // of them if non-negative. Return number printed.
+        virtual int print_early_loads(ostream& os, int max_loads = -1);
 
         // Print prefetches for each inner-loop base pointer.
         // 'in_loop': prefetch PF distance ahead instead of up to PF dist.
@@ -277,6 +396,35 @@ namespace yask {
         // 'in_loop': just shift and load last one.
         virtual void print_buffer_code(ostream& os, bool in_loop);
 
+        // Find input vars read at more than one offset in 'march_dim' that
+        // can be copied into plane buffers. Return whether any were found.
+        virtual bool find_plane_buffers(const string& march_dim);
+
+        // Print thread-private storage for the plane buffers.
+        virtual void print_plane_buffer_storage(ostream& os);
+
+        // Print start of loop over planes in the march dim inside
+        // the nano loops, including code to fill the plane buffers
+        // and pico-loop bounds for one plane.
+        virtual void print_plane_buffer_march(ostream& os);
+
+        // Find sums along the inner-loop dim in 'part' whose terms at
+        // negative offsets can be carried in partial sums, replacing
+        // those terms in 'part' w/the partial sums. 'part' is modified,
+        // so it should be a copy. Return whether any were found.
+        virtual bool find_semi_sums(Part& part);
+        virtual const vector<SemiSum>& get_semi_sums() const {
+            return _semi_sums;
+        }
+        virtual void set_semi_sums(const vector<SemiSum>& sums) {
+            _semi_sums = sums;
+        }
+
+        // Print semi-stencil code.
+        // 'in_loop': update partial sums for next iteration.
+        // Otherwise, declare and init them before the inner loop.
+        virtual void print_semi_sum_code(ostream& os, bool in_loop);
+
         // print init of rank constants.
         virtual void print_rank_data(ostream& os);
         
@@ -369,6 +517,54 @@ namespace yask {
         virtual string visit(VarPoint* gp);
     };
 
+    // Values that do not depend on the inner-loop dim.
+    // Finds each maximal sub-expression that does not use the inner-loop
+    // index, prints it before the inner loop, and saves the name of the
+    // var holding its value in the print helper for use in the loop body.
+    class CppPreInnerLoopPrintVisitor : public ExprVisitor {
+    protected:
+        ostream& _os;
+        CppVecPrintHelper& _cvph;
+        PrintVisitorBottomUp _pv;   // prints the hoisted exprs.
+        int _num_hoisted = 0;
+
+        // Print and save 'ep' if it does not depend on the inner-loop dim.
+        // Return whether it was hoisted.
+        virtual bool try_hoist(Expr* ep);
+
+    public:
+        CppPreInnerLoopPrintVisitor(ostream& os,
+                                    CppVecPrintHelper& ph) :
+            _os(os), _cvph(ph), _pv(os, ph) { }
+
+        int get_num_hoisted() const { return _num_hoisted; }
+
+        // A var access.
+        virtual string visit(VarPoint* gp);
+
+        // Ops: hoist whole expr if possible; otherwise, check children.
+        virtual string visit(UnaryNumExpr* ue) {
+            if (!try_hoist(ue))
+                ExprVisitor::visit(ue);
+            return "";
+        }
+        virtual string visit(BinaryNumExpr* be) {
+            if (!try_hoist(be))
+                ExprVisitor::visit(be);
+            return "";
+        }
+        virtual string visit(CommutativeExpr* ce) {
+            if (!try_hoist(ce))
+                ExprVisitor::visit(ce);
+            return "";
+        }
+        virtual string visit(FuncExpr* fe) {
+            if (!try_hoist(fe))
+                ExprVisitor::visit(fe);
+            return "";
+        }
+    };
+
     // Print out a stencil in C++ form for YASK.
     class YASKCppPrinter : public PrinterBase {
     protected:
@@ -418,6 +614,9 @@ namespace yask {
         }
         virtual ~YASKCppPrinter() { }
 
+        // Number of SIMD registers.
+        virtual int num_vec_regs() const override { return 16; }
+
         // Output all code for YASK.
         virtual void print(ostream& os);
     };
@@ -210,6 +210,9 @@ namespace yask {
 
         // Whether multi-dim folding is efficient.
         virtual bool is_folding_efficient() const override { return true; }
+
+        // Number of SIMD registers.
+        virtual int num_vec_regs() const override { return 32; }
     };
 
 } // namespace yask.
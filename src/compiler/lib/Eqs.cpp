@@ -71,7 +71,9 @@ namespace yask {
     public:
 
         // Ctor.
-        PointVisitor() {}
+        PointVisitor() {
+            _visit_var_point_args = true;
+        }
         virtual ~PointVisitor() {}
 
         // Get access to vars per eq.
@@ -159,6 +161,11 @@ namespace yask {
             default:
                 assert(0 && "illegal state");
             }
+
+            // Points nested in the args, e.g., 'mat(x, y)' in
+            // 'vel(mat(x, y))', are inputs in the current state.
+            if (_state != _in_lhs)
+                ExprVisitor::visit(vp);
             return "";
         }
     };
@@ -188,6 +195,9 @@ namespace yask {
             int var_nfd = var->get_num_foldable_dims();
             assert(var_nfd <= soln_nfd);
 
+            // Set vec types of any nested points first.
+            ExprVisitor::visit(vp);
+
             // Degenerate case with no folding in soln: we still mark points
             // using vars with some domain dims as vectorizable.
             if (soln_nfd == 0 && var->is_foldable())
@@ -215,10 +225,10 @@ namespace yask {
                 assert(fdoffsets <= var_nfd);
 
                 // All folded dims are vectorizable?
-                if (fdoffsets == soln_nfd) {
-                    assert(var->is_foldable());
+                // (Material-index vars are never folded even if they
+                // use all the folded dims.)
+                if (fdoffsets == soln_nfd && var->is_foldable())
                     vp->set_vec_type(VarPoint::VEC_FULL); // all good.
-                }
 
                 // Some dims are vectorizable?
                 else if (fdoffsets > 0)
@@ -230,8 +240,16 @@ namespace yask {
 
             }
 
-            // Also check args of this var point.
-            return ExprVisitor::visit(vp);
+            // A table lookup via a material index that may vary across
+            // vector lanes must be read one element at a time.
+            for (size_t ai = 0; ai < vp->get_args().size(); ai++) {
+                auto lp = vp->get_lookup_arg(ai);
+                if (lp && lp->get_vec_type() != VarPoint::VEC_NONE) {
+                    vp->set_vec_type(VarPoint::VEC_PARTIAL);
+                    break;
+                }
+            }
+            return "";
         }
     };
 
@@ -271,6 +289,9 @@ namespace yask {
         // Check each var point in expr.
         virtual string visit(VarPoint* vp) {
 
+            // Check any nested points first.
+            ExprVisitor::visit(vp);
+
             // Info from var.
             auto* var = vp->_get_var();
             auto gdims = var->get_dim_names();
@@ -350,6 +371,33 @@ namespace yask {
         }
     };
 
+    // Visitor that counts the uses of a domain index and how many of
+    // them are simple offsets in var-point args.
+    class ShiftCheckVisitor: public ExprVisitor {
+        string _dname;
+
+    public:
+        int num_uses = 0;
+        int num_offsets = 0;
+        
+        ShiftCheckVisitor(const string& dname) :
+            _dname(dname) {
+            _visit_equals_lhs = true;
+            _visit_var_point_args = true;
+        }
+
+        virtual string visit(IndexExpr* ie) {
+            if (ie->get_type() == DOMAIN_INDEX && ie->_get_name() == _dname)
+                num_uses++;
+            return "";
+        }
+        virtual string visit(VarPoint* vp) {
+            if (vp->get_arg_offsets().lookup(_dname))
+                num_offsets++;
+            return ExprVisitor::visit(vp);
+        }
+    };
+
     ////////// Methods.
 
     // Analyze group of equations.
@@ -404,6 +452,12 @@ namespace yask {
                 eq1->make_quoted_str() << "...\n";
             #endif
 
+            // LHS cannot be a material-index var.
+            if (ov1->is_material_index())
+                THROW_YASK_EXCEPTION("LHS of equation " + eq1->make_quoted_str() +
+                                     " is material-index var '" + ov1->_get_name() +
+                                     "', which is read-only");
+
             // LHS must have all domain dims.
             for (auto& dd : dims._domain_dims) {
                 auto& dname = dd._get_name();
@@ -424,6 +478,9 @@ namespace yask {
                 if (step_expr1)
                     THROW_YASK_EXCEPTION("scratch-var equation " + eq1->make_quoted_str() +
                                          " cannot use step-dimension '" + step_dim + "'");
+                if (eq1->get_reductions())
+                    THROW_YASK_EXCEPTION("scratch-var equation " + eq1->make_quoted_str() +
+                                         " cannot request reductions");
             }
 
             // Check LHS var dimensions and associated args.
@@ -569,8 +626,8 @@ namespace yask {
                                                  "' is expected");
                     }
 
-                    // Misc dim must be a const.
-                    else {
+                    // Misc dim must be a const or a material index.
+                    else if (!i1->get_lookup_arg(di)) {
                         if (!argn->is_const_val())
                             THROW_YASK_EXCEPTION("RHS of equation " + eq1->make_quoted_str() +
                                                  " contains expression " + argn->make_quoted_str() +
@@ -774,6 +831,20 @@ namespace yask {
             for (auto ap : all_pts1) {
                 auto* g = ap->_get_var(); // var for point 'ap'.
                 g->update_const_indices(ap->get_arg_consts());
+
+                // A table indexed by a material-index var must cover
+                // every value the index var can hold.
+                for (int di = 0; di < g->get_num_dims(); di++) {
+                    auto lp = ap->get_lookup_arg(di);
+                    if (lp) {
+                        auto& dname = g->get_dim_name(di);
+                        IntTuple range;
+                        range.add_dim_back(dname, 0);
+                        g->update_const_indices(range);
+                        range[dname] = lp->_get_var()->get_max_material_index();
+                        g->update_const_indices(range);
+                    }
+                }
             }
         }
     }
@@ -882,6 +953,42 @@ namespace yask {
         return des;
     }
 
+    // Create a copy of this part with every var point shifted by 'ofs'
+    // in domain dim 'dname'. Return null if 'dname' is used other than
+    // as a simple offset in a var-point arg.
+    PartPtr Part::clone_shifted(const string& dname, int ofs) const {
+        ShiftCheckVisitor scv(dname);
+        for (auto& eq : get_eqs())
+            eq->accept(&scv);
+        if (scv.num_uses != scv.num_offsets)
+            return nullptr;
+
+        auto p = clone();
+        IntTuple sofs;
+        sofs.add_dim_back(dname, ofs);
+        OffsetVisitor ov(sofs);
+        p->visit_eqs(&ov);
+        return p;
+    }
+
+    // Get the reductions requested by the eqs in this part.
+    vector<pair<string, int>> Part::get_reductions() const {
+        vector<pair<string, int>> reds;
+        for (auto& eq : get_eqs()) {
+            int mask = eq->get_reductions();
+            if (!mask)
+                continue;
+            auto& vname = eq->get_lhs_var()->_get_name();
+            auto it = find_if(reds.begin(), reds.end(),
+                              [&](const pair<string, int>& r) { return r.first == vname; });
+            if (it == reds.end())
+                reds.push_back({ vname, mask });
+            else
+                it->second |= mask;
+        }
+        return reds;
+    }
+
     // Print stats from eqs in parts.
     void Parts::print_stats(const string& msg) {
         auto& os = _soln->get_ostr();
@@ -897,6 +1004,35 @@ namespace yask {
         cv.print_stats(os, msg);
     }
 
+    // Estimate SIMD registers needed to compute one vector of each of
+    // 'eqs' and 'eq' (if not null) in one part. Aligned vectors read by
+    // more than one eq are assumed to stay live across the part, and
+    // each eq needs registers to evaluate its RHS on top of those.
+    int Parts::est_vec_regs(const EqList& eqs, Eq eq) const {
+        auto& dims = _soln->get_dims();
+        map<VarPoint, int> num_eqs_reading;
+        int max_need = 0;
+        auto add_eq = [&](Eq ep) {
+            VecInfoVisitor vv(dims);
+            ep->accept(&vv);
+            for (auto& gp : vv._aligned_vecs)
+                num_eqs_reading[gp]++;
+            RegNeedVisitor rnv;
+            ep->accept(&rnv);
+            max_need = std::max(max_need, rnv.get_max_need());
+        };
+        for (auto& ep : eqs)
+            add_eq(ep);
+        if (eq)
+            add_eq(eq);
+
+        int nshared = 0;
+        for (auto& i : num_eqs_reading)
+            if (i.second > 1)
+                nshared++;
+        return nshared + max_need;
+    }
+
     // Add 'eq' to an existing part if possible.  If not possible,
     // create a new part and add 'eqs' to it. The index will be
     // incremented if a new part is created.  Returns whether a new part
@@ -1021,6 +1157,10 @@ namespace yask {
             #ifdef DEBUG_ADD_EXPRS
             cout << "** ae2b: will check " << rel_eqs.size() << " related eqs\n";
             #endif
+
+            // Registers needed by 'eq' alone.
+            int nregs = settings._bundle_regs ? settings._num_vec_regs : 0;
+            int eq_regs = (nregs > 0) ? est_vec_regs(EqList(), eq) : 0;
             
             // Loop through existing parts, looking for one that
             // 'eq' can be added to.
@@ -1096,6 +1236,20 @@ namespace yask {
                             break;
                     } // eqs in part.
                 } // if ok.
+
+                // Don't bundle if the part would then be estimated to
+                // spill registers when neither 'p' nor 'eq' would alone.
+                if (is_ok && nregs > 0 && eq_regs <= nregs &&
+                    est_vec_regs(p->get_eqs(), nullptr) <= nregs) {
+                    int part_regs = est_vec_regs(p->get_eqs(), eq);
+                    if (part_regs > nregs) {
+                        _soln->get_ostr() << "Not bundling equation updating " <<
+                            eq->_get_lhs()->make_quoted_str() <<
+                            " into " << p->get_descr() << " because it would need an estimated " <<
+                            part_regs << " SIMD registers, and " << nregs << " are available.\n";
+                        is_ok = false;
+                    }
+                }
                     
                 // Remember target part if ok and stop looking.
                 // Try to add if ok.
@@ -1260,14 +1414,22 @@ namespace yask {
             opts.push_back(new CseVisitor);
 
         // Operator combination.
-        if (settings._do_comb) {
+        if (settings._do_comb)
             opts.push_back(new CombineVisitor);
 
-            // Do CSE again after combination.
-            // TODO: do this only if the combination did something.
-            if (settings._do_cse)
-                opts.push_back(new CseVisitor);
-        }
+        // Factoring.
+        if (settings._do_factor)
+            opts.push_back(new FactorVisitor);
+
+        // Grouping of loop-invariant operands.
+        if (settings._do_hoist)
+            opts.push_back(new InvariantGroupVisitor(settings._inner_loop_dim));
+
+        // Do CSE again after combination, factoring, and/or grouping.
+        // TODO: do this only if the previous opts did something.
+        if ((settings._do_comb || settings._do_factor || settings._do_hoist) &&
+            settings._do_cse)
+            opts.push_back(new CseVisitor);
 
         // Pairs.
         if (settings._do_pairs)
@@ -1276,6 +1438,11 @@ namespace yask {
         // Apply opts.
         for (auto optimizer : opts) {
 
+            // Factoring needs the references to each node after the
+            // previous opts.
+            if (auto fv = dynamic_cast<FactorVisitor*>(optimizer))
+                visit_eqs(&fv->get_ref_counter());
+
             visit_eqs(optimizer);
             int num_changes = optimizer->get_num_changes();
             string odescr = "after applying " + optimizer->_get_name() + " to " +
@@ -2029,5 +2196,78 @@ namespace yask {
             os << "    " << mi.second << " with misc-dim size " <<
                 mi.first << ".\n";
     }
+
+    // Find the vars written by each stage that are not read again at the
+    // written step by the same stage or by any stage that depends on it.
+    // These values are not reused within the working set of a block, so
+    // they can be stored without first reading the cache lines.
+    void Stages::calc_stream_vars() {
+        auto& os = _soln->get_ostr();
+        auto& settings = _soln->get_settings();
+        auto& step_dim = _soln->get_dims()._step_dim;
+        os << "Finding vars without reuse for streaming stores...\n";
+
+        // Find all LHS and RHS points and vars for all eqs.
+        PointVisitor pv;
+        visit_eqs(&pv);
+
+        int nsv = 0;
+        for (auto& st : get_all()) {
+            st->_stream_vars.clear();
+            if (!settings._stream_writes || st->is_scratch())
+                continue;
+
+            // Step offsets written to each var.
+            map<Var*, set<int>> written;
+            set<Var*> no_stream;
+            for (auto& eq : st->get_eqs()) {
+                auto* op = pv.get_output_pts().at(eq.get());
+                auto* g = op->_get_var();
+                auto* lofsp = op->get_arg_offsets().lookup(step_dim);
+                if (g->is_scratch() || !lofsp)
+                    no_stream.insert(g);
+                else
+                    written[g].insert(*lofsp);
+            }
+
+            // This stage, the stages that depend on it, and
+            // their scratch stages may reuse the written values.
+            vector<StagePtr> readers;
+            for (auto& rst : get_all()) {
+                if (rst != st && settings._find_deps &&
+                    !get_deps().is_dep_on(rst, st))
+                    continue;
+                readers.push_back(rst);
+                for (auto& ss : get_all_scratch_deps_on(rst))
+                    readers.push_back(ss);
+            }
+
+            // Any read at a written step is a reuse.
+            for (auto& rst : readers) {
+                for (auto& eq : rst->get_eqs()) {
+                    auto* op = pv.get_output_pts().at(eq.get());
+                    for (auto* ip : pv.get_all_pts().at(eq.get())) {
+                        auto* g = ip->_get_var();
+                        if (ip == op || !written.count(g))
+                            continue;
+                        auto* rofsp = ip->get_arg_offsets().lookup(step_dim);
+                        if (!rofsp || written.at(g).count(*rofsp))
+                            no_stream.insert(g);
+                    }
+                }
+            }
+
+            for (auto& wi : written) {
+                auto* g = wi.first;
+                if (!no_stream.count(g)) {
+                    st->_stream_vars.insert(g->_get_name());
+                    os << "  Var '" << g->_get_name() << "' in stage '" <<
+                        st->_get_name() << "' will use streaming stores.\n";
+                    nsv++;
+                }
+            }
+        }
+        os << "  " << nsv << " var(s) will use streaming stores.\n";
+    }
     
 } // namespace yask.
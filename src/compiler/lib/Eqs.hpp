@@ -715,6 +715,16 @@ namespace yask {
             }
             return false;
         }
+
+        // Create a copy with every var point shifted by 'ofs' in domain
+        // dim 'dname'. Returns null if the eqs use 'dname' other than
+        // as a simple offset.
+        virtual Tp<Part> clone_shifted(const string& dname, int ofs) const;
+
+        // Get the reductions requested by the eqs in this part:
+        // one entry per var name w/the OR of the reduction masks,
+        // in order of first appearance.
+        virtual vector<pair<string, int>> get_reductions() const;
     };
     typedef Tp<Part> PartPtr;
     typedef TpList<Part> PartList;
@@ -742,6 +752,10 @@ namespace yask {
         // Returns whether a new part was created.
         virtual bool add_eq_to_part(Eq& eq);
 
+        // Estimate SIMD registers needed to compute one vector of each of
+        // 'eqs' and 'eq' (if not null) in one part.
+        virtual int est_vec_regs(const EqList& eqs, Eq eq) const;
+
     public:
         Parts(Solution* soln) :
             _soln(soln),
@@ -783,6 +797,10 @@ namespace yask {
 
     public:
 
+        // Names of output vars that can use streaming stores.
+        // Set by Stages::calc_stream_vars().
+        set<string> _stream_vars;
+
         // Ctor.
         Stage(Solution* soln, bool is_scratch) :
             EqLot(soln, is_scratch) { }
@@ -876,6 +894,9 @@ namespace yask {
         // Find lifespans for each var.
         virtual void calc_lifespans();
 
+        // Find output vars that can use streaming stores.
+        virtual void calc_stream_vars();
+
     }; // Stages.
 
 } // namespace yask.
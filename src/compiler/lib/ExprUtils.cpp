@@ -70,6 +70,162 @@ namespace yask {
     }
 
 
+    num_expr_ptr FactorVisitor::remove_factor(const shared_ptr<MultExpr>& mp,
+                                              const num_expr_ptr& fac) const {
+        auto rest = make_shared<MultExpr>();
+        bool removed = false;
+        for (auto& fac2 : mp->get_ops()) {
+            if (!removed && fac2->is_same(fac))
+                removed = true;
+            else
+                rest->append_op(fac2);
+        }
+        if (rest->get_ops().size() == 0)
+            return make_shared<ConstExpr>(1.0);
+        if (rest->get_ops().size() == 1)
+            return rest->get_ops().front();
+        return rest;
+    }
+
+    void FactorVisitor::factor(num_expr_ptr& ep) {
+
+        // Visit children first (depth-first).
+        ep->accept(this);
+
+        // Differences: factor 'c*a - c*b' into 'c*(a - b)'.
+        if (auto se = dynamic_pointer_cast<SubExpr>(ep)) {
+            auto ml = get_prod(se->_get_lhs());
+            auto mr = get_prod(se->_get_rhs());
+            if (!ml || !mr)
+                return;
+
+            // Find a common multiplicand, preferring constants.
+            num_expr_ptr best_fac;
+            for (auto& fac : ml->get_ops()) {
+                for (auto& fac2 : mr->get_ops()) {
+                    if (fac2->is_same(fac) &&
+                        (!best_fac || (fac->is_const_val() && !best_fac->is_const_val())))
+                        best_fac = fac;
+                }
+            }
+            if (!best_fac)
+                return;
+
+            // There may be more common factors in the new difference.
+            num_expr_ptr diff = make_shared<SubExpr>(remove_factor(ml, best_fac),
+                                                     remove_factor(mr, best_fac));
+            factor(diff);
+            ep = make_shared<MultExpr>(best_fac, diff);
+            _num_changes++;
+            return;
+        }
+
+        // Otherwise, only sums are candidates.
+        auto ce = dynamic_pointer_cast<AddExpr>(ep);
+        if (!ce)
+            return;
+        auto& ops = ce->get_ops();
+
+        // Repeat until no changes.
+        while (ops.size() > 1) {
+
+            // Find the multiplicand that appears in the most
+            // products in 'ops'. Prefer constants on ties because
+            // those are usually the FD coefficients.
+            num_expr_ptr best_fac;
+            vector<size_t> best_idxs;
+            for (size_t i = 0; i < ops.size(); i++) {
+                auto mi = get_prod(ops[i]);
+                if (!mi)
+                    continue;
+                for (auto& fac : mi->get_ops()) {
+
+                    // Collect the products containing 'fac'.
+                    vector<size_t> idxs;
+                    idxs.push_back(i);
+                    for (size_t j = i + 1; j < ops.size(); j++) {
+                        auto mj = get_prod(ops[j]);
+                        if (!mj)
+                            continue;
+                        for (auto& fac2 : mj->get_ops()) {
+                            if (fac2->is_same(fac)) {
+                                idxs.push_back(j);
+                                break;
+                            }
+                        }
+                    }
+                    if (idxs.size() > best_idxs.size() ||
+                        (idxs.size() == best_idxs.size() && idxs.size() > 1 &&
+                         fac->is_const_val() && !best_fac->is_const_val())) {
+                        best_fac = fac;
+                        best_idxs = idxs;
+                    }
+                }
+            }
+            if (best_idxs.size() < 2)
+                break;
+
+            // Make sum of the products w/o the common factor.
+            auto sum = make_shared<AddExpr>();
+            for (auto i : best_idxs)
+                sum->append_op(remove_factor(dynamic_pointer_cast<MultExpr>(ops[i]),
+                                             best_fac));
+
+            // There may be more common factors inside the new sum.
+            num_expr_ptr sum_ep = sum;
+            factor(sum_ep);
+
+            // Replace the products w/factor * sum.
+            auto prod = make_shared<MultExpr>(best_fac, sum_ep);
+            for (auto it = best_idxs.rbegin(); it != best_idxs.rend(); it++)
+                ops.erase(ops.begin() + *it);
+            ce->append_op(prod);
+            _num_changes++;
+        }
+
+        // Replace a sum of one term w/just that term.
+        if (ops.size() == 1)
+            ep = ops.front();
+    }
+
+    string InvariantGroupVisitor::visit(CommutativeExpr* ce) {
+        auto& ops = ce->get_ops();
+
+        // Visit ops first (depth-first).
+        for (auto ep : ops) {
+            ep->accept(this);
+        }
+
+        // Separate ops by dependence on the inner-loop dim.
+        num_expr_ptr_vec dep_ops, invar_ops;
+        for (auto ep : ops) {
+            IndexDepVisitor idv(_dname);
+            ep->accept(&idv);
+            if (idv.is_dep())
+                dep_ops.push_back(ep);
+            else
+                invar_ops.push_back(ep);
+        }
+
+        // Need at least 2 invariant ops to make a group and
+        // at least 1 dependent op to make a difference.
+        if (invar_ops.size() < 2 || dep_ops.size() < 1)
+            return "";
+
+        // Make a new expr of the same type w/the invariant ops.
+        auto group = dynamic_pointer_cast<CommutativeExpr>(ce->clone());
+        assert(group);
+        group->get_ops().clear();
+        for (auto ep : invar_ops)
+            group->append_op(ep);
+
+        // Replace the ops.
+        ops = dep_ops;
+        ops.push_back(group);
+        _num_changes++;
+        return "";
+    }
+
     // If 'ep' has already been seen, just return true.
     // Else if 'ep' has a match, change pointer to that match, return true.
     // Else, return false.
@@ -151,4 +307,31 @@ namespace yask {
         return "";
     }
 
+    // Commutative ops are printed as 'a + b + c', so the partial result
+    // of the ops to the left is live while each op is evaluated.
+    string RegNeedVisitor::visit(CommutativeExpr* ce) {
+        int n = 0;
+        bool first = true;
+        for (auto& ep : ce->get_ops()) {
+            int opn = get_need(ep);
+            n = first ? opn : std::max(n, opn + 1);
+            first = false;
+        }
+        set_need(ce, n);
+        return "";
+    }
+
+    // All args are live at the call; evaluate the neediest first.
+    string RegNeedVisitor::visit(FuncExpr* fe) {
+        vector<int> arg_needs;
+        for (auto& ep : fe->get_ops())
+            arg_needs.push_back(get_need(ep));
+        sort(arg_needs.begin(), arg_needs.end(), greater<int>());
+        int n = 1;
+        for (size_t i = 0; i < arg_needs.size(); i++)
+            n = std::max(n, arg_needs[i] + int(i));
+        set_need(fe, n);
+        return "";
+    }
+
 } // namespace yask.
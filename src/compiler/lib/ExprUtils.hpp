@@ -71,6 +71,173 @@ namespace yask {
     };
 
 
+    // A visitor that counts the references to each numerical node from
+    // its parents, e.g., to find nodes shared after CSE. The operands of
+    // a node are visited only once, so references from inside a shared
+    // node are counted once.
+    class RefCountVisitor : public ExprVisitor {
+    protected:
+        map<num_expr_ptr, int> _counts;
+
+        // Count a reference to 'ep' and visit it the first time.
+        void ref(const num_expr_ptr& ep) {
+            if (_counts[ep]++ == 0)
+                ep->accept(this);
+        }
+
+    public:
+        RefCountVisitor() { }
+        virtual ~RefCountVisitor() { }
+
+        // Number of references to 'ep' (0 if not seen).
+        int get_count(const num_expr_ptr& ep) const {
+            auto it = _counts.find(ep);
+            return it == _counts.end() ? 0 : it->second;
+        }
+
+        virtual string visit(UnaryNumExpr* ue) {
+            ref(ue->_get_rhs());
+            return "";
+        }
+        virtual string visit(BinaryNumExpr* be) {
+            ref(be->_get_lhs());
+            ref(be->_get_rhs());
+            return "";
+        }
+        virtual string visit(CommutativeExpr* ce) {
+            for (auto& ep : ce->get_ops())
+                ref(ep);
+            return "";
+        }
+        virtual string visit(FuncExpr* fe) {
+            for (auto& ep : fe->get_ops())
+                ref(ep);
+            return "";
+        }
+        virtual string visit(EqualsExpr* ee) {
+            ref(ee->_get_rhs());
+            return "";
+        }
+    };
+
+    // A visitor that factors a common multiplicand out of
+    // products in a sum or difference.
+    // Examples: c*a + c*b + d => c*(a + b) + d;
+    // c*a - c*b => c*(a - b).
+    // Saves one multiply per additional product factored,
+    // e.g., for symmetric FD coefficients that were applied
+    // separately to each neighbor. Should be run after
+    // CombineVisitor so that sums and products are flattened.
+    // Factoring changes the order of FP operations, so results
+    // may differ in the last bits.
+    class FactorVisitor : public OptVisitor {
+    protected:
+
+        // References to each node. Products that are also referenced
+        // elsewhere, e.g., after CSE, must still be evaluated, so
+        // factoring them saves nothing.
+        RefCountVisitor _refs;
+
+        // Get 'ep' as a product if it is not shared.
+        shared_ptr<MultExpr> get_prod(const num_expr_ptr& ep) const {
+            return _refs.get_count(ep) > 1 ? nullptr :
+                dynamic_pointer_cast<MultExpr>(ep);
+        }
+
+        // Make the product of the operands of 'mp' w/o one
+        // instance of 'fac'.
+        num_expr_ptr remove_factor(const shared_ptr<MultExpr>& mp,
+                                   const num_expr_ptr& fac) const;
+
+        // Visit 'ep', then factor it if it is a sum or difference.
+        // If the expr is reduced to a single product,
+        // change 'ep' to point to that product.
+        virtual void factor(num_expr_ptr& ep);
+
+    public:
+        FactorVisitor()  :
+            OptVisitor("common-factor extraction") {}
+        virtual ~FactorVisitor() {}
+
+        // Visitor to count the references to each node. It must visit
+        // all the eqs before this visitor does.
+        RefCountVisitor& get_ref_counter() { return _refs; }
+
+        // For each visitor w/children, factor each child.
+        virtual string visit(UnaryNumExpr* ue) {
+            factor(ue->_get_rhs());
+            return "";
+        }
+        virtual string visit(BinaryNumExpr* be) {
+            factor(be->_get_lhs());
+            factor(be->_get_rhs());
+            return "";
+        }
+        virtual string visit(CommutativeExpr* ce) {
+            for (auto& ep : ce->get_ops())
+                factor(ep);
+            return "";
+        }
+        virtual string visit(FuncExpr* fe) {
+            for (auto& ep : fe->get_ops())
+                factor(ep);
+            return "";
+        }
+        virtual string visit(EqualsExpr* ee) {
+
+            // Only process RHS.
+            factor(ee->_get_rhs());
+            return "";
+        }
+    };
+
+    // A visitor that determines whether an expr depends on
+    // the value of a given domain index, e.g., the inner-loop dim.
+    // Args of var points are checked. Code exprs are assumed to
+    // depend on all indices.
+    class IndexDepVisitor : public ExprVisitor {
+    protected:
+        string _dname;
+        bool _is_dep = false;
+
+    public:
+        IndexDepVisitor(const string& dname) :
+            _dname(dname) {
+            _visit_var_point_args = true;
+        }
+        virtual ~IndexDepVisitor() {}
+
+        bool is_dep() const { return _is_dep; }
+
+        virtual string visit(IndexExpr* ie) {
+            if (ie->get_type() == DOMAIN_INDEX && ie->_get_name() == _dname)
+                _is_dep = true;
+            return "";
+        }
+        virtual string visit(CodeExpr* ce) {
+            _is_dep = true;
+            return "";
+        }
+    };
+
+    // A visitor that groups the operands of a commutative expr that do
+    // not depend on the inner-loop dim into a nested expr so they can
+    // be evaluated once before the inner loop.
+    // Example w/inner-loop dim 'z': a(x,y,z) * b(x) * c(z) * d(y) =>
+    // a(x,y,z) * c(z) * (b(x) * d(y)).
+    class InvariantGroupVisitor : public OptVisitor {
+    protected:
+        string _dname;
+
+    public:
+        InvariantGroupVisitor(const string& inner_dname)  :
+            OptVisitor("loop-invariant grouping"),
+            _dname(inner_dname) {}
+        virtual ~InvariantGroupVisitor() {}
+
+        virtual string visit(CommutativeExpr* ce) override;
+    };
+
     // A visitor that eliminates common numerical subexprs.
     // TODO: find matches to subsets of commutative operations;
     // example: a+b+c * b+d+a => c+(a+b) * d+(a+b) w/expr a+b combined.
@@ -330,6 +497,105 @@ namespace yask {
             return "";
         }
     };
-   
+
+    // A visitor that estimates the number of registers needed to evaluate
+    // an expression in one statement, i.e., without temp vars, using
+    // Sethi-Ullman numbering. Each operand of a commutative op is
+    // evaluated while the partial result of the preceding ones is live,
+    // matching how they are printed, and all args of a function are live
+    // at the call. Shared nodes are counted at each use, so the estimate
+    // is an upper bound for DAGs.
+    class RegNeedVisitor : public ExprVisitor {
+    protected:
+        map<Expr*, int> _needs;  // memoized need of each node visited.
+        int _max_need = 0;       // max need of any equation visited.
+
+        // Save and return need 'n' of 'ep'.
+        int set_need(Expr* ep, int n) {
+            _needs[ep] = n;
+            return n;
+        }
+
+        // Need of a node w/two operands that can be evaluated in any order.
+        static int need2(int l, int r) {
+            return (l == r) ? l + 1 : std::max(l, r);
+        }
+
+    public:
+        RegNeedVisitor() {}
+        virtual ~RegNeedVisitor() {}
+
+        // Return need of 'ep', visiting it first if needed.
+        int get_need(Expr* ep) {
+            auto it = _needs.find(ep);
+            if (it != _needs.end())
+                return it->second;
+            ep->accept(this);
+            return _needs.at(ep);
+        }
+        int get_need(expr_ptr ep) {
+            return get_need(ep.get());
+        }
+
+        // Return max need of the RHS of any equation visited.
+        int get_max_need() const { return _max_need; }
+
+        // Leaf nodes.
+        virtual string visit(ConstExpr* ce) {
+            set_need(ce, 1);
+            return "";
+        }
+        virtual string visit(CodeExpr* ce) {
+            set_need(ce, 1);
+            return "";
+        }
+        virtual string visit(IndexExpr* ie) {
+            set_need(ie, 1);
+            return "";
+        }
+        virtual string visit(VarPoint* gp) {
+            set_need(gp, 1);
+            return "";
+        }
+
+        // Unary: result can reuse operand's reg.
+        virtual string visit(UnaryNumExpr* ue) {
+            set_need(ue, get_need(ue->_get_rhs()));
+            return "";
+        }
+        virtual string visit(UnaryBoolExpr* ue) {
+            set_need(ue, get_need(ue->_get_rhs()));
+            return "";
+        }
+        virtual string visit(UnaryNum2BoolExpr* ue) {
+            set_need(ue, get_need(ue->_get_rhs()));
+            return "";
+        }
+
+        // Binary.
+        virtual string visit(BinaryNumExpr* be) {
+            set_need(be, need2(get_need(be->_get_lhs()), get_need(be->_get_rhs())));
+            return "";
+        }
+        virtual string visit(BinaryBoolExpr* be) {
+            set_need(be, need2(get_need(be->_get_lhs()), get_need(be->_get_rhs())));
+            return "";
+        }
+        virtual string visit(BinaryNum2BoolExpr* be) {
+            set_need(be, need2(get_need(be->_get_lhs()), get_need(be->_get_rhs())));
+            return "";
+        }
+
+        // N-ary.
+        virtual string visit(CommutativeExpr* ce);
+        virtual string visit(FuncExpr* fe);
+
+        // Equality: only RHS is evaluated.
+        virtual string visit(EqualsExpr* ee) {
+            _max_need = std::max(_max_need, get_need(ee->_get_rhs()));
+            return "";
+        }
+    };
+
 } // namespace yask.
 
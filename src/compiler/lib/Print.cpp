@@ -59,6 +59,8 @@ namespace yask {
     // A var read.
     // Uses the PrintHelper to format.
     string PrintVisitorTopDown::visit(VarPoint* gp) {
+        if (auto* v = _ph.lookup_expr_var(gp))
+            return *v;
         _num_common += _ph.get_num_common(gp);
         return _ph.read_from_point(_os, *gp);
     }
@@ -85,6 +87,8 @@ namespace yask {
 
     // Generic unary operators.
     string PrintVisitorTopDown::visit(UnaryNumExpr* ue) {
+        if (auto* v = _ph.lookup_expr_var(ue))
+            return *v;
         _num_common += _ph.get_num_common(ue);
         return ue->get_op_str() + ue->_get_rhs()->accept(this);
     }
@@ -99,6 +103,8 @@ namespace yask {
 
     // Generic binary operators.
     string PrintVisitorTopDown::visit(BinaryNumExpr* be) {
+        if (auto* v = _ph.lookup_expr_var(be))
+            return *v;
         _num_common += _ph.get_num_common(be);
         return "(" + be->_get_lhs()->accept(this) +
             " " + be->get_op_str() + " " +
@@ -119,6 +125,8 @@ namespace yask {
 
     // A commutative operator.
     string PrintVisitorTopDown::visit(CommutativeExpr* ce) {
+        if (auto* v = _ph.lookup_expr_var(ce))
+            return *v;
         _num_common += _ph.get_num_common(ce);
         string res = "(";
         auto& ops = ce->get_ops();
@@ -134,6 +142,8 @@ namespace yask {
 
     // A function call.
     string PrintVisitorTopDown::visit(FuncExpr* fe) {
+        if (auto* v = _ph.lookup_expr_var(fe))
+            return *v;
         _num_common += _ph.get_num_common(fe);
 
         // Special case: increment common node count
@@ -198,15 +208,25 @@ namespace yask {
         bool too_big = expr_size > get_settings()._max_expr_size;
         bool too_small = expr_size < get_settings()._min_expr_size;
 
+        // Also too big if evaluating it in one statement is estimated
+        // to need more registers than available.
+        if (!too_big && !force && _max_regs > 0)
+            too_big = _reg_need.get_need(ex) > _max_regs;
+
         // Determine whether this expr has already been evaluated
         // and a variable holds its result.
         auto p = _temp_vars.find(ex);
+        auto* ev = _ph.lookup_expr_var(ex);
         if (p != _temp_vars.end()) {
 
             // if so, just use the existing var.
             res = p->second;
         }
 
+        // Or evaluated outside the current loop.
+        else if (ev)
+            res = *ev;
+
         // Consider top down if forcing or expr <= max_expr_size.
         else if (force || !too_big) {
 
@@ -333,6 +353,8 @@ namespace yask {
                 // Just use existing result.
                 res = _temp_vars.at(fe);
             }
+            else if (auto* ev = _ph.lookup_expr_var(fe))
+                res = *ev;
 
             // No result yet.
             else {
@@ -46,6 +46,7 @@ namespace yask {
         string _line_prefix;         // prefix for each line.
         string _line_suffix;         // suffix for each line.
         VarMap _local_vars;          // map from expression strings to local var names.
+        map<Expr*, string> _expr_vars; // map from exprs evaluated outside a loop to var names.
 
     public:
         PrintHelper(const CompilerSettings& settings,
@@ -66,6 +67,9 @@ namespace yask {
         const CounterVisitor* get_counters() const { return _cv; }
         virtual void forget_local_vars() { _local_vars.clear(); }
 
+        // Number of SIMD registers on the target (0 => unknown).
+        virtual int get_num_vec_regs() const { return _settings._num_vec_regs; }
+
         // get dims & settings.
         const Dimensions& get_dims() const {
             return _dims;
@@ -119,6 +123,20 @@ namespace yask {
             return v_name;
         }
 
+        // Save var name holding the value of 'ep', which was
+        // evaluated outside the current loop.
+        virtual void save_expr_var(Expr* ep, const string& var) {
+            _expr_vars[ep] = var;
+        }
+
+        // If var exists holding the value of 'ep', return ptr to its name.
+        virtual const string* lookup_expr_var(Expr* ep) const {
+            auto p = _expr_vars.find(ep);
+            if (p == _expr_vars.end())
+                return 0;
+            return &p->second;
+        }
+
         // Return any code expression.
         // The 'os' parameter is provided for derived types that
         // need to write intermediate code to a stream.
@@ -254,14 +272,28 @@ namespace yask {
     // Outputs an AST traversed in a bottom-up fashion with multiple
     // sub-expressions, each assigned to a temp var.  The min/max_expr_size
     // vars in CompilerSettings control when and where expressions are
-    // sub-divided. Within each sub-expression, a top-down visitor is used.
+    // sub-divided. If _auto_expr_size is set, expressions estimated to need
+    // more registers than available are also sub-divided. Within each
+    // sub-expression, a top-down visitor is used.
     class PrintVisitorBottomUp : public PrintVisitorBase {
+    protected:
+        RegNeedVisitor _reg_need; // register-need estimates.
+        int _max_regs = 0;        // registers available (0 => no limit).
 
     public:
         // os is used for printing intermediate results as needed.
         PrintVisitorBottomUp(ostream& os, PrintHelper& ph,
                              const VarMap* var_map = 0) :
-            PrintVisitorBase(os, ph, var_map) {}
+            PrintVisitorBase(os, ph, var_map) {
+            if (ph.get_settings()._auto_expr_size)
+                _max_regs = ph.get_num_vec_regs();
+        }
+
+        // Set registers available to each expression, e.g., when some
+        // are already holding values (0 => no limit).
+        virtual void set_max_regs(int nregs) {
+            _max_regs = nregs;
+        }
 
         // make a new top-down visitor with the same print helper.
         virtual PrintVisitorTopDown* new_print_visitor_top_down() {
@@ -450,6 +482,14 @@ namespace yask {
         // Whether multi-dim folding is efficient.
         virtual bool is_folding_efficient() const { return false; }
 
+        // Number of SIMD registers.
+        // 0 => unknown.
+        virtual int num_vec_regs() const { return 0; }
+
+        // Number of bytes in a cache line.
+        // Same as CACHELINE_BYTES in the kernel for all current targets.
+        virtual int cache_line_bytes() const { return 64; }
+
         // Output to 'os'.
         virtual void print(ostream& os) =0;
 
@@ -151,6 +151,56 @@ namespace yask {
         assert(_inner_loop_dim_num > 0);
         assert(_inner_loop_dim_num <= ndd);
 
+        // Unroll-and-jam dim.
+        // Default is the domain dim just outside of the inner-loop dim.
+        _unroll_jam_dim_num = 0;
+        if (settings._unroll_jam != 1) {
+            auto& ujd = settings._unroll_jam_dim;
+            int dn = (_inner_loop_dim_num > 1) ? _inner_loop_dim_num - 1 : 2;
+            if (ujd.length()) {
+                if (isdigit(ujd[0]))
+                    dn = atoi(ujd.c_str());
+                else
+                    dn = _domain_dims.lookup_posn(ujd) + 1;
+            }
+            if (dn < 1 || dn > ndd || dn == _inner_loop_dim_num) {
+                os << "Note: unroll-and-jam disabled because ";
+                if (ujd.length())
+                    os << "unroll-jam-dim '" << ujd << "' is not an outer domain dim.\n";
+                else
+                    os << "there is no outer domain dim.\n";
+                settings._unroll_jam = 1;
+            } else {
+                ujd = _domain_dims.get_dim_name(dn - 1);
+                _unroll_jam_dim_num = dn;
+            }
+        }
+
+        // Plane-buffer march dim.
+        // Default is the first domain dim that isn't the inner-loop dim.
+        _plane_buffer_dim_num = 0;
+        if (settings._plane_buffer) {
+            auto& pbd = settings._plane_buffer_dim;
+            int dn = (_inner_loop_dim_num > 1) ? 1 : 2;
+            if (pbd.length()) {
+                if (isdigit(pbd[0]))
+                    dn = atoi(pbd.c_str());
+                else
+                    dn = _domain_dims.lookup_posn(pbd) + 1;
+            }
+            if (dn < 1 || dn > ndd || dn == _inner_loop_dim_num) {
+                os << "Note: plane buffering disabled because ";
+                if (pbd.length())
+                    os << "plane-buffer-dim '" << pbd << "' is not an outer domain dim.\n";
+                else
+                    os << "there is no outer domain dim.\n";
+                settings._plane_buffer = false;
+            } else {
+                pbd = _domain_dims.get_dim_name(dn - 1);
+                _plane_buffer_dim_num = dn;
+            }
+        }
+
         // Extract domain fold lengths based on cmd-line options.
         IntTuple fold_opts;
         for (auto& dim : _domain_dims) {
@@ -471,6 +521,69 @@ namespace yask {
                            "This may result in more values stored in registers rather than being re-read in each loop iteration "
                            "when multiple stencil inputs must be read along the inner-loop dimension.",
                            _min_buffer_len));
+        parser.add_option(make_shared<command_line_parser::int_option>
+                          ("unroll-jam",
+                           "[Advanced] "
+                           "Compute <n> consecutive vectors in the unroll-jam dimension in each iteration "
+                           "of the inner kernel loop, sharing vectors read by more than one of them. "
+                           "Use 1 to disable or 0 to select <n> using a model of vector-register usage.",
+                           _unroll_jam));
+        parser.add_option(make_shared<command_line_parser::string_option>
+                          ("unroll-jam-dim",
+                           "[Advanced] "
+                           "Name of the dimension used for unroll-and-jam. "
+                           "It must be a domain dimension other than the inner-loop dimension. "
+                           "The default is the domain dimension just outside the inner-loop dimension. "
+                           "For this option, a numerical index is allowed: '1' is the first domain-dim, etc.",
+                           _unroll_jam_dim));
+        parser.add_option(make_shared<command_line_parser::bool_option>
+                          ("plane-buffer",
+                           "[Advanced] "
+                           "March through the plane-buffer dimension one vector-plane at a time, "
+                           "copying each plane of an input var read at several offsets in that dimension "
+                           "into a thread-private rotating buffer. "
+                           "Each input vector is then loaded from the var once per sweep "
+                           "instead of once for each plane that uses it. "
+                           "Buffer sizes follow the nano-block size, which should be set so that "
+                           "the buffers fit in the L1 or L2 cache. "
+                           "Unroll-and-jam is not used in parts with plane buffers.",
+                           _plane_buffer));
+        parser.add_option(make_shared<command_line_parser::string_option>
+                          ("plane-buffer-dim",
+                           "[Advanced] "
+                           "Name of the dimension to march through when plane buffers are enabled. "
+                           "It must be a domain dimension other than the inner-loop dimension. "
+                           "The default is the first domain dimension other than the inner-loop dimension. "
+                           "For this option, a numerical index is allowed: '1' is the first domain-dim, etc.",
+                           _plane_buffer_dim));
+        parser.add_option(make_shared<command_line_parser::string_option>
+                          ("semi-stencil",
+                           "[Advanced] "
+                           "Generate semi-stencil code for each part whose name or updated var names "
+                           "match the regular expression defined in <string>. "
+                           "In such parts, the terms of a sum along the inner-loop dimension at "
+                           "negative offsets are not read in each iteration; instead, "
+                           "each one is accumulated from a point read at a non-negative offset "
+                           "into partial sums carried to later output vectors. "
+                           "Only aligned terms with a loop-invariant coefficient are carried. "
+                           "Unroll-and-jam and plane buffers are not used in such parts.",
+                           _semi_stencil));
+        parser.add_option(make_shared<command_line_parser::int_option>
+                          ("vec-math",
+                           "[Advanced] "
+                           "Use inline SIMD polynomial approximations for the math functions "
+                           "sqrt, cbrt, fabs, erf, exp, log, sin, cos, and atan in vector code "
+                           "instead of SVML or per-element libm calls. "
+                           "1: errors near the precision of the FP type; "
+                           "2: faster with lower accuracy; "
+                           "0: disable. "
+                           "The inline erf is only used at level 2 with 4-byte FP elements; "
+                           "SVML or libm is used otherwise. "
+                           "Only applies to AVX2 and AVX-512 targets. "
+                           "The level for each function can be overridden via the "
+                           "'YASK_VEC_MATH_<FN>' macro when building the kernel, e.g., "
+                           "'YASK_VEC_MATH_EXP=2'.",
+                           _vec_math));
         parser.add_option(make_shared<command_line_parser::bool_option>
                           ("inner-misc-layout",
                            "[Advanced] "
@@ -537,6 +650,14 @@ namespace yask {
                            "Bundle scratch equations together even if the sizes of some scratch vars must be increased "
                            "in order to do so.",
                            _bundle_scratch));
+        parser.add_option(make_shared<command_line_parser::bool_option>
+                          ("bundle-regs",
+                           "[Advanced] "
+                           "Do not bundle an equation into a solution part if the part would then be estimated "
+                           "to need more SIMD registers than available when neither the part nor the equation "
+                           "would alone. Vectors read by more than one equation in a part are assumed to stay "
+                           "in registers across the part. See -vec-regs.",
+                           _bundle_regs));
         parser.add_option(make_shared<command_line_parser::int_option>
                           ("halo",
                            "[Advanced] "
@@ -565,6 +686,25 @@ namespace yask {
                            "[Advanced] "
                            "Combine a sequence of commutative operations, e.g., 'a + b + c', into a single parse-tree node.",
                            _do_comb));
+        parser.add_option(make_shared<command_line_parser::bool_option>
+                          ("opt-factor",
+                           "[Advanced] "
+                           "Factor a common multiplicand out of products in a sum or difference, "
+                           "e.g., 'c*a + c*b' into 'c*(a + b)', reducing the number of multiplies. "
+                           "This changes the order of FP operations, so results may differ "
+                           "slightly from the unfactored code. "
+                           "Most effective when 'opt-comb' is also enabled.",
+                           _do_factor));
+        parser.add_option(make_shared<command_line_parser::bool_option>
+                          ("opt-hoist",
+                           "[Advanced] "
+                           "Evaluate sub-expressions that do not depend on the inner-loop dimension, "
+                           "e.g., reads of lower-dimensional damping profiles, "
+                           "before the inner loop instead of in every iteration. "
+                           "Commutative operands are regrouped as needed to expose such sub-expressions. "
+                           "This changes the order of FP operations, so results may differ "
+                           "slightly from the unhoisted code.",
+                           _do_hoist));
         parser.add_option(make_shared<command_line_parser::bool_option>
                           ("opt-reorder",
                            "[Advanced] "
@@ -592,6 +732,26 @@ namespace yask {
                            "Heuristic for minimum expression-size threshold for creating a temporary variable for reuse "
                            "when outputting code from a parse-tree.",
                            _min_expr_size));
+        parser.add_option(make_shared<command_line_parser::bool_option>
+                          ("auto-es",
+                           "[Advanced] "
+                           "Estimate the number of SIMD registers needed to evaluate each expression "
+                           "and split it into temporary variables when that would exceed the registers available. "
+                           "With -early-loads, also limit the loads issued early in each part so that they "
+                           "and the expressions fit in the registers.",
+                           _auto_expr_size));
+        parser.add_option(make_shared<command_line_parser::int_option>
+                          ("vec-regs",
+                           "[Advanced] "
+                           "Number of SIMD registers assumed by the register-pressure estimates. "
+                           "If zero, the number for the target is used.",
+                           _num_vec_regs));
+        parser.add_option(make_shared<command_line_parser::int_option>
+                          ("cache-line-bytes",
+                           "[Advanced] "
+                           "Number of bytes in a cache line assumed by the -auto-fold cost model. "
+                           "If zero, the size for the target is used.",
+                           _cache_line_bytes));
         parser.add_option(make_shared<command_line_parser::bool_option>
                           ("use-ptrs",
                            "[Advanced] "
@@ -610,6 +770,15 @@ namespace yask {
                            "Generate code to load variables early in the inner-kernel loop instead of "
                            "immediately before they are needed.",
                            _early_loads));
+        parser.add_option(make_shared<command_line_parser::bool_option>
+                          ("stream-writes",
+                           "[Advanced] "
+                           "Generate code to use streaming (non-temporal) stores for vars that "
+                           "are not read again at the written step by the same stage or by a "
+                           "dependent stage. Streaming stores are used only when the kernel is "
+                           "built with 'streaming_stores=1' and no wave-front or temporal "
+                           "tiling is used at run time.",
+                           _stream_writes));
         parser.add_option(make_shared<IntTupleOption>
                           ("fold",
                            "The recommended number of elements in each given dimension in a vector block. "
@@ -618,6 +787,15 @@ namespace yask {
                            "formats with defined lengths (e.g., 16 for 'avx512' when using 4-byte reals), "
                            "lengths will adjusted as needed.",
                            _fold_options));
+        parser.add_option(make_shared<command_line_parser::bool_option>
+                          ("auto-fold",
+                           "Choose the vector fold automatically by estimating the cost of each fold "
+                           "that exactly covers the SIMD vector length from the numbers of aligned reads, "
+                           "unaligned reads, and blends needed and the cache lines read in each step "
+                           "along the inner-loop dimension. "
+                           "The ranking of all candidate folds is printed. "
+                           "Any fold requested via -fold is ignored.",
+                           _auto_fold));
     }    
 
 } // namespace yask.
@@ -43,20 +43,33 @@ namespace yask {
         vector<string> _domain_dims; // explicit domain dims.
         string _inner_loop_dim;      // explicit inner-loop dim.
         int _min_buffer_len = 1;     // min length of an inner-loop buffer.
+        int _unroll_jam = 1;         // vectors per iteration in unroll-jam dim (0 => auto).
+        string _unroll_jam_dim;      // explicit unroll-and-jam dim.
+        bool _plane_buffer = false;  // buffer input planes along the march dim.
+        string _plane_buffer_dim;    // explicit march dim for plane buffers.
+        string _semi_stencil;        // regex of parts or vars to use semi-stencil code for.
+        int _vec_math = 0;           // accuracy level of inline SIMD math funcs (0 => none).
         IntTuple _fold_options;    // vector fold.
+        bool _auto_fold = false;   // choose fold by cost model.
         map<int, int> _prefetch_dists;
         bool _first_inner = true; // first dimension of fold is unit step.
         bool _allow_unaligned_loads = false;
         bool _bundle = true;
         bool _bundle_scratch = true;
+        bool _bundle_regs = false; // don't bundle if est. to exceed registers.
         int _halo_size = 0;      // 0 => calculate each halo automatically.
         int _step_alloc = 0;     // 0 => calculate each step allocation automatically.
         bool _inner_misc = true;
         bool _outer_domain = false;
         int _max_expr_size = 50;
         int _min_expr_size = 2;
+        bool _auto_expr_size = true; // split exprs by est. register need.
+        int _num_vec_regs = 0;       // SIMD registers (0 => per target).
+        int _cache_line_bytes = 0;   // bytes in a cache line (0 => per target).
         bool _do_cse = true;      // do common-subexpr elim.
         bool _do_comb = true;    // combine commutative operations.
+        bool _do_factor = false; // factor common multiplicands out of sums.
+        bool _do_hoist = false;  // eval exprs that don't use inner-loop dim before inner loop.
         bool _do_pairs = true;   // find equation pairs.
         bool _do_reorder = false;   // reorder commutative operations.
         string _var_regex;       // vars to update.
@@ -65,6 +78,7 @@ namespace yask {
         bool _use_many_ptrs = false;  // make pointer for almost every point.
         bool _use_offsets = false; // compute offsets from var alloc start.
         bool _early_loads = true; // issue loads early in the inner loop.
+        bool _stream_writes = true; // use streaming stores for vars w/o reuse.
 
         // Add options to a cmd-line parser to set the settings.
         virtual void add_options(command_line_parser& parser);
@@ -81,6 +95,8 @@ namespace yask {
         IntTuple _stencil_dims;   // both step and domain dims.
         IntTuple _misc_dims;      // misc dims that are not the step or domain.
         int _inner_loop_dim_num = 0; // stencil-dim index of inner-loop-dim.
+        int _unroll_jam_dim_num = 0; // stencil-dim index of unroll-jam dim (0 => none).
+        int _plane_buffer_dim_num = 0; // stencil-dim index of plane-buffer march dim (0 => none).
         string _inner_layout_dim;        // inner-most domain dim in mem array layout.
         string _outer_layout_dim;        // outer-most domain dim in mem array layout.
         IntTuple _layout_dims;           // all dims in array-layout order.
@@ -123,10 +123,108 @@ namespace yask {
                              "derived from 'yc_solution_with_radius_base'");
     }
     
+    // Try every fold that exactly covers 'vlen' and estimate the cost of
+    // computing one vector of every eq from the vectors needed with that
+    // fold. Cost = aligned reads + unaligned reads + blends (doubled when
+    // multi-dim folding is not efficient on the target) + 2 * cache lines
+    // of new data read in each step along the inner-loop dim.
+    void Solution::choose_fold(int vlen,
+                               bool is_folding_efficient) {
+        auto& os = get_ostr();
+        if (vlen <= 1)
+            return;
+        if (_settings._fold_options.get_num_dims())
+            os << "Note: ignoring requested fold because auto-fold is enabled.\n";
+
+        // Analysis below updates the settings and prints details,
+        // so save the settings and discard the details.
+        auto saved_settings = _settings;
+        yask_output_factory ofac;
+        auto nop = ofac.new_null_output();
+        auto& nos = nop->get_ostream();
+
+        // Find the domain dims.
+        _settings._fold_options.clear();
+        _dims.set_dims(_vars, _settings, vlen, is_folding_efficient, nos);
+        auto domain_dims = _dims._domain_dims;
+        auto ild = _settings._inner_loop_dim;
+
+        // Make all folds w/product 'vlen'.
+        vector<IntTuple> folds;
+        function<void(int, int, IntTuple)> add_folds =
+            [&](int di, int rem, IntTuple fold) {
+                auto& dname = domain_dims.get_dim_name(di);
+                if (di == domain_dims.get_num_dims() - 1) {
+                    fold.add_dim_back(dname, rem);
+                    folds.push_back(fold);
+                    return;
+                }
+                for (int n = 1; n <= rem; n++) {
+                    if (rem % n == 0) {
+                        auto f2 = fold;
+                        f2.add_dim_back(dname, n);
+                        add_folds(di + 1, rem / n, f2);
+                    }
+                }
+            };
+        add_folds(0, vlen, IntTuple());
+
+        // Evaluate each fold.
+        struct FoldCost {
+            IntTuple fold;
+            size_t naligned, nunaligned, nblends;
+            double nlines, cost;
+        };
+        vector<FoldCost> costs;
+        double blend_wt = is_folding_efficient ? 1.0 : 2.0;
+        double line_wt = 2.0;
+        double lines_per_vec = double(vlen * _settings._elem_bytes) /
+            _settings._cache_line_bytes;
+        for (auto& f : folds) {
+            _settings._fold_options = f;
+            _dims.set_dims(_vars, _settings, vlen, is_folding_efficient, nos);
+            _vars.set_dim_counts();
+            _eqs.analyze_vec();
+            VecInfoVisitor vv(_dims);
+            _eqs.visit_eqs(&vv);
+
+            FoldCost fc;
+            fc.fold = f;
+            fc.naligned = vv.get_num_aligned_vecs();
+            fc.nunaligned = vv.get_num_unaligned_vecs();
+            fc.nblends = vv.get_num_blends();
+            fc.nlines = vv.get_num_rows(ild) * lines_per_vec;
+            fc.cost = fc.naligned + fc.nunaligned + blend_wt * fc.nblends + line_wt * fc.nlines;
+            costs.push_back(fc);
+        }
+        std::stable_sort(costs.begin(), costs.end(),
+                         [](const FoldCost& a, const FoldCost& b) { return a.cost < b.cost; });
+
+        // Print ranking.
+        os << "Automatic vector-fold selection for SIMD length " << vlen << ":\n"
+            " Cost = aligned reads + unaligned reads + " << blend_wt << " * blends + " <<
+            line_wt << " * cache lines read per step in dim '" << ild << "'.\n";
+        for (size_t i = 0; i < costs.size(); i++) {
+            auto& fc = costs[i];
+            os << " #" << (i + 1) << ": " << fc.fold.make_dim_val_str(" * ") << ": " <<
+                fc.naligned << " aligned, " << fc.nunaligned << " unaligned, " <<
+                fc.nblends << " blends, " << fc.nlines << " lines; cost = " << fc.cost << endl;
+        }
+
+        // Use the best one.
+        _settings = saved_settings;
+        _settings._fold_options = costs.front().fold;
+        os << " Selected fold: " << _settings._fold_options.make_dim_val_str(" * ") << endl;
+    }
+
     // Create the intermediate data for printing.
     void Solution::analyze_solution(int vlen,
                                     bool is_folding_efficient) {
 
+        // Pick the fold if requested.
+        if (_settings._auto_fold)
+            choose_fold(vlen, is_folding_efficient);
+
         // Find all the stencil dimensions in the settings and/or vars.
         // Create the final folds.
         _dims.set_dims(_vars, _settings, vlen, is_folding_efficient, *_dos);
@@ -155,6 +253,9 @@ namespace yask {
         _eq_stages->calc_halos();
         _eq_stages->calc_lifespans();
 
+        // Find vars that can use streaming stores.
+        _eq_stages->calc_stream_vars();
+
         // Optimize parts.
         _parts->optimize_parts("scalar & vector");
     }
@@ -262,6 +363,14 @@ namespace yask {
         }
         assert(_printer);
                 
+        // Use the number of SIMD registers on the target unless set.
+        if (_settings._num_vec_regs <= 0)
+            _settings._num_vec_regs = _printer->num_vec_regs();
+
+        // Same for the cache-line size.
+        if (_settings._cache_line_bytes <= 0)
+            _settings._cache_line_bytes = _printer->cache_line_bytes();
+
         // Set data for equation parts, dims, etc.
         int vlen = _printer->num_vec_elems();
         bool is_folding_efficient = _printer->is_folding_efficient();
@@ -80,6 +80,11 @@ namespace yask {
         yask_output_ptr _debug_output;
         ostream* _dos = &std::cout; // just a handy pointer to an ostream.
 
+        // Set the fold option to the candidate fold with the lowest
+        // estimated cost.
+        void choose_fold(int vlen,
+                         bool is_folding_efficient);
+
         // Create the intermediate data.
         void analyze_solution(int vlen,
                               bool is_folding_efficient);
@@ -162,7 +162,9 @@ namespace yask {
         }
 
         // Never fold vars without domain dims, even if there is no vectorization.
-        if (_num_domain_dims == 0)
+        // Also never fold material-index vars because their elements
+        // are not reals.
+        if (_num_domain_dims == 0 || is_material_index())
             _is_foldable = false;
 
         // Otherwise, can fold if ALL vec dims are used in this var.
@@ -175,6 +177,18 @@ namespace yask {
         }
     }
 
+    // Make this a material-index var.
+    void Var::set_material_index_bytes(int nbytes) {
+        if (nbytes != 0 && nbytes != 1 && nbytes != 2)
+            FORMAT_AND_THROW_YASK_EXCEPTION("material-index size of " << nbytes <<
+                                            " bytes requested for var '" << _name <<
+                                            "'; only 1, 2, or 0 (disabled) are allowed");
+        if (nbytes && _is_scratch)
+            FORMAT_AND_THROW_YASK_EXCEPTION("scratch var '" << _name <<
+                                            "' cannot be a material-index var");
+        _material_index_bytes = nbytes;
+    }
+
     // Determine size of the misc space.
     // This is the product of all the observed misc ranges.
     int Var::get_misc_space_size() const {
@@ -57,6 +57,9 @@ namespace yask {
         bool _is_step_alloc_fixed = true; // step alloc cannot be changed at run-time.
         idx_t _step_alloc = 0;         // step-alloc override (0 => calculate).
 
+        // Bytes per int element for a material-index var (0 => FP var).
+        int _material_index_bytes = 0;
+
         // How many dims of various types.
         // -1 => unknown.
         int _num_step_dims = -1;
@@ -325,6 +328,23 @@ namespace yask {
         set_step_alloc_size(idx_t size) {
             _step_alloc = size;
         }
+        virtual int
+        get_material_index_bytes() const {
+            return _material_index_bytes;
+        }
+        virtual void
+        set_material_index_bytes(int nbytes);
+        virtual bool
+        is_material_index() const {
+            return _material_index_bytes > 0;
+        }
+
+        // Max value that can be stored in a material-index var.
+        virtual int
+        get_max_material_index() const {
+            assert(is_material_index());
+            return (1 << (8 * _material_index_bytes)) - 1;
+        }
         virtual yc_var_point_node_ptr
         new_var_point(const std::vector<yc_number_node_ptr>& index_exprs);
         virtual yc_var_point_node_ptr
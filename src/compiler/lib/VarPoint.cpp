@@ -89,6 +89,19 @@ namespace yask {
         }
         return nullptr;
     }
+    var_point_ptr VarPoint::get_lookup_arg(size_t posn) const {
+        assert(posn < _args.size());
+        auto lp = dynamic_pointer_cast<VarPoint>(_args.at(posn));
+        if (lp && lp->_get_var()->is_material_index())
+            return lp;
+        return nullptr;
+    }
+    bool VarPoint::has_lookup_args() const {
+        for (size_t i = 0; i < _args.size(); i++)
+            if (get_lookup_arg(i))
+                return true;
+        return false;
+    }
     const string& VarPoint::get_var_name() const {
         return _var->_get_name();
     }
@@ -344,7 +357,16 @@ namespace yask {
             _lhs->is_same(p->_lhs.get()) &&
             _rhs->is_same(p->_rhs.get()) &&
             are_exprs_same(_cond, p->_cond) && // might be null.
-            are_exprs_same(_step_cond, p->_step_cond); // might be null.
+            are_exprs_same(_step_cond, p->_step_cond) && // might be null.
+            _red_mask == p->_red_mask;
+    }
+    void EqualsExpr::set_reductions(int reduction_mask) {
+        const int all_reds = yc_sum_reduction | yc_sum_squares_reduction |
+            yc_max_reduction | yc_min_reduction;
+        if (reduction_mask & ~all_reds)
+            THROW_YASK_EXCEPTION("unsupported reduction mask " + to_string(reduction_mask) +
+                                 " for equation " + make_quoted_str());
+        _red_mask = reduction_mask;
     }
 
 } // namespace yask.
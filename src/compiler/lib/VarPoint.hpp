@@ -120,6 +120,14 @@ namespace yask {
 
         // Get arg for 'dim' or return null if none.
         virtual const num_expr_ptr get_arg(const string& dim) const;
+
+        // Get arg at 'posn' as a point in a material-index var,
+        // e.g., 'mat(x, y)' in 'vel(mat(x, y))', or return null if
+        // that arg is not such a point.
+        virtual var_point_ptr get_lookup_arg(size_t posn) const;
+
+        // Whether any arg is a point in a material-index var.
+        virtual bool has_lookup_args() const;
         
         // Set given arg to given offset; ignore if not in step or domain var dims.
         virtual void set_arg_offset(const IntScalar& offset);
@@ -223,6 +231,7 @@ namespace yask {
         num_expr_ptr _rhs;
         bool_expr_ptr _cond;
         bool_expr_ptr _step_cond;
+        int _red_mask = 0;      // reductions of values written.
 
     public:
         EqualsExpr(var_point_ptr lhs, num_expr_ptr rhs,
@@ -231,7 +240,8 @@ namespace yask {
             _lhs(lhs), _rhs(rhs), _cond(cond), _step_cond(step_cond) { }
         EqualsExpr(const EqualsExpr& src) :
             _lhs(src._lhs->clone_var_point()),
-            _rhs(src._rhs->clone()) {
+            _rhs(src._rhs->clone()),
+            _red_mask(src._red_mask) {
             if (src._cond)
                 _cond = src._cond->clone();
             else
@@ -297,6 +307,10 @@ namespace yask {
             } else
                 _step_cond = nullptr;
         }
+        virtual void set_reductions(int reduction_mask);
+        virtual int get_reductions() const {
+            return _red_mask;
+        }
     };
 
     typedef set<VarPoint> VarPointSet;
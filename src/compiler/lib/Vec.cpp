@@ -130,6 +130,39 @@ namespace yask {
         return "";
     }                   // end of visit() method.
 
+    // Count vector blocks that need more than one aligned block.
+    size_t VecInfoVisitor::get_num_unaligned_vecs() const {
+        size_t n = 0;
+        for (auto& i : _vblk2avblks)
+            if (i.second.size() > 1)
+                n++;
+        return n;
+    }
+
+    // Count aligned blocks combined into unaligned ones.
+    size_t VecInfoVisitor::get_num_blends() const {
+        size_t n = 0;
+        for (auto& i : _vblk2avblks)
+            if (i.second.size() > 1) // only need to blend if >1 inputs.
+                n += i.second.size();
+        return n;
+    }
+
+    // Count aligned blocks after projecting out 'dname'.
+    // Blocks from vars without 'dname' are reused in every iteration.
+    size_t VecInfoVisitor::get_num_rows(const string& dname) const {
+        VarPointSet rows;
+        for (auto& av : _aligned_vecs) {
+            if (!av.get_arg_offsets().lookup(dname))
+                continue;
+            auto row = av.clone_var_point();
+            IntScalar idi(dname, 0);
+            row->set_arg_offset(idi);
+            rows.insert(*row);
+        }
+        return rows.size();
+    }
+
     // Sort a commutative expression.
     string ExprReorderVisitor::visit(CommutativeExpr* ce) {
 
@@ -213,33 +246,4 @@ namespace yask {
         return "";
     }
 
-    // TODO: fix this old code and make it available as an output.
-    #if 0
-    // Print stats for various folding options.
-    if (vlen_for_stats) {
-        string separator(",");
-        VecInfoVisitor::print_stats_header(cout, separator);
-
-        // Loop through all vars.
-        for (auto gp : vars) {
-
-            // Loop through possible folds of given length.
-            for (int xlen = vlen_for_stats; xlen > 0; xlen--) {
-                for (int ylen = vlen_for_stats / xlen; ylen > 0; ylen--) {
-                    int zlen = vlen_for_stats / xlen / ylen;
-                    if (vlen_for_stats == xlen * ylen * zlen) {
-
-                        // Create vectors needed to implement RHS.
-                        VecInfoVisitor vv(xlen, ylen, zlen);
-                        gp->visit_exprs(&vv);
-
-                        // Print stats.
-                        vv.print_stats(cout, gp->_get_name(), separator);
-                    }
-                }
-            }
-        }
-    }
-    #endif
-
 } // namespace yask.
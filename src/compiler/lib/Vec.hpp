@@ -110,6 +110,19 @@ namespace yask {
             return _aligned_vecs.size();
         }
 
+        // Number of vector blocks read that must be constructed from
+        // more than one aligned block.
+        virtual size_t get_num_unaligned_vecs() const;
+
+        // Number of aligned blocks combined to construct the unaligned
+        // ones, i.e., an estimate of the permutes or blends needed.
+        virtual size_t get_num_blends() const;
+
+        // Number of distinct rows of aligned blocks along dim 'dname'.
+        // When looping along 'dname', this is the number of new aligned
+        // blocks read from memory in each iteration.
+        virtual size_t get_num_rows(const string& dname) const;
+
         // Make an index and offset canonical, i.e.,
         // find index_out and offset_out such that
         // (index_out * vec_len) + offset_out == (index_in * vec_len) + offset_in
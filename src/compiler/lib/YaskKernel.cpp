@@ -113,6 +113,10 @@ namespace yask {
         os << "\n// Target:\n"
             "#define YASK_TARGET \"" << _settings._target << "\"\n"
             "#define REAL_BYTES " << _settings._elem_bytes << endl;
+        if (_settings._vec_math < 0 || _settings._vec_math > 2)
+            THROW_YASK_EXCEPTION("vec-math level must be 0, 1, or 2");
+        if (_settings._vec_math > 0)
+            os << "#define YASK_VEC_MATH " << _settings._vec_math << endl;
 
         auto nsdims = _dims._stencil_dims.size();
         os << "\n// Dimensions:\n"
@@ -272,6 +276,9 @@ namespace yask {
                 os << "updated by one or more equations.\n";
             else
                 os << "not updated by any equation (read-only).\n";
+            if (gp->is_material_index())
+                os << " // Each element is a " << (8 * gp->get_material_index_bytes()) <<
+                    "-bit unsigned material index.\n";
             if (ndims) {
                 os << " // Dimensions in parameter (declaration) order: ";
                 for (int dn = 0; dn < ndims; dn++) {
@@ -372,6 +379,11 @@ namespace yask {
                     }
                 }
 
+                // Element type of material-index var.
+                if (gp->is_material_index())
+                    templ += gp->get_material_index_bytes() == 1 ?
+                        ", uint8_t" : ", uint16_t";
+
                 templ.insert(0, "<Layout_");
                 templ += ">";
 
@@ -454,6 +466,9 @@ namespace yask {
                 CounterVisitor stats;
                 eq->visit_eqs(&stats);
 
+                // Reductions of values written by this part.
+                auto reds = eq->get_reductions();
+
                 os << endl << " ////// Stencil " << eg_desc << " //////\n" <<
                 "\n struct " << egs_name << " {\n"
                     "  const char* _name = \"" << eg_name << "\";\n\n"
@@ -461,7 +476,9 @@ namespace yask {
                     "  const int _scalar_fp_ops = " << stats.get_num_ops() << ";\n"
                     "  const int _scalar_points_read = " << stats.get_num_reads() << ";\n"
                     "  const int _scalar_points_written = " << stats.get_num_writes() << ";\n"
-                    "  const bool _is_scratch = " << (eq->is_scratch() ? "true" : "false") << ";\n";
+                    "  const bool _is_scratch = " << (eq->is_scratch() ? "true" : "false") << ";\n"
+                    "\n  // Number of vars with reductions of values written by this part.\n"
+                    "  static constexpr int _num_reductions = " << reds.size() << ";\n";
 
                 // Example computation.
                 os << endl << " // " << stats.get_num_ops() << " FP operation(s) per point:\n";
@@ -566,8 +583,11 @@ namespace yask {
                         _dims._stencil_dims.make_dim_str() << ".\n"
                         " // There are approximately " << stats.get_num_ops() <<
                         " FP operation(s) per invocation.\n"
+                        " // If 'do_reduce', reductions are accumulated in 'red_vals'.\n"
+                        " template <bool do_reduce = false>\n"
                         " static void calc_scalar(" <<
-                        _core_t << "* core_data, int core_idx, const Indices& idxs) {\n"
+                        _core_t << "* core_data, int core_idx, const Indices& idxs,"
+                        " double* red_vals = nullptr) {\n"
                         " host_assert(core_data);\n"
                         " host_assert(core_data->_thread_core_list.get());\n"
                         " auto& thread_core_data = core_data->_thread_core_list[core_idx];\n";
@@ -577,6 +597,7 @@ namespace yask {
                     CounterVisitor cv;
                     eq->visit_eqs(&cv);
                     CppPrintHelper* sp = new CppPrintHelper(_settings, _dims, &cv, "real_t", " ", ";\n");
+                    sp->set_reductions(reds);
 
                     // Generate the code.
                     PrintVisitorBottomUp pcv(os, *sp);
@@ -590,16 +611,104 @@ namespace yask {
 
                 // Vector code.
                 {
+                    // Unroll-and-jam: find the number of vectors to compute
+                    // in each iteration in the unroll-jam dim and a part
+                    // containing the eqs for all of them.
+                    // Plane buffers: find whether any input vars in this
+                    // part can be buffered along the march dim. If so,
+                    // unroll-and-jam is not used.
+                    // Semi-stencil: find sums whose terms at negative
+                    // inner-loop offsets can be carried in partial sums
+                    // across iterations. If any are found, the vector code
+                    // is generated from a modified copy of the part, and
+                    // plane buffers and unroll-and-jam are not used.
+                    PartPtr veq = eq;
+                    vector<SemiSum> semi_sums;
+                    if (_settings._semi_stencil.length()) {
+                        regex re(_settings._semi_stencil);
+                        bool match = regex_search(eq->_get_name(), re);
+                        for (auto& ee : eq->get_eqs())
+                            if (regex_search(ee->_get_lhs()->_get_var()->_get_name(), re))
+                                match = true;
+                        if (match) {
+                            auto sp = eq->clone();
+                            VecInfoVisitor svv(_dims);
+                            sp->visit_eqs(&svv);
+                            CounterVisitor scv;
+                            auto* vp = new_cpp_vec_print_helper(svv, scv);
+                            if (vp->find_semi_sums(*sp)) {
+                                semi_sums = vp->get_semi_sums();
+                                if (_settings._do_cse) {
+                                    CseVisitor cse;
+                                    sp->visit_eqs(&cse);
+                                }
+                                if (_settings._do_pairs) {
+                                    PairingVisitor pv;
+                                    sp->visit_eqs(&pv);
+                                }
+                                veq = sp;
+                            }
+                            delete vp;
+                        }
+                    }
+
+                    bool use_pbuf = false;
+                    if (_dims._plane_buffer_dim_num > 0 && semi_sums.empty()) {
+                        VecInfoVisitor pvv(_dims);
+                        eq->visit_eqs(&pvv);
+                        CounterVisitor pcv;
+                        auto* vp = new_cpp_vec_print_helper(pvv, pcv);
+                        use_pbuf = vp->find_plane_buffers(_settings._plane_buffer_dim);
+                        delete vp;
+                    }
+
+                    int ujam = 1;
+                    PartPtr ujam_eq;
+                    int ujdn = (use_pbuf || semi_sums.size()) ? 0 : _dims._unroll_jam_dim_num;
+                    if (ujdn > 0) {
+                        auto& ujd = _settings._unroll_jam_dim;
+                        int ujfold = *_dims._fold.lookup(ujd);
+                        int max_ujam = (_settings._unroll_jam > 1) ? _settings._unroll_jam : 8;
+                        vector<PartPtr> ujam_eqs;
+                        vector<int> nreads;
+                        for (int u = 1; u <= max_ujam; u++) {
+                            PartPtr up = (u == 1) ? eq->clone() : ujam_eqs.back()->clone();
+                            if (u > 1) {
+                                auto sp = eq->clone_shifted(ujd, (u - 1) * ujfold);
+                                if (!sp)
+                                    break;
+                                for (auto& ee : sp->get_eqs())
+                                    up->add_eq(ee);
+                            }
+                            VecInfoVisitor uvv(_dims);
+                            up->visit_eqs(&uvv);
+                            ujam_eqs.push_back(up);
+                            nreads.push_back(uvv.get_num_aligned_vecs());
+                        }
+                        if (_settings._unroll_jam > 1)
+                            ujam = (int(ujam_eqs.size()) == max_ujam) ? max_ujam : 1;
+                        else {
+                            VecInfoVisitor vv(_dims);
+                            eq->visit_eqs(&vv);
+                            CounterVisitor cv;
+                            auto* vp = new_cpp_vec_print_helper(vv, cv);
+                            ujam = vp->choose_unroll_factor(nreads, eq->get_num_eqs());
+                            delete vp;
+                        }
+                        if (ujam > 1)
+                            ujam_eq = ujam_eqs.at(ujam - 1);
+                    }
+                    
                     // Create vector info for this part.  The visitor is
                     // accepted at all nodes in the AST; for each var access
                     // node in the AST, the vectors needed are determined
                     // and saved in the visitor.
                     VecInfoVisitor vv(_dims);
-                    eq->visit_eqs(&vv);
+                    veq->visit_eqs(&vv);
 
                     // Collect stats.
                     CounterVisitor cv;
-                    eq->visit_eqs(&cv);
+                    veq->visit_eqs(&cv);
 
                     // Loop-calculation code.
                     // Function header.
@@ -612,11 +721,23 @@ namespace yask {
                         " vector block(s) read from " << vv.get_num_aligned_vecs() <<
                         " aligned vector-block(s).\n"
                         " // There are approximately " << (stats.get_num_ops() * _dims._fold.product()) <<
-                        " FP operation(s) per inner-loop iteration.\n" <<
+                        " FP operation(s) per inner-loop iteration.\n";
+                    if (ujam > 1)
+                        os << " // Each inner-loop iteration calculates " << ujam <<
+                            " consecutive vectors in dim '" << _settings._unroll_jam_dim <<
+                            "' where possible.\n";
+                    if (use_pbuf)
+                        os << " // Marches through dim '" << _settings._plane_buffer_dim <<
+                            "' one vector-plane at a time using thread-private plane buffers.\n";
+                    if (semi_sums.size())
+                        os << " // Carries " << semi_sums.size() << " partial sum(s) across iterations in dim '" <<
+                            _settings._inner_loop_dim << "' (semi-stencil).\n";
+                    os << " // If 'do_reduce', reductions are accumulated in 'red_vals'.\n"
+                        " template <bool do_reduce = false>\n"
                         " static void calc_vectors(" <<
                         _core_t << "* core_data, int core_idx, int block_thread_idx,"
-                        " int thread_limit, ScanIndices& norm_nb_idxs, bit_mask_t write_mask"
-                        ") {\n";
+                        " int thread_limit, ScanIndices& norm_nb_idxs, bit_mask_t write_mask,"
+                        " double* red_vals = nullptr) {\n";
 
                     // Early out.
                     os << " if (write_mask == 0) return;\n";
@@ -628,94 +749,184 @@ namespace yask {
                         " auto& thread_core_data = core_data->_thread_core_list[core_idx];\n"
                         " const Indices& idxs = norm_nb_idxs.start;\n";
                     print_indices(os, true, false); // Just step index.
+
+                    // Print the loops over one section of the nano-block.
+                    // If 'nu' > 1, compute 'nu' vectors in the unroll-jam
+                    // dim in each iteration from the first part of the
+                    // range. If 'is_rem', compute the remainder.
+                    auto print_loops =
+                        [&](Part& leq, VecInfoVisitor& lvv, CounterVisitor& lcv,
+                            int nu, bool is_rem) {
  
-                    // C++ vector print assistant.
-                    auto* vp = new_cpp_vec_print_helper(vv, cv);
-                    if (_dims._fold.product() > 1)
-                        vp->set_write_mask("write_mask"); // Only need mask for actual vectors.
-                    vp->set_stage_name(stage_name);
-                    vp->get_point_stats();
-
-                    // Print loop-invariant meta values.
-                    // Store them in the CppVecPrintHelper for later use in the loop body.
-                    os << "\n ////// Loop-invariant values.\n";
-                    CppPreLoopPrintMetaVisitor plpmv(os, *vp);
-                    eq->visit_eqs(&plpmv);
-                    vp->print_rank_data(os);
-
-                    // Print loop-invariant data values.
-                    // Store them in the CppVecPrintHelper for later use in the loop body.
-                    CppPreLoopPrintDataVisitor plpdv(os, *vp);
-                    eq->visit_eqs(&plpdv);
+                        // C++ vector print assistant.
+                        auto* vp = new_cpp_vec_print_helper(lvv, lcv);
+                        if (_dims._fold.product() > 1)
+                            vp->set_write_mask("write_mask"); // Only need mask for actual vectors.
+                        vp->set_stage_name(stage_name);
+                        vp->set_stream_vars(bp->_stream_vars);
+                        vp->set_reductions(reds);
+                        vp->get_point_stats();
+                        vp->set_semi_sums(semi_sums);
+                        if (use_pbuf)
+                            vp->find_plane_buffers(_settings._plane_buffer_dim);
+
+                        // Print loop-invariant meta values.
+                        // Store them in the CppVecPrintHelper for later use in the loop body.
+                        os << "\n ////// Loop-invariant values.\n";
+                        CppPreLoopPrintMetaVisitor plpmv(os, *vp);
+                        leq.visit_eqs(&plpmv);
+                        vp->print_rank_data(os);
+
+                        // Print loop-invariant data values.
+                        // Store them in the CppVecPrintHelper for later use in the loop body.
+                        CppPreLoopPrintDataVisitor plpdv(os, *vp);
+                        leq.visit_eqs(&plpdv);
+                        vp->print_reduction_prefix(os);
+                        if (use_pbuf)
+                            vp->print_plane_buffer_storage(os);
                 
-                    // Computation loops.
-                    // Include generated loops.
-                    os <<
-                        "\n // Nano loops.\n"
-                        "#define NANO_BLOCK_LOOP_INDICES norm_nb_idxs\n"
-                        "\n // Start Nano loop(s).\n"
-                        "#define NANO_BLOCK_USE_LOOP_PART_0\n"
-                        "#include \"yask_nano_block_loops.hpp\"\n";
-                    os <<
-                        "\n // Pico loops inside nano loops.\n"
-                        " // Use macros to get values directly from nano loops.\n"
-                        "#define PICO_BLOCK_BEGIN(dn) NANO_BLOCK_BODY_START(dn)\n"
-                        "#define PICO_BLOCK_END(dn) NANO_BLOCK_BODY_STOP(dn)\n"
-                        "#define PICO_BLOCK_STRIDE(dn) idx_t(1)\n";
-                    os <<
-                        "\n // Start Pico outer-loop(s).\n"
-                        "#define PICO_BLOCK_USE_LOOP_PART_0\n"
-                        "#include \"yask_pico_block_loops.hpp\"\n";
-
-                    // Get named domain indices directly from scalar vars.
-                    print_indices(os, false, true, "pico_block_start_", "pico_block_begin_");
-                    vp->print_elem_indices(os);
-
-                    // Create inner-loop base ptrs.
-                    os << "\n // Set up for inner loop.\n";
-                    vp->print_inner_loop_prefix(os);
+                        // Computation loops.
+                        // Include generated loops.
+                        os <<
+                            "\n // Nano loops.\n"
+                            "#define NANO_BLOCK_LOOP_INDICES norm_nb_idxs\n"
+                            "\n // Start Nano loop(s).\n"
+                            "#define NANO_BLOCK_USE_LOOP_PART_0\n"
+                            "#include \"yask_nano_block_loops.hpp\"\n";
+                        os <<
+                            "\n // Pico loops inside nano loops.\n"
+                            " // Use macros to get values directly from nano loops.\n";
+                        if (use_pbuf)
+                            vp->print_plane_buffer_march(os);
+                        else if (ujam > 1) {
+                            os << " // Range in dim '" << _settings._unroll_jam_dim <<
+                                "' computed " << ujam << " vectors at a time.\n"
+                                " const idx_t ujam_begin = NANO_BLOCK_BODY_START(" << ujdn << ");\n"
+                                " const idx_t ujam_mid = ujam_begin + yask::round_down_flr(NANO_BLOCK_BODY_STOP(" <<
+                                ujdn << ") - ujam_begin, idx_t(" << ujam << "));\n";
+                            if (is_rem)
+                                os << "#define PICO_BLOCK_BEGIN(dn) ((dn) == " << ujdn <<
+                                    " ? ujam_mid : NANO_BLOCK_BODY_START(dn))\n"
+                                    "#define PICO_BLOCK_END(dn) NANO_BLOCK_BODY_STOP(dn)\n"
+                                    "#define PICO_BLOCK_STRIDE(dn) idx_t(1)\n";
+                            else
+                                os << "#define PICO_BLOCK_BEGIN(dn) NANO_BLOCK_BODY_START(dn)\n"
+                                    "#define PICO_BLOCK_END(dn) ((dn) == " << ujdn <<
+                                    " ? ujam_mid : NANO_BLOCK_BODY_STOP(dn))\n"
+                                    "#define PICO_BLOCK_STRIDE(dn) idx_t((dn) == " << ujdn <<
+                                    " ? " << nu << " : 1)\n";
+                        }
+                        else
+                            os << "#define PICO_BLOCK_BEGIN(dn) NANO_BLOCK_BODY_START(dn)\n"
+                                "#define PICO_BLOCK_END(dn) NANO_BLOCK_BODY_STOP(dn)\n"
+                                "#define PICO_BLOCK_STRIDE(dn) idx_t(1)\n";
+                        os <<
+                            "\n // Start Pico outer-loop(s).\n"
+                            "#define PICO_BLOCK_USE_LOOP_PART_0\n"
+                            "#include \"yask_pico_block_loops.hpp\"\n";
+
+                        // Get named domain indices directly from scalar vars.
+                        print_indices(os, false, true, "pico_block_start_", "pico_block_begin_");
+                        vp->print_elem_indices(os);
+
+                        // Create inner-loop base ptrs.
+                        os << "\n // Set up for inner loop.\n";
+                        vp->print_inner_loop_prefix(os);
     
-                    // Initial prefetches, if any.
-                    vp->print_prefetches(os, false);
+                        // Initial prefetches, if any.
+                        vp->print_prefetches(os, false);
 
-                    // Create and init buffers, if any.
-                    vp->print_buffer_code(os, false);
+                        // Create and init buffers, if any.
+                        vp->print_buffer_code(os, false);
 
-                    auto& ild = _settings._inner_loop_dim;
-                    os <<
-                        "\n // Start Pico inner-loop for dim '" << ild << "'.\n"
-                        "#define PICO_BLOCK_USE_LOOP_PART_1\n"
-                        "#include \"yask_pico_block_loops.hpp\"\n";
-
-                    // Issue loads early.
-                    if (_settings._early_loads)
-                        vp->print_early_loads(os);
-                
-                    // Generate loop body using vars stored in print helper.
-                    // Visit all expressions to cover the whole vector.
-                    PrintVisitorBottomUp pcv(os, *vp);
-                    eq->visit_eqs(&pcv);
+                        // Evaluate values that don't depend on the inner-loop dim.
+                        if (_settings._do_hoist) {
+                            CppPreInnerLoopPrintVisitor pilpv(os, *vp);
+                            leq.visit_eqs(&pilpv);
+                        }
 
-                    // Insert prefetches using vars stored in print helper for next iteration.
-                    vp->print_prefetches(os, true);
+                        // Init partial sums, if any.
+                        vp->print_semi_sum_code(os, false);
+
+                        auto& ild = _settings._inner_loop_dim;
+                        os <<
+                            "\n // Start Pico inner-loop for dim '" << ild << "'.\n"
+                            "#define PICO_BLOCK_USE_LOOP_PART_1\n"
+                            "#include \"yask_pico_block_loops.hpp\"\n";
+
+                        // Estimate registers needed by the neediest
+                        // equation. If it and the early loads won't fit,
+                        // issue fewer loads early.
+                        int nregs = _settings._auto_expr_size ? vp->get_num_vec_regs() : 0;
+                        int max_loads = -1;
+                        if (nregs > 0) {
+                            RegNeedVisitor rnv;
+                            leq.visit_eqs(&rnv);
+                            int need = rnv.get_max_need();
+                            os << "\n // Est. SIMD registers needed by neediest equation: " <<
+                                need << " of " << nregs << ".\n";
+                            max_loads = std::max(nregs - need, nregs / 2);
+                        }
 
-                    // Shift and fill buffers.
-                    vp->print_buffer_code(os, true);
+                        // Issue loads early.
+                        int nloads = 0;
+                        if (_settings._early_loads)
+                            nloads = vp->print_early_loads(os, max_loads);
                 
-                    // Increment indices, etc.
-                    vp->print_end_inner_loop(os);
-
-                    // End of loops.
-                    os <<
-                        "\n ////// Loop endings.\n"
-                        "#define PICO_BLOCK_USE_LOOP_PART_2\n"
-                        "#include \"yask_pico_block_loops.hpp\"\n"
-                        "#define NANO_BLOCK_USE_LOOP_PART_1\n"
-                        "#include \"yask_nano_block_loops.hpp\"\n";
+                        // Generate loop body using vars stored in print helper.
+                        // Visit all expressions to cover the whole vector.
+                        // Split any expression that won't fit in the
+                        // registers not holding early loads.
+                        PrintVisitorBottomUp pcv(os, *vp);
+                        if (nregs > 0)
+                            pcv.set_max_regs(std::max(nregs - nloads, 2));
+                        leq.visit_eqs(&pcv);
+
+                        // Insert prefetches using vars stored in print helper for next iteration.
+                        vp->print_prefetches(os, true);
+
+                        // Update partial sums, if any.
+                        vp->print_semi_sum_code(os, true);
+
+                        // Shift and fill buffers.
+                        vp->print_buffer_code(os, true);
+                
+                        // Increment indices, etc.
+                        vp->print_end_inner_loop(os);
+
+                        // End of loops.
+                        os <<
+                            "\n ////// Loop endings.\n"
+                            "#define PICO_BLOCK_USE_LOOP_PART_2\n"
+                            "#include \"yask_pico_block_loops.hpp\"\n";
+                        if (use_pbuf)
+                            os << " } // Loop over planes.\n";
+                        os <<
+                            "#define NANO_BLOCK_USE_LOOP_PART_1\n"
+                            "#include \"yask_nano_block_loops.hpp\"\n";
+                        vp->print_reduction_suffix(os);
+                        delete vp;
+                    };
+
+                    if (ujam > 1) {
+                        VecInfoVisitor uvv(_dims);
+                        ujam_eq->visit_eqs(&uvv);
+                        CounterVisitor ucv;
+                        ujam_eq->visit_eqs(&ucv);
+                        os << "\n ////// Vectors computed " << ujam << " at a time in dim '" <<
+                            _settings._unroll_jam_dim << "'.\n {\n";
+                        print_loops(*ujam_eq, uvv, ucv, ujam, false);
+                        os << " }\n"
+                            "\n ////// Remaining vectors in dim '" <<
+                            _settings._unroll_jam_dim << "'.\n {\n";
+                        print_loops(*eq, vv, cv, 1, true);
+                        os << " }\n";
+                    }
+                    else
+                        print_loops(*veq, vv, cv, 1, false);
 
                     // End of recursive block & calc function.
                     os << "} } // calc_vectors\n";
-                    delete vp;
                 } // calc_vector
 
                 os << "}; // " << egs_name << ".\n" // end of struct.
@@ -1005,6 +1216,15 @@ namespace yask {
                     else
                         os << "  " << p_name << ".output_var_ptrs.push_back(" << var_ptr << ");\n";
                 }
+
+                // Reductions of values written.
+                auto reds = p->get_reductions();
+                if (reds.size()) {
+                    os << "\n // Reductions of values written by '" << p_name << "'.\n";
+                    for (auto& r : reds)
+                        os << "  " << p_name << ".add_reduction(\"" << r.first <<
+                            "\", " << r.second << ");\n";
+                }
             } // parts.
 
             // Stages.
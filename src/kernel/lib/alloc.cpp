@@ -104,6 +104,8 @@ namespace yask {
             numa_set_bind_policy(0);
             if (numa_pref >= 0 && numa_pref <= numa_max_node())
                 p = numa_alloc_onnode(nbytes, numa_pref);
+            else if (numa_pref == yask_numa_slabs)
+                p = ::numa_alloc(nbytes); // Bound later via numa_bind().
             else
                 p = numa_alloc_local(nbytes);
             // Interleaved not available.
@@ -140,6 +142,11 @@ namespace yask {
                     unsigned long nodemask = (unsigned long)-1;
                     mbind(p, nbytes, MPOL_INTERLEAVE, &nodemask, sizeof(nodemask) * 8, 0);
                 }
+                else if (numa_pref == yask_numa_slabs) {
+
+                    // Slabs will be bound via numa_bind() after
+                    // storage is assigned to vars.
+                }
 
                 else{
 
@@ -178,6 +185,37 @@ namespace yask {
         #endif // USE_NUMA.
     }
 
+    // Get the NUMA node of the CPU running the calling thread.
+    // Returns 0 if it cannot be determined.
+    int get_cur_numa_node() {
+        #ifdef USE_NUMA
+        unsigned cpu = 0, node = 0;
+        if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0)
+            return int(node);
+        #endif
+        return 0;
+    }
+
+    // Bind the pages containing [p, p + nbytes) to 'numa_node'.
+    // Range is expanded to page boundaries, so the first and last pages
+    // may be shared with neighboring data.
+    void numa_bind(char* p, std::size_t nbytes, int numa_node) {
+        #ifdef USE_NUMA
+        if (!p || !nbytes || numa_node < 0)
+            return;
+        size_t pg_bytes = sysconf(_SC_PAGESIZE);
+        size_t begin = ROUND_DOWN(size_t(p), pg_bytes);
+        size_t end = ROUND_UP(size_t(p) + nbytes, pg_bytes);
+
+        #ifdef USE_NUMA_POLICY_LIB
+        numa_tonode_memory((void*)begin, end - begin, numa_node);
+        #else
+        unsigned long nodemask = 0x1UL << numa_node;
+        mbind((void*)begin, end - begin, MPOL_PREFERRED, &nodemask, sizeof(nodemask) * 8, 0);
+        #endif
+        #endif
+    }
+
     // Reverse numa_alloc().
     void NumaDeleter::operator()(char* p) {
         free_dev_mem(p);
@@ -211,8 +249,11 @@ namespace yask {
     }
 
     // MPI shm allocation.
+    // If 'node_shared', only the first rank in 'shm_comm' allocates
+    // 'nbytes', and all ranks get a pointer to that memory.
     char* shm_alloc(std::size_t nbytes,
-                    const MPI_Comm* shm_comm, MPI_Win* shm_win) {
+                    const MPI_Comm* shm_comm, MPI_Win* shm_win,
+                    bool node_shared) {
 
         void *p = 0;
 
@@ -227,7 +268,22 @@ namespace yask {
         MPI_Info win_info;
         MPI_Info_create(&win_info);
         MPI_Info_set(win_info, "alloc_shared_noncontig", "true");
-        MPI_Win_allocate_shared(nbytes, 1, win_info, *shm_comm, &p, shm_win);
+        int shm_rank = 0;
+        MPI_Comm_rank(*shm_comm, &shm_rank);
+        size_t my_nbytes = nbytes;
+
+        // A node-shared segment is not necessarily aligned, so
+        // alloc an extra cache-line and align the pointer below.
+        if (node_shared)
+            my_nbytes = (shm_rank > 0) ? 0 : nbytes + CACHELINE_BYTES;
+        MPI_Win_allocate_shared(my_nbytes, 1, win_info, *shm_comm, &p, shm_win);
+        if (node_shared) {
+            MPI_Aint sz;
+            int dispunit;
+            MPI_Win_shared_query(*shm_win, 0, &sz, &dispunit, &p);
+            if (p)
+                p = (void*)ROUND_UP(size_t(p), CACHELINE_BYTES);
+        }
         if (!p)
             THROW_YASK_EXCEPTION("cannot allocate " + make_byte_str(nbytes) +
                                  " using MPI shm");
@@ -263,11 +319,62 @@ namespace yask {
         #endif
     }
 
+    // Memory map backed by a new file.
+    // A unique suffix is added to 'fname_prefix' by mkstemp(), so jobs
+    // sharing a directory never open each other's files.
+    char* mmap_file_alloc(std::size_t nbytes, const std::string& fname_prefix) {
+        std::string tstr = fname_prefix + ".XXXXXX";
+        std::vector<char> tmpl(tstr.c_str(), tstr.c_str() + tstr.size() + 1);
+        int fd = mkstemp(tmpl.data());
+        std::string fname(tmpl.data());
+        if (fd < 0)
+            THROW_YASK_EXCEPTION("cannot create file '" + fname +
+                                 "' for memory map: " + strerror(errno));
+
+        // Size the file before mapping it. The file is removed right
+        // away; its space remains until the map is released.
+        int ret = ftruncate(fd, nbytes);
+        void* p = (ret == 0) ?
+            mmap(0, nbytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) :
+            MAP_FAILED;
+        int err = errno;
+        close(fd);
+        unlink(fname.c_str());
+        if (p == MAP_FAILED)
+            THROW_YASK_EXCEPTION("cannot map " + make_byte_str(nbytes) +
+                                 " in file '" + fname + "': " + strerror(err));
+
+        // Pages will be computed in slabs, not in file order.
+        madvise(p, nbytes, MADV_RANDOM);
+
+        // Return as a char* as required for shared_ptr ctor.
+        return static_cast<char*>(p);
+    }
+
+    // Reverse mmap_file_alloc().
+    void MmapDeleter::operator()(char* p) {
+        free_dev_mem(p);
+        if (p)
+            munmap(p, _nbytes);
+    }
+
+    // Start reading the pages containing [p, p + nbytes) from the file.
+    void mmap_prefetch(char* p, std::size_t nbytes) {
+        if (!p || !nbytes)
+            return;
+        size_t pg_bytes = sysconf(_SC_PAGESIZE);
+        size_t begin = ROUND_DOWN(size_t(p), pg_bytes);
+        size_t end = ROUND_UP(size_t(p) + nbytes, pg_bytes);
+        madvise((void*)begin, end - begin, MADV_WILLNEED);
+    }
+
     ///// Memory-alloc functions in StencilContext /////
     
     // Magic numbers for memory types in addition to those for NUMA.
     // TODO: get rid of magic-number scheme.
     constexpr int _shmem_key = 1000;
+    constexpr int _node_shmem_key = 1001;
+    constexpr int _mmap_key = 1002;
 
     // Alloc mem for each requested key.
     // 'type' is only used for debug msg.
@@ -291,7 +398,18 @@ namespace yask {
             string msg = "Allocating " + make_byte_str(data.nbytes) +
                 " for " + to_string(data.nvars) + " " + type + "(s) ";
 
-            if (mem_key == _shmem_key) {
+            if (mem_key == _mmap_key) {
+                msg += "in memory-mapped file '" + data.fname + "'";
+                DEBUG_MSG(msg << "...");
+                p = shared_mmap_alloc<char>(data.nbytes, data.fname);
+            }
+            else if (mem_key == _node_shmem_key) {
+                msg += "shared by all ranks on this node using MPI shm";
+                DEBUG_MSG(msg << "...");
+                p = shared_shm_alloc<char>(data.nbytes, &env->shm_comm,
+                                           &mpi_info->node_var_win, true);
+            }
+            else if (mem_key == _shmem_key) {
                 msg += "using MPI shm";
                 DEBUG_MSG(msg << "...");
                 p = shared_shm_alloc<char>(data.nbytes, &env->shm_comm, &mpi_info->halo_win);
@@ -325,6 +443,8 @@ namespace yask {
                     msg += "preferring local NUMA node";
                 else if (mem_key == yask_numa_interleave)
                     msg += "interleaved across all NUMA nodes";
+                else if (mem_key == yask_numa_slabs)
+                    msg += "in slabs on NUMA nodes of outer threads";
                 else if (mem_key >= 0)
                     msg += "preferring NUMA node " + to_string(mem_key);
                 else
@@ -339,6 +459,345 @@ namespace yask {
         }
     }
 
+    // Find the NUMA node of each outer thread.
+    void StencilContext::_find_outer_thread_numa_nodes() {
+        STATE_VARS(this);
+        if (_outer_thread_numa_nodes.size())
+            return;
+
+        int rthreads, bthreads;
+        get_num_comp_threads(rthreads, bthreads);
+        _outer_thread_numa_nodes.assign(rthreads, 0);
+
+        #pragma omp parallel num_threads(rthreads)
+        {
+            int n = omp_get_thread_num();
+            _outer_thread_numa_nodes.at(n) = get_cur_numa_node();
+        }
+
+        for (int n = 0; n < rthreads; n++)
+            TRACE_MSG("outer thread " << n << " is on NUMA node " <<
+                      _outer_thread_numa_nodes[n]);
+    }
+
+    // Get the outer thread that computes rank-relative index 'x' in the
+    // first domain dim when blocks are statically assigned to 'nthr'
+    // threads.  The blocks in each mega-block are divided evenly across
+    // threads in order, so the owner of a block-slab is the owner of its
+    // midpoint.
+    int StencilContext::_get_outer_thread_of_index(idx_t x, int nthr) const {
+        STATE_VARS_CONST(this);
+        auto& odim = domain_dims.get_dim_name(0);
+        idx_t rsz = actl_opts->_rank_sizes[odim];
+        idx_t mbsz = max(actl_opts->_mega_block_sizes[odim], idx_t(1));
+        idx_t bsz = max(actl_opts->_block_sizes[odim], idx_t(1));
+
+        x = max(idx_t(0), min(x, rsz - 1));
+        idx_t mb_begin = ROUND_DOWN(x, mbsz);
+        idx_t nblks = CEIL_DIV(min(mbsz, rsz - mb_begin), bsz);
+        idx_t blk = (x - mb_begin) / bsz;
+        return int(((2 * blk + 1) * nthr) / (2 * nblks));
+    }
+
+    // Find the layout of the storage of 'gp' in slabs along the first
+    // domain dim.  Returns 'false' if the var has no storage or the first
+    // domain dim is not the outermost domain dim in its layout.
+    bool StencilContext::_get_var_slab_layout(YkVarPtr gp, VarSlabLayout& sl) const {
+        STATE_VARS_CONST(this);
+        auto& gb = gp->gb();
+        sl.base = static_cast<char*>(gb.get_storage());
+        if (!sl.base)
+            return false;
+        auto* cp = gb.get_corep();
+        auto& strides = cp->_vec_strides;
+        auto& vallocs = cp->_vec_allocs;
+        int nvdims = gb.get_num_dims();
+
+        // Find domain dim with largest stride.
+        int dposn = -1;
+        for (int i = 0; i < nvdims; i++)
+            if (domain_dims.lookup(gb.get_dim_name(i)) &&
+                (dposn < 0 || strides[i] > strides[dposn]))
+                dposn = i;
+
+        // Blocks and mega-blocks are divided into slabs along the first
+        // domain dim only, because it is the outermost dim in their loops.
+        auto& odim = domain_dims.get_dim_name(0);
+        if (dposn < 0 || gb.get_dim_name(dposn) != odim)
+            return false;
+
+        // Size of one element in the layout (real or vector).
+        sl.elem_bytes = gb.get_num_bytes() / vallocs.product();
+        sl.stride = strides[dposn];
+        sl.vlen = cp->_var_vec_lens[dposn];
+        sl.first_idx = cp->get_first_local_index(dposn) -
+            rank_domain_offsets[domain_dims.lookup_posn(odim)];
+        sl.nslabs = vallocs[dposn];
+
+        // Outer slices, i.e., combinations of indices in dims
+        // with strides larger than the slab dim, e.g., the step dim.
+        idx_t nouter = 1;
+        for (int i = 0; i < nvdims; i++)
+            if (strides[i] > sl.stride)
+                nouter *= vallocs[i];
+        sl.outer_ofs.clear();
+        for (idx_t oi = 0; oi < nouter; oi++) {
+            idx_t ofs = 0, rem = oi;
+            for (int i = 0; i < nvdims; i++) {
+                if (strides[i] > sl.stride) {
+                    ofs += (rem % vallocs[i]) * strides[i];
+                    rem /= vallocs[i];
+                }
+            }
+            sl.outer_ofs.push_back(ofs);
+        }
+        return true;
+    }
+
+    // Divide the storage of 'gp' into slabs along the outermost domain
+    // dim in the var's layout and call 'visitor' with the address, size,
+    // and owning outer thread of each one.  Since only the var's own range
+    // is visited, this works whether or not several vars share one
+    // allocation.  Returns 'false' without visiting anything if the first
+    // domain dim is not the outermost domain dim in the layout.
+    bool StencilContext::_visit_var_slabs(YkVarPtr gp, int nthr,
+                                          slab_visitor_t visitor) const {
+        VarSlabLayout sl;
+        if (nthr < 1 || !_get_var_slab_layout(gp, sl))
+            return false;
+
+        // Visit each outer slice.
+        for (auto ofs : sl.outer_ofs) {
+
+            // Visit runs of consecutive layout indices with the same owner.
+            idx_t n = sl.nslabs;
+            idx_t begin = 0;
+            for (idx_t i = 1; i <= n; i++) {
+                int owner = _get_outer_thread_of_index(sl.first_idx + begin * sl.vlen, nthr);
+                if (i < n && _get_outer_thread_of_index(sl.first_idx + i * sl.vlen, nthr) == owner)
+                    continue;
+                visitor(sl.base + (ofs + begin * sl.stride) * sl.elem_bytes,
+                        (i - begin) * sl.stride * sl.elem_bytes, owner);
+                begin = i;
+            }
+        }
+        return true;
+    }
+
+    // Advise the OS to read the pages of the memory-mapped vars needed by
+    // the mega-block following the one in 'mb_idxs' in the first domain
+    // dim, so that they are read while the current one is computed.  At
+    // the first mega-block, the current pages are also requested.
+    void StencilContext::_prefetch_mmap_vars(const ScanIndices& mb_idxs) {
+        STATE_VARS(this);
+        if (!actl_opts->_mmap_prefetch || _mmap_var_ptrs.empty())
+            return;
+        auto& odim = domain_dims.get_dim_name(0);
+        const int posn = step_posn + 1; // posn of first domain dim in stencil dims.
+        idx_t rofs = rank_domain_offsets[0];
+
+        // Rank-relative range of current mega-block and next one.
+        idx_t start = mb_idxs.start[posn] - rofs;
+        idx_t stop = mb_idxs.stop[posn] - rofs;
+        idx_t end = mb_idxs.end[posn] - rofs;
+        idx_t first = (mb_idxs.start[posn] == mb_idxs.begin[posn]) ? start : stop;
+        idx_t last = min(stop + (stop - start), end);
+        if (last <= first)
+            return;
+        
+        for (auto gp : _mmap_var_ptrs) {
+            VarSlabLayout sl;
+            if (!_get_var_slab_layout(gp, sl))
+                continue;
+
+            // Range of slabs including halos.
+            idx_t b = first - gp->get_left_halo_size(odim) - sl.first_idx;
+            idx_t e = last + gp->get_right_halo_size(odim) - sl.first_idx;
+            idx_t li0 = max(idx_t(0), b / sl.vlen);
+            idx_t li1 = min(sl.nslabs, CEIL_DIV(e, sl.vlen));
+            if (li1 <= li0)
+                continue;
+            for (auto ofs : sl.outer_ofs)
+                mmap_prefetch(sl.base + (ofs + li0 * sl.stride) * sl.elem_bytes,
+                              (li1 - li0) * sl.stride * sl.elem_bytes);
+        }
+    }
+
+    // Bind the pages of the storage of 'gp' to the NUMA nodes of the
+    // outer threads that will compute them.
+    void StencilContext::_bind_numa_slabs(YkVarPtr gp) {
+        STATE_VARS(this);
+        int nthr = int(_outer_thread_numa_nodes.size());
+        idx_t nbinds = 0;
+        bool ok = _visit_var_slabs(gp, nthr,
+                                   [&](char* p, size_t nbytes, int owner) {
+                                       numa_bind(p, nbytes, _outer_thread_numa_nodes.at(owner));
+                                       nbinds++;
+                                   });
+        if (!ok)
+            DEBUG_MSG("Note: var '" << gp->get_name() << "' does not have '" <<
+                      domain_dims.get_dim_name(0) <<
+                      "' as its outermost domain dim, so its pages are not bound in slabs");
+        else
+            TRACE_MSG("var '" << gp->get_name() << "' bound in " << nbinds << " slab(s)");
+    }
+
+    // Touch the storage of the given vars from the outer threads that
+    // will compute them, so that pages are placed near those threads by
+    // the OS's first-touch policy.  Vars that cannot be divided into
+    // slabs are divided evenly across the threads.
+    void StencilContext::_first_touch_vars(const VarPtrs& gps) {
+        STATE_VARS(this);
+        if (!actl_opts->_first_touch || !gps.size())
+            return;
+        int rthreads, bthreads;
+        get_num_comp_threads(rthreads, bthreads);
+
+        YaskTimer ft_timer;
+        ft_timer.start();
+        #pragma omp parallel num_threads(rthreads)
+        {
+            int thr = omp_get_thread_num();
+            auto touch = [&](char* p, size_t nbytes, int owner) {
+                if (owner == thr)
+                    memset(p, 0, nbytes);
+            };
+            for (auto gp : gps) {
+                if (!_visit_var_slabs(gp, rthreads, touch)) {
+                    char* base = static_cast<char*>(gp->gb().get_storage());
+                    size_t nbytes = gp->get_num_storage_bytes();
+                    size_t begin = (nbytes * thr) / rthreads;
+                    size_t end = (nbytes * (thr + 1)) / rthreads;
+                    if (base && end > begin)
+                        memset(base + begin, 0, end - begin);
+                }
+            }
+        }
+        ft_timer.stop();
+        DEBUG_MSG("First-touch of " << gps.size() << " var(s) done by " <<
+                  rthreads << " thread(s) in " <<
+                  make_num_str(ft_timer.get_elapsed_secs()) << " secs.");
+    }
+
+    // Touch each scratch var from the outer thread that uses it.
+    void StencilContext::_first_touch_scratch_vars() {
+        STATE_VARS(this);
+        if (!actl_opts->_first_touch || !scratch_vecs.size())
+            return;
+        int rthreads, bthreads;
+        get_num_comp_threads(rthreads, bthreads);
+
+        #pragma omp parallel num_threads(rthreads)
+        {
+            int thr = omp_get_thread_num();
+            for (auto* sgv : scratch_vecs) {
+                if (thr < int(sgv->size())) {
+                    auto gp = sgv->at(thr);
+                    char* base = static_cast<char*>(gp->gb().get_storage());
+                    if (base)
+                        memset(base, 0, gp->get_num_storage_bytes());
+                }
+            }
+        }
+    }
+
+    // Increase the padding of each var listed in the 'node_shared_vars'
+    // option so that its allocation covers the domains of all the ranks on
+    // this node with the same layout in each rank. Then, all these ranks
+    // can use one copy of the var, each one viewing its own sub-domain.
+    void StencilContext::_setup_node_shared_vars() {
+        STATE_VARS(this);
+        if (actl_opts->_node_shared_vars.empty())
+            return;
+
+        #ifdef USE_MPI
+        if (env->shm_comm == MPI_COMM_NULL) {
+            DEBUG_MSG("Note: MPI shm is not available, so no vars are shared across ranks");
+            return;
+        }
+        auto& comm = env->shm_comm;
+
+        // Find the box containing the domains of the ranks on this node.
+        vector<idx_t> my_begin(nddims), my_end(nddims), node_begin(nddims), node_end(nddims);
+        idx_t my_pts = 1;
+        for (int i = 0; i < nddims; i++) {
+            auto& dname = domain_dims.get_dim_name(i);
+            my_begin[i] = rank_domain_offsets[i];
+            my_end[i] = my_begin[i] + actl_opts->_rank_sizes[dname];
+            my_pts *= actl_opts->_rank_sizes[dname];
+        }
+        MPI_Allreduce(my_begin.data(), node_begin.data(), nddims, MPI_INTEGER8, MPI_MIN, comm);
+        MPI_Allreduce(my_end.data(), node_end.data(), nddims, MPI_INTEGER8, MPI_MAX, comm);
+        idx_t node_pts = 0;
+        MPI_Allreduce(&my_pts, &node_pts, 1, MPI_INTEGER8, MPI_SUM, comm);
+
+        // The ranks must fill the box, and each rank's offset in the box
+        // must be a vector multiple so that all ranks can use the same layout.
+        idx_t box_pts = 1;
+        int ok = 1;
+        for (int i = 0; i < nddims; i++) {
+            auto& dname = domain_dims.get_dim_name(i);
+            box_pts *= node_end[i] - node_begin[i];
+            if ((my_begin[i] - node_begin[i]) % dims->_fold_pts[dname] != 0)
+                ok = 0;
+        }
+        if (node_pts != box_pts)
+            ok = 0;
+        MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_MIN, comm);
+        if (!ok) {
+            DEBUG_MSG("Note: rank domains on this node do not form a vector-aligned box, "
+                      "so no vars are shared across ranks");
+            return;
+        }
+
+        for (auto& gname : actl_opts->_node_shared_vars) {
+            if (!all_var_map.count(gname))
+                THROW_YASK_EXCEPTION("var '" + gname + "' in 'node_shared_vars' not found");
+            if (output_var_map.count(gname))
+                THROW_YASK_EXCEPTION("var '" + gname + "' in 'node_shared_vars' is "
+                                     "written by the stencils, so it cannot be shared");
+            auto gp = all_var_map.at(gname);
+            if (gp->is_storage_allocated())
+                continue;
+
+            // Make each pad reach the edge of the node box plus
+            // the largest pad needed by any rank on that side.
+            for (int i = 0; i < nddims; i++) {
+                auto& dname = domain_dims.get_dim_name(i);
+                if (!gp->is_dim_used(dname))
+                    continue;
+
+                // The extra vec added in resize() is not included here
+                // because it will be added again.
+                idx_t svl = gp->_get_soln_vec_len(dname);
+                idx_t pads[2] = { gp->get_left_pad_size(dname) - svl,
+                                  gp->get_right_pad_size(dname) - svl };
+                MPI_Allreduce(MPI_IN_PLACE, pads, 2, MPI_INTEGER8, MPI_MAX, comm);
+                gp->update_left_min_pad_size(dname, my_begin[i] - node_begin[i] + pads[0]);
+                gp->update_right_min_pad_size(dname, node_end[i] - my_end[i] + pads[1]);
+            }
+            _node_shared_var_names.insert(gname);
+            DEBUG_MSG("Var '" << gname << "' will be shared by " <<
+                      env->num_shm_ranks << " rank(s) on this node");
+        }
+        #endif
+    }
+
+    // Each rank may have written its part of the shared vars, e.g., via
+    // set_elements_*() or read_checkpoint(). Sync the window before and
+    // after a barrier so those writes are seen by the other ranks.
+    void StencilContext::_sync_node_shared_vars() {
+        STATE_VARS(this);
+        if (_node_shared_var_names.empty())
+            return;
+
+        #ifdef USE_MPI
+        MPI_Win_sync(mpi_info->node_var_win);
+        MPI_Barrier(env->shm_comm);
+        MPI_Win_sync(mpi_info->node_var_win);
+        #endif
+    }
+
     // Allocate memory for vars that do not already have storage.
     void StencilContext::alloc_var_data() {
         STATE_VARS(this);
@@ -375,6 +834,23 @@ namespace yask {
 
         // Requests for allocation.
         AllocMap alloc_reqs;
+
+        // Vars allocated here.
+        VarPtrs new_var_ptrs;
+
+        // Set sizes of vars to be shared across ranks.
+        _setup_node_shared_vars();
+
+        // Find vars to be stored in files.
+        set<string> mmap_names;
+        for (auto& gname : actl_opts->_mmap_vars) {
+            if (!all_var_map.count(gname))
+                THROW_YASK_EXCEPTION("var '" + gname + "' in 'mmap_vars' not found");
+            if (_node_shared_var_names.count(gname))
+                THROW_YASK_EXCEPTION("var '" + gname + "' cannot be in both "
+                                     "'mmap_vars' and 'node_shared_vars'");
+            mmap_names.insert(gname);
+        }
         
         // Pass 0: count required size for each NUMA node, allocate chunk of memory at end.
         // Pass 1: distribute parts of already-allocated memory chunk.
@@ -390,6 +866,13 @@ namespace yask {
                 data.nvars = 0;
             }
             int seq_num = 0;
+            int mmap_num = 0;
+
+            // Cache geometry for staggering vars in a bundle.
+            idx_t cbytes = actl_opts->_allow_addl_pad ?
+                actl_opts->get_cache_conflict_bytes() : 0;
+            idx_t nslots = cbytes / CACHELINE_BYTES;
+            idx_t stagger = (nslots * 5 / 8) | 1; // odd, to visit all slots.
 
             // Vars.
             for (auto gp : sorted_var_ptrs) {
@@ -403,6 +886,12 @@ namespace yask {
 
                 // NUMA policy for this var.
                 int numa_pref = gp->get_numa_preferred();
+
+                // Shared across ranks?
+                bool node_shared = _node_shared_var_names.count(gname) > 0;
+
+                // Stored in a file?
+                bool is_mmap = mmap_names.count(gname) > 0;
                 
                 // Var data.
                 // Don't alloc if already done.
@@ -416,8 +905,26 @@ namespace yask {
                         seq_num++;
 
                     // Make a request key and make or lookup data.
-                    AllocKey req_key = make_pair(numa_pref, seq_num);
+                    // All shared vars use one MPI window.
+                    // Each file-backed var uses its own file.
+                    AllocKey req_key = is_mmap ?
+                        make_pair(_mmap_key, mmap_num++) :
+                        node_shared ?
+                        make_pair(_node_shmem_key, 0) :
+                        make_pair(numa_pref, seq_num);
                     auto& req_data = alloc_reqs[req_key];
+                    if (is_mmap)
+                        req_data.fname = actl_opts->_mmap_dir + "/yask." +
+                            gname + ".rank" + to_string(env->my_rank) + ".dat";
+
+                    // Stagger the starts of vars in a bundle across the
+                    // cache sets, so the same indices in different vars
+                    // don't conflict.
+                    if (req_data.nvars > 0 && nslots > 1) {
+                        idx_t tgt = (req_data.nvars * stagger) % nslots * CACHELINE_BYTES;
+                        idx_t cur = req_data.nbytes % cbytes;
+                        req_data.nbytes += (tgt - cur + cbytes) % cbytes;
+                    }
                     
                     // Set storage if buffer has been allocated in pass 0.
                     if (pass == 1) {
@@ -427,15 +934,36 @@ namespace yask {
                         // Offset into buffer is running byte count in 'npbytes'.
                         gp->set_storage(p, req_data.nbytes);
                         DEBUG_MSG(gb.make_info_string());
+                        auto& cpads = gb.get_conflict_pads();
+                        if (cpads.sum() > 0)
+                            DEBUG_MSG(" padding in var '" << gname << "' extended by " <<
+                                      cpads.make_dim_val_str(gb.get_dim_tuple()) <<
+                                      " to avoid cache-set conflicts");
+
+                        // Place slabs before any pages are touched.
+                        // Shared vars are not touched here because other
+                        // ranks may already be using them, and
+                        // file-backed vars are not touched to avoid
+                        // reading the whole file into memory.
+                        if (is_mmap)
+                            _mmap_var_ptrs.push_back(gp);
+                        else if (!node_shared) {
+                            if (numa_pref == yask_numa_slabs)
+                                _bind_numa_slabs(gp);
+                            new_var_ptrs.push_back(gp);
+                        }
                     }
 
                     // Running totals.
                     req_data.nvars++;
                     req_data.nbytes += res_bytes;
 
-                    if (pass == 0)
+                    if (pass == 0) {
                         TRACE_MSG(" var '" << gname << "' needs " << make_byte_str(nbytes) <<
                                   " w/numa-pref " << numa_pref);
+                        if (numa_pref == yask_numa_slabs)
+                            _find_outer_thread_numa_nodes();
+                    }
                 }
 
                 // Otherwise, just print existing var info.
@@ -449,6 +977,9 @@ namespace yask {
                 _alloc_data(alloc_reqs, "var");
 
         } // var passes.
+
+        // Place pages near the threads that will use them.
+        _first_touch_vars(new_var_ptrs);
     };
 
     // Determine the size and shape of all MPI buffers.
@@ -498,6 +1029,14 @@ namespace yask {
                      auto& gname = gp->get_name();
                      bool var_vec_ok = vec_ok;
 
+                     // A shared var already contains the data of
+                     // the ranks on the same node.
+                     if (_node_shared_var_names.count(gname) &&
+                         mpi_info->is_node_neighbor.at(neigh_idx)) {
+                         TRACE_MSG("no halo exchange needed with rank " << neigh_rank <<
+                                   " for shared var '" << gname << "'");
+                         continue; // to next var.
+                     }
 
                      // Get calculated max dist needed for this var.
                      int maxdist = gp->get_halo_exchange_l1_norm();
@@ -1152,6 +1691,15 @@ namespace yask {
                         assert(p);
                         gp->set_storage(p, req_data->nbytes);
                         TRACE_MSG(gb.make_info_string());
+
+                        // Each scratch var is used by only one outer
+                        // thread, so put it all on that thread's node.
+                        if (new_slot && numa_pref == yask_numa_slabs) {
+                            _find_outer_thread_numa_nodes();
+                            numa_bind(static_cast<char*>(gp->gb().get_storage()),
+                                      gp->get_num_storage_bytes(),
+                                      _outer_thread_numa_nodes.at(thr_num));
+                        }
                     }
 
                     // Determine size used (also offset to next location).
@@ -1184,6 +1732,9 @@ namespace yask {
                 _alloc_data(alloc_reqs, "scratch var");
 
         } // scratch-var passes.
+
+        // Place pages near the threads that will use them.
+        _first_touch_scratch_vars();
     }
 
 } // namespace yask.
@@ -57,6 +57,9 @@ extern "C" {
 #define MPOL_INTERLEAVE  3
 
 #endif
+
+// Used to find the NUMA node of the current thread.
+#include <sys/syscall.h>
 #endif
 
 namespace yask {
@@ -131,6 +134,13 @@ namespace yask {
         void operator()(char* p);
     };
 
+    // Get the NUMA node of the CPU running the calling thread.
+    extern int get_cur_numa_node();
+
+    // Bind the pages containing the given range to a NUMA node.
+    // Pages must not have been touched yet.
+    extern void numa_bind(char* p, std::size_t nbytes, int numa_node);
+
     // Allocate NUMA memory from preferred node.
     template<typename T>
     std::shared_ptr<T> shared_numa_alloc(size_t nbytes, int numa_pref) {
@@ -147,8 +157,10 @@ namespace yask {
     }
 
     // Helpers for MPI shm malloc and free.
+    // If 'node_shared', one buffer is allocated for all ranks in 'shm_comm'.
     extern char* shm_alloc(std::size_t nbytes,
-                          const MPI_Comm* shm_comm, MPI_Win* shm_win);
+                           const MPI_Comm* shm_comm, MPI_Win* shm_win,
+                           bool node_shared = false);
     struct ShmDeleter : DeleterBase {
         const MPI_Comm* _shm_comm;
         MPI_Win* _shm_win;
@@ -168,10 +180,11 @@ namespace yask {
     // Allocate MPI shm memory.
     template<typename T>
     std::shared_ptr<T> shared_shm_alloc(size_t nbytes,
-                                        const MPI_Comm* shm_comm, MPI_Win* shm_win) {
+                                        const MPI_Comm* shm_comm, MPI_Win* shm_win,
+                                        bool node_shared = false) {
 
         // Alloc mem.
-        char* cp = shm_alloc(nbytes, shm_comm, shm_win);
+        char* cp = shm_alloc(nbytes, shm_comm, shm_win, node_shared);
 
         // Map alloc to device.
         // Shm on device not currently supported.
@@ -182,6 +195,40 @@ namespace yask {
         return _base;
     }
 
+    // Helpers for file-backed memory maps.
+    // A new file named 'fname_prefix' plus a unique suffix is created
+    // and removed after mapping, so its space is freed when the memory
+    // is unmapped.
+    extern char* mmap_file_alloc(std::size_t nbytes, const std::string& fname_prefix);
+    struct MmapDeleter : DeleterBase {
+
+        // Ctor saves data needed for freeing.
+        MmapDeleter(std::size_t nbytes) :
+            DeleterBase(nbytes) { }
+
+        // Free p.
+        void operator()(char* p);
+    };
+
+    // Allocate memory backed by a file.
+    template<typename T>
+    std::shared_ptr<T> shared_mmap_alloc(size_t nbytes, const std::string& fname) {
+
+        // Alloc mem.
+        char* cp = mmap_file_alloc(nbytes, fname);
+
+        // Map alloc to device.
+        offload_map_alloc(cp, nbytes);
+
+        // Make shared ptr.
+        auto _base = std::shared_ptr<T>(cp, MmapDeleter(nbytes));
+        return _base;
+    }
+
+    // Advise the OS to read the file pages in the given range
+    // asynchronously.
+    extern void mmap_prefetch(char* p, std::size_t nbytes);
+
     // Key for allocating memory.
     // Pair is mem type and sequence number.
     typedef std::pair<int, int> AllocKey;
@@ -191,6 +238,7 @@ namespace yask {
         std::shared_ptr<char> ptr;
         size_t nbytes = 0;
         int nvars = 0;
+        std::string fname; // backing file, if any.
     };
 
     // Map from alloc key to data.
@@ -0,0 +1,1259 @@
+/*****************************************************************************
+
+YASK: Yet Another Stencil Kit
+Copyright (c) 2014-2023, Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to
+deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*****************************************************************************/
+
+
+// This file contains implementations of StencilContext methods for
+// writing and reading checkpoints and snapshots of the solution state.
+
+#include "yask_stencil.hpp"
+using namespace std;
+
+namespace yask {
+
+    // Checkpoint file format:
+    // - Magic string, version, and codec.
+    // - Solution name, element size, and number of steps done.
+    // - Number of ranks and this rank's index.
+    // - For each domain dim: name, overall size, rank size, and rank offset.
+    // - Number of vars, then for each var:
+    //   - Name and number of dims.
+    //   - For each dim: name, alloc size, and first local index.
+    //   - Number of bytes of storage.
+    //   - Number of bytes stored, followed by the raw storage, encoded
+    //     with the codec in the header.
+    // All integers are stored as native 'idx_t' values.
+    // Version 1 files have no codec or number of bytes stored.
+    // (Version 2 is the shared format below.)
+    static const string _ckpt_magic = "YASKCKPT";
+    constexpr idx_t _ckpt_version = 3;
+
+    // Binary I/O helpers.
+    static void _ckpt_write(ostream& os, idx_t val) {
+        os.write((const char*)&val, sizeof(val));
+    }
+    static void _ckpt_write(ostream& os, const string& str) {
+        _ckpt_write(os, idx_t(str.length()));
+        os.write(str.data(), str.length());
+    }
+    static idx_t _ckpt_read_idx(istream& is, const string& fname) {
+        idx_t val = 0;
+        is.read((char*)&val, sizeof(val));
+        if (!is)
+            THROW_YASK_EXCEPTION("unexpected end of checkpoint file '" + fname + "'");
+        return val;
+    }
+    static string _ckpt_read_str(istream& is, const string& fname) {
+        idx_t len = _ckpt_read_idx(is, fname);
+        if (len < 0 || len > 1024)
+            THROW_YASK_EXCEPTION("invalid string in checkpoint file '" + fname + "'");
+        string str(len, ' ');
+        is.read(&str[0], len);
+        if (!is)
+            THROW_YASK_EXCEPTION("unexpected end of checkpoint file '" + fname + "'");
+        return str;
+    }
+
+    // Check a value read from a checkpoint.
+    static void _ckpt_check(idx_t found, idx_t expected,
+                            const string& descr, const string& fname) {
+        if (found != expected)
+            FORMAT_AND_THROW_YASK_EXCEPTION("checkpoint file '" << fname << "' has " <<
+                                            descr << " of " << found <<
+                                            ", but the solution has " << expected);
+    }
+    static void _ckpt_check(const string& found, const string& expected,
+                            const string& descr, const string& fname) {
+        if (found != expected)
+            THROW_YASK_EXCEPTION("checkpoint file '" + fname + "' has " +
+                                 descr + " '" + found +
+                                 "', but the solution has '" + expected + "'");
+    }
+
+    // Codecs for snapshot and checkpoint data.
+    // - 'xor' is lossless: each value is XORed with the previous one, and
+    //   only the low-order bytes up to the highest non-zero byte of the
+    //   result are kept, because neighboring values usually share their
+    //   sign, exponent, and high-order mantissa bits.  A 4-bit count of the
+    //   bytes kept for each value precedes the data.  Any bytes after the
+    //   last whole value, e.g., from vars with 1- or 2-byte elements, are
+    //   kept as-is at the end.
+    // - 'fixed' is lossy block quantization at a fixed number of bits per
+    //   value, not a transform codec: each block of '_codec_block' values
+    //   is stored as the largest magnitude in the block followed by each
+    //   value scaled to a signed 'rate'-bit integer.  It is only used for
+    //   per-rank snapshots, which are coded in row-major order of the
+    //   rank domain, because checkpoints must be exact.
+    // Values are coded in the order given, so checkpoints are coded in the
+    // vector-folded storage layout.  Shared MPI-IO files are not coded.
+    enum codec_t { codec_none, codec_xor, codec_fixed };
+    constexpr idx_t _codec_block = 64;
+    #if REAL_BYTES == 8
+    typedef uint64_t real_bits_t;
+    #else
+    typedef uint32_t real_bits_t;
+    #endif
+
+    static int _get_codec(const string& name, const string& opt_name) {
+        if (name == "none")
+            return codec_none;
+        if (name == "xor")
+            return codec_xor;
+        if (name == "fixed")
+            return codec_fixed;
+        THROW_YASK_EXCEPTION("unknown codec '" + name + "' in '" + opt_name +
+                             "'; must be 'none', 'xor', or 'fixed'");
+        return codec_none;
+    }
+
+    // Encode 'nbytes' from 'in' to 'out'.
+    // For the 'fixed' codec, 'nbytes' must be a multiple of the size of a real.
+    static void _encode(int codec, int rate, const void* in, idx_t nbytes,
+                        vector<char>& out) {
+        auto* ip = (const char*)in;
+        if (codec == codec_xor) {
+            idx_t n = nbytes / sizeof(real_bits_t);
+            idx_t ntail = nbytes - n * sizeof(real_bits_t);
+            idx_t ncodes = CEIL_DIV(n, 2);
+            out.assign(ncodes + nbytes, 0);
+            auto* codes = (uint8_t*)out.data();
+            char* dp = out.data() + ncodes;
+            real_bits_t prev = 0;
+            for (idx_t i = 0; i < n; i++) {
+                real_bits_t v;
+                memcpy(&v, ip + i * sizeof(v), sizeof(v));
+                real_bits_t r = v ^ prev;
+                prev = v;
+                int nb = 0;
+                while (nb < int(sizeof(r)) && (r >> (nb * 8)) != 0)
+                    nb++;
+                codes[i / 2] |= nb << ((i % 2) * 4);
+                memcpy(dp, &r, nb); // low-order bytes on little-endian CPUs.
+                dp += nb;
+            }
+            memcpy(dp, ip + n * sizeof(real_bits_t), ntail);
+            dp += ntail;
+            out.resize(dp - out.data());
+        }
+        else if (codec == codec_fixed) {
+            assert(nbytes % sizeof(real_t) == 0);
+            idx_t n = nbytes / sizeof(real_t);
+            idx_t qmax = (idx_t(1) << (rate - 1)) - 1;
+            out.clear();
+            for (idx_t b = 0; b < n; b += _codec_block) {
+                idx_t nv = min(_codec_block, n - b);
+                real_t vals[_codec_block];
+                memcpy(vals, ip + b * sizeof(real_t), nv * sizeof(real_t));
+                real_t scale = 0;
+                for (idx_t i = 0; i < nv; i++)
+                    scale = max(scale, real_t(fabs(vals[i])));
+                size_t ofs = out.size();
+                out.resize(ofs + sizeof(real_t) + CEIL_DIV(nv * rate, 8));
+                memcpy(&out[ofs], &scale, sizeof(real_t));
+                char* dp = &out[ofs + sizeof(real_t)];
+
+                // Pack 'rate' bits per value.
+                uint64_t acc = 0;
+                int nbits = 0;
+                for (idx_t i = 0; i < nv; i++) {
+                    idx_t q = scale > 0 ? llrint(vals[i] / scale * qmax) : 0;
+                    acc |= uint64_t(q + qmax) << nbits;
+                    nbits += rate;
+                    while (nbits >= 8) {
+                        *dp++ = char(acc & 0xff);
+                        acc >>= 8;
+                        nbits -= 8;
+                    }
+                }
+                if (nbits)
+                    *dp++ = char(acc & 0xff);
+            }
+        }
+        else
+            out.assign(ip, ip + nbytes);
+    }
+
+    // Decode 'nbytes' at 'in' to 'nout' bytes at 'out'.
+    // Returns false if the data is malformed.
+    static bool _decode(int codec, int rate, const char* in, size_t nbytes,
+                        void* out, idx_t nout) {
+        auto* op = (char*)out;
+        const char* end = in + nbytes;
+        if (codec == codec_xor) {
+            idx_t n = nout / sizeof(real_bits_t);
+            idx_t ntail = nout - n * sizeof(real_bits_t);
+            idx_t ncodes = CEIL_DIV(n, 2);
+            if (idx_t(nbytes) < ncodes)
+                return false;
+            auto* codes = (const uint8_t*)in;
+            const char* dp = in + ncodes;
+            real_bits_t prev = 0;
+            for (idx_t i = 0; i < n; i++) {
+                int nb = (codes[i / 2] >> ((i % 2) * 4)) & 0xf;
+                if (nb > int(sizeof(prev)) || dp + nb > end)
+                    return false;
+                real_bits_t r = 0;
+                memcpy(&r, dp, nb);
+                dp += nb;
+                prev ^= r;
+                memcpy(op + i * sizeof(prev), &prev, sizeof(prev));
+            }
+            if (end - dp != ntail)
+                return false;
+            memcpy(op + n * sizeof(prev), dp, ntail);
+            return true;
+        }
+        else if (codec == codec_fixed) {
+            if (rate < 2 || rate > 32 || nout % sizeof(real_t) != 0)
+                return false;
+            idx_t n = nout / sizeof(real_t);
+            idx_t qmax = (idx_t(1) << (rate - 1)) - 1;
+            uint64_t mask = (uint64_t(1) << rate) - 1;
+            const char* dp = in;
+            for (idx_t b = 0; b < n; b += _codec_block) {
+                idx_t nv = min(_codec_block, n - b);
+                if (dp + sizeof(real_t) + CEIL_DIV(nv * rate, 8) > end)
+                    return false;
+                real_t scale;
+                memcpy(&scale, dp, sizeof(real_t));
+                dp += sizeof(real_t);
+                uint64_t acc = 0;
+                int nbits = 0;
+                for (idx_t i = 0; i < nv; i++) {
+                    while (nbits < rate) {
+                        acc |= uint64_t(uint8_t(*dp++)) << nbits;
+                        nbits += 8;
+                    }
+                    idx_t q = idx_t(acc & mask) - qmax;
+                    acc >>= rate;
+                    nbits -= rate;
+                    real_t v = real_t(q) * scale / qmax;
+                    memcpy(op + (b + i) * sizeof(real_t), &v, sizeof(real_t));
+                }
+            }
+            return dp == end;
+        }
+        if (idx_t(nbytes) != nout)
+            return false;
+        memcpy(out, in, nbytes);
+        return true;
+    }
+
+    // Shared checkpoint file format:
+    // - Magic string, version, and size of the header in bytes.
+    // - Solution name, element size, and number of steps done.
+    // - For each domain dim: name and overall size.
+    // - Number of vars, then for each var:
+    //   - Name and number of dims.
+    //   - For each dim: name, first index, and size of the global array.
+    //   - Byte offset of the global array in the file.
+    // - Global array of each var: reals in row-major order of the var's
+    //   dims, at 4KiB-aligned offsets.  The domain dims include the halos
+    //   outside of the overall domain, and the step dim includes all valid
+    //   steps.
+    // All integers are stored as native 'idx_t' values.
+    // Nothing in the file depends on the number or layout of the ranks,
+    // so it can be read by a run with a different decomposition.
+    constexpr idx_t _shared_ckpt_version = 2;
+    constexpr idx_t _shared_ckpt_align = 4096;
+
+    // Is 'fname' a shared checkpoint file?
+    static bool _is_shared_ckpt(const string& fname) {
+        ifstream is(fname, ifstream::in | ifstream::binary);
+        string magic(_ckpt_magic.length(), ' ');
+        idx_t version = 0;
+        is.read(&magic[0], magic.length());
+        is.read((char*)&version, sizeof(version));
+        return is && magic == _ckpt_magic && version == _shared_ckpt_version;
+    }
+
+    // Each rank uses its own file unless MPI-IO is used.
+    string StencilContext::get_rank_file_name(const string& file_name) const {
+        STATE_VARS_CONST(this);
+        if (env->num_ranks > 1 && !actl_opts->_mpi_io)
+            return file_name + ".rank" + to_string(env->my_rank);
+        return file_name;
+    }
+
+    // Write all vars and metadata.
+    void StencilContext::write_checkpoint(const string& file_name) {
+        if (!is_prepared())
+            THROW_YASK_EXCEPTION("write_checkpoint() called without calling prepare_solution() first");
+        _write_checkpoint(file_name, all_var_ptrs);
+    }
+
+    // Write vars in 'gps' and metadata.
+    void StencilContext::_write_checkpoint(const string& file_name,
+                                           const VarPtrs& gps) {
+        STATE_VARS(this);
+        if (actl_opts->_mpi_io) {
+            _write_shared_checkpoint(file_name, gps);
+            return;
+        }
+        int codec = _get_codec(actl_opts->_ckpt_codec, "ckpt_codec");
+        if (codec == codec_fixed)
+            THROW_YASK_EXCEPTION("lossy codec 'fixed' cannot be used for checkpoints");
+        auto fname = get_rank_file_name(file_name);
+        DEBUG_MSG("Writing checkpoint to '" << fname << "'...");
+        YaskTimer timer;
+        timer.start();
+
+        // Make sure host has current data.
+        copy_vars_from_device();
+
+        ofstream os(fname, ofstream::out | ofstream::trunc | ofstream::binary);
+        if (!os)
+            THROW_YASK_EXCEPTION("cannot open checkpoint file '" + fname + "' for writing");
+
+        // Solution metadata.
+        os.write(_ckpt_magic.data(), _ckpt_magic.length());
+        _ckpt_write(os, _ckpt_version);
+        _ckpt_write(os, idx_t(codec));
+        _ckpt_write(os, get_name());
+        _ckpt_write(os, idx_t(get_element_bytes()));
+        _ckpt_write(os, steps_done);
+        _ckpt_write(os, idx_t(env->num_ranks));
+        _ckpt_write(os, idx_t(env->my_rank));
+        _ckpt_write(os, idx_t(nddims));
+        DOMAIN_VAR_LOOP(i, j) {
+            auto& dname = domain_dims.get_dim_name(j);
+            _ckpt_write(os, dname);
+            _ckpt_write(os, actl_opts->_global_sizes[i]);
+            _ckpt_write(os, actl_opts->_rank_sizes[i]);
+            _ckpt_write(os, rank_domain_offsets[j]);
+        }
+
+        // Vars.
+        _ckpt_write(os, idx_t(gps.size()));
+        size_t nbytes = 0, nstored = 0;
+        vector<char> zbuf;
+        for (auto gp : gps) {
+            auto& gb = gp->gb();
+            _ckpt_write(os, gp->get_name());
+            int ndims = gp->get_num_dims();
+            _ckpt_write(os, idx_t(ndims));
+            for (int i = 0; i < ndims; i++) {
+                _ckpt_write(os, gb.get_dim_name(i));
+                _ckpt_write(os, gp->get_alloc_size(gb.get_dim_name(i)));
+                _ckpt_write(os, gp->get_first_local_index(gb.get_dim_name(i)));
+            }
+
+            // Stream the raw storage.
+            auto* p = (const char*)gp->get_raw_storage_buffer();
+            idx_t vbytes = p ? gp->get_num_storage_bytes() : 0;
+            _ckpt_write(os, vbytes);
+            if (codec != codec_none && vbytes) {
+                _encode(codec, 0, p, vbytes, zbuf);
+                p = zbuf.data();
+                _ckpt_write(os, idx_t(zbuf.size()));
+                os.write(p, zbuf.size());
+                nstored += zbuf.size();
+            }
+            else {
+                _ckpt_write(os, vbytes);
+                if (vbytes)
+                    os.write(p, vbytes);
+                nstored += vbytes;
+            }
+            nbytes += vbytes;
+        }
+        os.close();
+        if (!os)
+            THROW_YASK_EXCEPTION("error writing checkpoint file '" + fname + "'");
+        timer.stop();
+        DEBUG_MSG(" wrote " << make_byte_str(nbytes) << " of var data as " <<
+                  make_byte_str(nstored) << " in " <<
+                  make_num_str(timer.get_elapsed_secs()) << " secs");
+    }
+
+    // Read vars and metadata.
+    void StencilContext::read_checkpoint(const string& file_name) {
+        STATE_VARS(this);
+        if (!is_prepared())
+            THROW_YASK_EXCEPTION("read_checkpoint() called without calling prepare_solution() first");
+
+        // A shared file can be read with any number of ranks.
+        if (actl_opts->_mpi_io || _is_shared_ckpt(file_name)) {
+            _read_shared_checkpoint(file_name);
+            return;
+        }
+        auto fname = get_rank_file_name(file_name);
+        DEBUG_MSG("Reading checkpoint from '" << fname << "'...");
+        YaskTimer timer;
+        timer.start();
+
+        ifstream is(fname, ifstream::in | ifstream::binary);
+        if (!is)
+            THROW_YASK_EXCEPTION("cannot open checkpoint file '" + fname + "' for reading");
+
+        // Solution metadata.
+        string magic(_ckpt_magic.length(), ' ');
+        is.read(&magic[0], magic.length());
+        if (!is || magic != _ckpt_magic)
+            THROW_YASK_EXCEPTION("'" + fname + "' is not a YASK checkpoint file");
+        idx_t version = _ckpt_read_idx(is, fname);
+        if (version != 1)
+            _ckpt_check(version, _ckpt_version, "version", fname);
+        idx_t codec = (version == 1) ? codec_none : _ckpt_read_idx(is, fname);
+        if (codec != codec_none && codec != codec_xor)
+            THROW_YASK_EXCEPTION("checkpoint file '" + fname + "' has unknown codec");
+        _ckpt_check(_ckpt_read_str(is, fname), get_name(), "solution", fname);
+        _ckpt_check(_ckpt_read_idx(is, fname), get_element_bytes(), "element size", fname);
+        idx_t nsteps = _ckpt_read_idx(is, fname);
+        _ckpt_check(_ckpt_read_idx(is, fname), env->num_ranks, "number of ranks", fname);
+        _ckpt_check(_ckpt_read_idx(is, fname), env->my_rank, "rank index", fname);
+        _ckpt_check(_ckpt_read_idx(is, fname), nddims, "number of domain dims", fname);
+        DOMAIN_VAR_LOOP(i, j) {
+            auto& dname = domain_dims.get_dim_name(j);
+            _ckpt_check(_ckpt_read_str(is, fname), dname, "domain dim", fname);
+            _ckpt_check(_ckpt_read_idx(is, fname), actl_opts->_global_sizes[i],
+                        "overall domain size in '" + dname + "'", fname);
+            _ckpt_check(_ckpt_read_idx(is, fname), actl_opts->_rank_sizes[i],
+                        "rank domain size in '" + dname + "'", fname);
+            _ckpt_check(_ckpt_read_idx(is, fname), rank_domain_offsets[j],
+                        "rank domain offset in '" + dname + "'", fname);
+        }
+
+        // Vars.
+        idx_t nvars = _ckpt_read_idx(is, fname);
+        size_t nbytes = 0;
+        vector<char> zbuf;
+        for (idx_t vi = 0; vi < nvars; vi++) {
+            auto gname = _ckpt_read_str(is, fname);
+            if (!all_var_map.count(gname))
+                THROW_YASK_EXCEPTION("var '" + gname + "' in checkpoint file '" +
+                                     fname + "' not found in solution");
+            auto gp = all_var_map.at(gname);
+            auto& gb = gp->gb();
+            int ndims = gp->get_num_dims();
+            _ckpt_check(_ckpt_read_idx(is, fname), ndims,
+                        "number of dims in var '" + gname + "'", fname);
+            idx_t first_step = 0;
+            for (int i = 0; i < ndims; i++) {
+                auto& dname = gb.get_dim_name(i);
+                _ckpt_check(_ckpt_read_str(is, fname), dname,
+                            "dim in var '" + gname + "'", fname);
+                _ckpt_check(_ckpt_read_idx(is, fname), gp->get_alloc_size(dname),
+                            "allocation size of '" + dname + "' in var '" + gname + "'", fname);
+
+                // First valid step is restored, others must match.
+                idx_t first_idx = _ckpt_read_idx(is, fname);
+                if (i == +step_posn && gp->is_dim_used(step_dim))
+                    first_step = first_idx;
+                else
+                    _ckpt_check(first_idx, gp->get_first_local_index(dname),
+                                "first index of '" + dname + "' in var '" + gname + "'", fname);
+            }
+
+            // Read directly into the raw storage.
+            auto* p = (char*)gp->get_raw_storage_buffer();
+            idx_t vbytes = _ckpt_read_idx(is, fname);
+            _ckpt_check(vbytes, p ? gp->get_num_storage_bytes() : 0,
+                        "number of bytes in var '" + gname + "'", fname);
+            idx_t nstored = (version == 1) ? vbytes : _ckpt_read_idx(is, fname);
+            if (codec != codec_none && vbytes) {
+                zbuf.resize(nstored);
+                is.read(zbuf.data(), nstored);
+                if (!is)
+                    THROW_YASK_EXCEPTION("unexpected end of checkpoint file '" + fname + "'");
+                if (!_decode(codec, 0, zbuf.data(), nstored, p, vbytes))
+                    THROW_YASK_EXCEPTION("corrupt data for var '" + gname +
+                                         "' in checkpoint file '" + fname + "'");
+            }
+            else if (vbytes) {
+                _ckpt_check(nstored, vbytes, "number of bytes stored in var '" + gname + "'", fname);
+                is.read(p, vbytes);
+                if (!is)
+                    THROW_YASK_EXCEPTION("unexpected end of checkpoint file '" + fname + "'");
+            }
+            nbytes += vbytes;
+
+            // Restore step range, and mark all steps as modified on the host.
+            if (gp->is_dim_used(step_dim))
+                gb.get_corep()->_local_offsets[+step_posn] = first_step;
+            gb.get_coh().mod_host();
+            gb.set_dirty_all(YkVarBase::self, true);
+        }
+        steps_done = nsteps;
+        timer.stop();
+        DEBUG_MSG(" read " << make_byte_str(nbytes) << " of var data in " <<
+                  make_num_str(timer.get_elapsed_secs()) << " secs");
+    }
+
+    // Find the part of 'gp' held by this rank.
+    void StencilContext::_get_var_file_box(YkVarPtr gp, bool is_ckpt,
+                                           idx_t step, VarFileBox& box) const {
+        STATE_VARS_CONST(this);
+        auto& gb = gp->gb();
+        int ndims = gp->get_num_dims();
+        box.first.set_from_const(0, ndims);
+        box.last.set_from_const(0, ndims);
+        box.gsizes.assign(ndims, 0);
+        box.lsizes.assign(ndims, 0);
+        box.starts.assign(ndims, 0);
+        box.num_elems = 1;
+
+        // Vars that are not partitioned in a domain dim have the same
+        // data on all ranks in that dim, so only the first one writes.
+        // Fixed-size vars are never partitioned.
+        box.owner = true;
+        DOMAIN_VAR_LOOP(i, j) {
+            auto& dname = domain_dims.get_dim_name(j);
+            if ((gp->is_fixed_size() || !gp->is_dim_used(dname)) &&
+                actl_opts->_rank_indices[j] != 0)
+                box.owner = false;
+        }
+
+        for (int i = 0; i < ndims; i++) {
+            auto& dname = gb.get_dim_name(i);
+            idx_t first, last, gfirst, glast; // local and global ranges.
+            if (dname == step_dim) {
+                if (is_ckpt) {
+                    first = gp->get_first_valid_step_index();
+                    last = gp->get_last_valid_step_index();
+                }
+
+                // Use last valid step if var was not written at 'step'.
+                else
+                    first = last = max(gp->get_first_valid_step_index(),
+                                       min(gp->get_last_valid_step_index(), step));
+                gfirst = first;
+                glast = last;
+            }
+            else if (domain_dims.lookup(dname) && !gp->is_fixed_size()) {
+                first = gp->get_first_rank_domain_index(dname);
+                last = gp->get_last_rank_domain_index(dname);
+                gfirst = 0;
+                glast = actl_opts->_global_sizes[dname] - 1;
+
+                // Include halos outside of overall domain.
+                if (is_ckpt) {
+                    idx_t lh = gp->get_left_halo_size(dname);
+                    idx_t rh = gp->get_right_halo_size(dname);
+                    if (first == gfirst)
+                        first -= lh;
+                    if (last == glast)
+                        last += rh;
+                    gfirst -= lh;
+                    glast += rh;
+                }
+            }
+            else {
+                first = gfirst = gp->get_first_local_index(dname);
+                last = glast = gp->get_last_local_index(dname);
+            }
+            box.first[i] = first;
+            box.last[i] = last;
+
+            // MPI-IO sizes are 'int's. The global sizes are the same on
+            // all ranks, so all of them throw together.
+            if (glast - gfirst + 1 > INT_MAX)
+                THROW_YASK_EXCEPTION("size of '" + dname + "' in var '" + gp->get_name() +
+                                     "' is too large for var file I/O");
+            box.gsizes[i] = int(glast - gfirst + 1);
+            box.lsizes[i] = int(last - first + 1);
+            box.starts[i] = int(first - gfirst);
+            box.num_elems *= last - first + 1;
+        }
+    }
+
+    // A file shared by all ranks.  Uses collective MPI-IO if available.
+    // Otherwise, there is only one rank, which holds the whole global
+    // array of each var, so plain file I/O is used.
+    class SharedFile {
+        #ifdef USE_MPI
+        MPI_File _fh = MPI_FILE_NULL;
+        MPI_Comm _comm = MPI_COMM_NULL;
+        #else
+        fstream _fs;
+        #endif
+        bool _ok = true;
+
+        #ifdef USE_MPI
+
+        // MPI type of reals.
+        static MPI_Datatype _mpi_real() {
+            #if REAL_BYTES == 8
+            return MPI_DOUBLE;
+            #else
+            return MPI_FLOAT;
+            #endif
+        }
+
+        // Set the view to the part in 'box' of a global array of reals at
+        // byte offset 'ofs' and write or read it collectively.
+        // Only owners write.
+        void _rw_box(idx_t ofs, const VarFileBox& box, void* buf, bool is_write) {
+            auto rtype = _mpi_real();
+            int ndims = int(box.gsizes.size());
+            vector<MPI_Datatype> types;
+            bool ok = true;
+
+            // File type: the part within the global array.
+            MPI_Datatype ftype = rtype;
+            if (ndims) {
+                ok = MPI_Type_create_subarray(ndims, box.gsizes.data(), box.lsizes.data(),
+                                              box.starts.data(), MPI_ORDER_C, rtype,
+                                              &ftype) == MPI_SUCCESS &&
+                    MPI_Type_commit(&ftype) == MPI_SUCCESS;
+                if (ok)
+                    types.push_back(ftype);
+            }
+
+            // Memory type: the count is an 'int', so a part with more
+            // elements is moved as fewer blocks of contiguous rows,
+            // planes, etc.  The part is dense, so the block sizes are
+            // the part sizes in the inner dims.
+            MPI_Datatype mtype = rtype;
+            idx_t n = (is_write && !box.owner) ? 0 : box.num_elems;
+            for (int i = ndims - 1; ok && i >= 0 && n > INT_MAX; i--) {
+                MPI_Datatype btype;
+                ok = MPI_Type_contiguous(box.lsizes[i], mtype, &btype) == MPI_SUCCESS &&
+                    MPI_Type_commit(&btype) == MPI_SUCCESS;
+                if (ok) {
+                    types.push_back(btype);
+                    mtype = btype;
+                    n /= box.lsizes[i];
+                }
+            }
+            ok = ok && n <= INT_MAX;
+
+            // All ranks must agree before the collective calls, or
+            // those that skip them would leave the others waiting.
+            int all_ok = ok ? 1 : 0;
+            MPI_Allreduce(MPI_IN_PLACE, &all_ok, 1, MPI_INT, MPI_MIN, _comm);
+            int ret = all_ok ? MPI_SUCCESS : MPI_ERR_OTHER;
+            if (ret == MPI_SUCCESS)
+                ret = MPI_File_set_view(_fh, ofs, rtype, ftype, "native", MPI_INFO_NULL);
+            if (ret == MPI_SUCCESS) {
+                MPI_Status stat;
+                ret = is_write ?
+                    MPI_File_write_all(_fh, buf, int(n), mtype, &stat) :
+                    MPI_File_read_all(_fh, buf, int(n), mtype, &stat);
+            }
+            for (auto& t : types)
+                MPI_Type_free(&t);
+            _ok = _ok && ret == MPI_SUCCESS;
+        }
+
+        #else
+
+        // The part in 'box' is the whole global array.
+        void _rw_box(idx_t ofs, const VarFileBox& box, void* buf, bool is_write) {
+            for (size_t i = 0; i < box.gsizes.size(); i++)
+                assert(box.starts[i] == 0 && box.lsizes[i] == box.gsizes[i]);
+            idx_t nbytes = box.num_elems * REAL_BYTES;
+            if (is_write)
+                write_at(ofs, buf, nbytes);
+            else
+                read_at(ofs, buf, nbytes);
+        }
+
+        #endif
+
+    public:
+        ~SharedFile() { close(); }
+
+        // Open 'fname' on all ranks in 'comm'. Truncates it if 'is_write'.
+        // Returns false if it can't be opened.
+        bool open(MPI_Comm comm, const string& fname, bool is_write) {
+            #ifdef USE_MPI
+            int mode = is_write ? (MPI_MODE_CREATE | MPI_MODE_WRONLY) : MPI_MODE_RDONLY;
+            if (MPI_File_open(comm, fname.c_str(), mode, MPI_INFO_NULL, &_fh) != MPI_SUCCESS) {
+                _fh = MPI_FILE_NULL;
+                return false;
+            }
+            _comm = comm;
+            if (is_write)
+                _ok = MPI_File_set_size(_fh, 0) == MPI_SUCCESS;
+            return true;
+            #else
+            _fs.open(fname, fstream::binary |
+                     (is_write ? (fstream::out | fstream::trunc) : fstream::in));
+            return bool(_fs);
+            #endif
+        }
+
+        // Collective.
+        void close() {
+            #ifdef USE_MPI
+            if (_fh != MPI_FILE_NULL)
+                MPI_File_close(&_fh);
+            #else
+            if (_fs.is_open()) {
+                _fs.close();
+                _ok = _ok && bool(_fs);
+            }
+            #endif
+        }
+
+        // False if any write or read failed.
+        bool is_ok() const { return _ok; }
+
+        // Write or read 'nbytes' at byte offset 'ofs' from the calling rank only.
+        void write_at(idx_t ofs, const void* buf, idx_t nbytes) {
+            #ifdef USE_MPI
+            MPI_Status stat;
+            _ok = _ok && MPI_File_write_at(_fh, ofs, buf, int(nbytes),
+                                           MPI_BYTE, &stat) == MPI_SUCCESS;
+            #else
+            _fs.seekp(ofs);
+            _fs.write((const char*)buf, nbytes);
+            _ok = _ok && bool(_fs);
+            #endif
+        }
+        void read_at(idx_t ofs, void* buf, idx_t nbytes) {
+            #ifdef USE_MPI
+            MPI_Status stat;
+            int n = 0;
+            _ok = _ok && MPI_File_read_at(_fh, ofs, buf, int(nbytes),
+                                          MPI_BYTE, &stat) == MPI_SUCCESS &&
+                MPI_Get_count(&stat, MPI_BYTE, &n) == MPI_SUCCESS && n == nbytes;
+            #else
+            _fs.seekg(ofs);
+            _fs.read((char*)buf, nbytes);
+            _ok = _ok && bool(_fs);
+            #endif
+        }
+
+        // Write or read the part in 'box' of a global array at byte
+        // offset 'ofs' on all ranks.
+        void write_box(idx_t ofs, const VarFileBox& box, const void* buf) {
+            _rw_box(ofs, box, (void*)buf, true);
+        }
+        void read_box(idx_t ofs, const VarFileBox& box, void* buf) {
+            _rw_box(ofs, box, buf, false);
+        }
+    };
+
+    // Write vars in 'gps' and metadata to one file shared by all ranks.
+    void StencilContext::_write_shared_checkpoint(const string& fname,
+                                                  const VarPtrs& gps) {
+        STATE_VARS(this);
+        if (actl_opts->_ckpt_codec != "none")
+            THROW_YASK_EXCEPTION("'ckpt_codec' cannot be used with 'mpi_io'");
+        DEBUG_MSG("Writing shared checkpoint to '" << fname << "'...");
+        YaskTimer timer;
+        timer.start();
+
+        // Parts of vars on this rank.
+        size_t nvars = gps.size();
+        vector<VarFileBox> boxes(nvars);
+        for (size_t vi = 0; vi < nvars; vi++)
+            _get_var_file_box(gps[vi], true, 0, boxes[vi]);
+
+        // Make the header, which is the same on all ranks.  It is made
+        // twice: first to find its size, then with the var offsets.
+        vector<idx_t> ofs(nvars, 0);
+        string hdr;
+        for (int pass = 0; pass < 2; pass++) {
+            ostringstream os;
+            os.write(_ckpt_magic.data(), _ckpt_magic.length());
+            _ckpt_write(os, _shared_ckpt_version);
+            _ckpt_write(os, idx_t(hdr.length()));
+            _ckpt_write(os, get_name());
+            _ckpt_write(os, idx_t(get_element_bytes()));
+            _ckpt_write(os, steps_done);
+            _ckpt_write(os, idx_t(nddims));
+            DOMAIN_VAR_LOOP(i, j) {
+                _ckpt_write(os, domain_dims.get_dim_name(j));
+                _ckpt_write(os, actl_opts->_global_sizes[i]);
+            }
+            _ckpt_write(os, idx_t(nvars));
+            for (size_t vi = 0; vi < nvars; vi++) {
+                auto gp = gps[vi];
+                auto& box = boxes[vi];
+                int ndims = gp->get_num_dims();
+                _ckpt_write(os, gp->get_name());
+                _ckpt_write(os, idx_t(ndims));
+                for (int i = 0; i < ndims; i++) {
+                    _ckpt_write(os, gp->gb().get_dim_name(i));
+                    _ckpt_write(os, box.first[i] - box.starts[i]);
+                    _ckpt_write(os, idx_t(box.gsizes[i]));
+                }
+                _ckpt_write(os, ofs[vi]);
+            }
+            hdr = os.str();
+
+            // Set offsets of global arrays.
+            idx_t next_ofs = ROUND_UP(idx_t(hdr.length()), _shared_ckpt_align);
+            for (size_t vi = 0; vi < nvars; vi++) {
+                auto& box = boxes[vi];
+                idx_t nbytes = get_element_bytes();
+                for (auto gs : box.gsizes)
+                    nbytes *= gs;
+                ofs[vi] = next_ofs;
+                next_ofs = ROUND_UP(next_ofs + nbytes, _shared_ckpt_align);
+            }
+        }
+
+        // Make sure host has current data.
+        copy_vars_from_device();
+
+        SharedFile sf;
+        if (!sf.open(env->comm, fname, true))
+            THROW_YASK_EXCEPTION("cannot open checkpoint file '" + fname + "' for writing");
+        if (env->my_rank == 0)
+            sf.write_at(0, hdr.data(), hdr.length());
+
+        // Write each var collectively from a staging buffer.
+        vector<char> buf;
+        size_t nbytes = 0;
+        for (size_t vi = 0; vi < nvars; vi++) {
+            auto gp = gps[vi];
+            auto& box = boxes[vi];
+            buf.resize(box.num_elems * get_element_bytes());
+            if (box.owner) {
+                gp->get_elements_in_slice((void*)buf.data(), box.first, box.last, false);
+                nbytes += buf.size();
+            }
+            sf.write_box(ofs[vi], box, buf.data());
+        }
+        sf.close();
+        if (!sf.is_ok())
+            THROW_YASK_EXCEPTION("error writing checkpoint file '" + fname + "'");
+        timer.stop();
+        DEBUG_MSG(" wrote " << make_byte_str(nbytes) << " of var data from this rank in " <<
+                  make_num_str(timer.get_elapsed_secs()) << " secs");
+    }
+
+    // Read vars and metadata from one file shared by all ranks.
+    // Each rank reads only the part of each global array that overlaps
+    // its own rank domain and outer halos, so the file may have been
+    // written by a different number or layout of ranks.
+    void StencilContext::_read_shared_checkpoint(const string& fname) {
+        STATE_VARS(this);
+        DEBUG_MSG("Reading shared checkpoint from '" << fname << "'...");
+        YaskTimer timer;
+        timer.start();
+
+        SharedFile sf;
+        if (!sf.open(env->comm, fname, false))
+            THROW_YASK_EXCEPTION("cannot open checkpoint file '" + fname + "' for reading");
+
+        // Read header on first rank and broadcast it.
+        idx_t fixed_len = _ckpt_magic.length() + 2 * sizeof(idx_t);
+        string hdr(fixed_len, ' ');
+        idx_t hdr_len = 0;
+        if (env->my_rank == 0) {
+            sf.read_at(0, &hdr[0], fixed_len);
+            if (sf.is_ok() && hdr.substr(0, _ckpt_magic.length()) == _ckpt_magic) {
+                memcpy(&hdr_len, &hdr[fixed_len - sizeof(idx_t)], sizeof(idx_t));
+                if (hdr_len < fixed_len || hdr_len > (1LL << 30))
+                    hdr_len = 0;
+            }
+            if (hdr_len) {
+                hdr.resize(hdr_len);
+                sf.read_at(0, &hdr[0], hdr_len);
+                if (!sf.is_ok())
+                    hdr_len = 0;
+            }
+        }
+        #ifdef USE_MPI
+        MPI_Bcast(&hdr_len, 1, MPI_LONG_LONG, 0, env->comm);
+        #endif
+        if (!hdr_len)
+            THROW_YASK_EXCEPTION("'" + fname + "' is not a shared YASK checkpoint file");
+        hdr.resize(hdr_len);
+        #ifdef USE_MPI
+        MPI_Bcast(&hdr[0], int(hdr_len), MPI_BYTE, 0, env->comm);
+        #endif
+        istringstream is(hdr);
+
+        // Any mismatch is found on all ranks, so the collective close
+        // in the dtor is safe when throwing.
+        is.ignore(_ckpt_magic.length());
+        _ckpt_check(_ckpt_read_idx(is, fname), _shared_ckpt_version, "version", fname);
+        _ckpt_read_idx(is, fname); // header length.
+        _ckpt_check(_ckpt_read_str(is, fname), get_name(), "solution", fname);
+        _ckpt_check(_ckpt_read_idx(is, fname), get_element_bytes(), "element size", fname);
+        idx_t nsteps = _ckpt_read_idx(is, fname);
+        _ckpt_check(_ckpt_read_idx(is, fname), nddims, "number of domain dims", fname);
+        DOMAIN_VAR_LOOP(i, j) {
+            auto& dname = domain_dims.get_dim_name(j);
+            _ckpt_check(_ckpt_read_str(is, fname), dname, "domain dim", fname);
+            _ckpt_check(_ckpt_read_idx(is, fname), actl_opts->_global_sizes[i],
+                        "overall domain size in '" + dname + "'", fname);
+        }
+
+        // Vars.
+        vector<char> buf;
+        size_t nbytes = 0;
+        idx_t nvars = _ckpt_read_idx(is, fname);
+        for (idx_t vi = 0; vi < nvars; vi++) {
+            auto gname = _ckpt_read_str(is, fname);
+            if (!all_var_map.count(gname))
+                THROW_YASK_EXCEPTION("var '" + gname + "' in checkpoint file '" +
+                                     fname + "' not found in solution");
+            auto gp = all_var_map.at(gname);
+            auto& gb = gp->gb();
+            int ndims = gp->get_num_dims();
+            _ckpt_check(_ckpt_read_idx(is, fname), ndims,
+                        "number of dims in var '" + gname + "'", fname);
+            idx_t_vec gfirsts(ndims), gsizes(ndims);
+            for (int i = 0; i < ndims; i++) {
+                _ckpt_check(_ckpt_read_str(is, fname), gb.get_dim_name(i),
+                            "dim in var '" + gname + "'", fname);
+                gfirsts[i] = _ckpt_read_idx(is, fname);
+                gsizes[i] = _ckpt_read_idx(is, fname);
+
+                // Restore first valid step before finding the box.
+                if (gb.get_dim_name(i) == step_dim)
+                    gb.get_corep()->_local_offsets[+step_posn] = gfirsts[i];
+            }
+            idx_t ofs = _ckpt_read_idx(is, fname);
+
+            // Part of var on this rank must be in the same global array.
+            VarFileBox box;
+            _get_var_file_box(gp, true, 0, box);
+            for (int i = 0; i < ndims; i++) {
+                auto& dname = gb.get_dim_name(i);
+                _ckpt_check(gfirsts[i], box.first[i] - box.starts[i],
+                            "first index of '" + dname + "' in var '" + gname + "'", fname);
+                _ckpt_check(gsizes[i], box.gsizes[i],
+                            "size of '" + dname + "' in var '" + gname + "'", fname);
+            }
+
+            // Read collectively and copy into var.
+            // Halos between ranks are filled by the next halo exchange.
+            buf.resize(box.num_elems * get_element_bytes());
+            sf.read_box(ofs, box, buf.data());
+            gp->set_elements_in_slice((const void*)buf.data(), box.first, box.last, false);
+            nbytes += buf.size();
+            gb.get_coh().mod_host();
+            gb.set_dirty_all(YkVarBase::self, true);
+        }
+        steps_done = nsteps;
+        sf.close();
+        if (!sf.is_ok())
+            THROW_YASK_EXCEPTION("error reading checkpoint file '" + fname + "'");
+        timer.stop();
+        DEBUG_MSG(" read " << make_byte_str(nbytes) << " of var data to this rank in " <<
+                  make_num_str(timer.get_elapsed_secs()) << " secs");
+    }
+
+    // Compressed snapshot file format:
+    // - Magic string, codec, rate, element size, and number of elements.
+    // - Number of bytes of encoded data, followed by the data.
+    // All integers are stored as native 'idx_t' values.
+    // Uncompressed snapshot files contain only the elements.
+    static const string _snapshot_magic = "YASKSNPZ";
+
+    // Start the I/O thread.
+    // If using MPI-IO, the thread uses its own communicator, so its
+    // collective calls can't interfere with those of the caller.
+    SnapshotWriter::SnapshotWriter(MPI_Comm comm, bool use_mpi_io,
+                                   int codec, int rate) :
+        _codec(codec), _rate(rate) {
+        #ifdef USE_MPI
+        if (use_mpi_io) {
+            MPI_Comm_dup(comm, &_io_comm);
+            int level = 0;
+            MPI_Query_thread(&level);
+            _sync = level < MPI_THREAD_MULTIPLE;
+        }
+        #endif
+        _thread = thread(&SnapshotWriter::_run, this);
+    }
+
+    // Write any remaining slots and stop the I/O thread.
+    SnapshotWriter::~SnapshotWriter() {
+        {
+            unique_lock<mutex> lk(_mutex);
+            _stop = true;
+        }
+        _cv.notify_all();
+        _thread.join();
+        #ifdef USE_MPI
+        if (_io_comm != MPI_COMM_NULL)
+            MPI_Comm_free(&_io_comm);
+        #endif
+    }
+
+    // Write each var to its own file.
+    string SnapshotWriter::_write_slot(Slot& slot) {
+        string err;
+        for (size_t i = 0; i < slot.fnames.size(); i++) {
+            auto& fname = slot.fnames[i];
+            auto& buf = slot.bufs[i];
+            bool ok = true;
+
+            if (_io_comm != MPI_COMM_NULL) {
+                SharedFile sf;
+                ok = sf.open(_io_comm, fname, true);
+                if (ok) {
+                    sf.write_box(0, slot.boxes[i], buf.data());
+                    sf.close();
+                    ok = sf.is_ok();
+                }
+            }
+            else {
+                ofstream os(fname, ofstream::out | ofstream::trunc | ofstream::binary);
+                if (_codec != codec_none) {
+                    idx_t n = buf.size() / sizeof(real_t);
+                    _encode(_codec, _rate, buf.data(), buf.size(), _zbuf);
+                    os.write(_snapshot_magic.data(), _snapshot_magic.length());
+                    _ckpt_write(os, idx_t(_codec));
+                    _ckpt_write(os, idx_t(_rate));
+                    _ckpt_write(os, idx_t(sizeof(real_t)));
+                    _ckpt_write(os, n);
+                    _ckpt_write(os, idx_t(_zbuf.size()));
+                    os.write(_zbuf.data(), _zbuf.size());
+                }
+                else
+                    os.write(buf.data(), buf.size());
+                os.close();
+                ok = bool(os);
+            }
+            if (!ok && err.empty())
+                err = "error writing snapshot file '" + fname + "'";
+        }
+        return err;
+    }
+
+    // Write slots in the order they were filled.
+    void SnapshotWriter::_run() {
+        int si = 0;
+        while (true) {
+            unique_lock<mutex> lk(_mutex);
+            _cv.wait(lk, [&]{ return _slots[si].full || _stop; });
+            if (!_slots[si].full)
+                return;
+
+            // Write without holding the lock, so computation can
+            // continue filling the other slot.
+            lk.unlock();
+            auto& slot = _slots[si];
+            string err = _write_slot(slot);
+
+            lk.lock();
+            if (_err_msg.empty())
+                _err_msg = err;
+            slot.full = false;
+            lk.unlock();
+            _cv.notify_all();
+            si = (si + 1) % _nslots;
+        }
+    }
+
+    SnapshotWriter::Slot& SnapshotWriter::get_free_slot() {
+        unique_lock<mutex> lk(_mutex);
+        _cv.wait(lk, [&]{ return !_slots[_next_slot].full; });
+        return _slots[_next_slot];
+    }
+
+    void SnapshotWriter::submit(Slot& slot) {
+        if (_sync) {
+            string err = _write_slot(slot);
+            unique_lock<mutex> lk(_mutex);
+            if (_err_msg.empty())
+                _err_msg = err;
+            return;
+        }
+        {
+            unique_lock<mutex> lk(_mutex);
+            slot.full = true;
+            _next_slot = (_next_slot + 1) % _nslots;
+        }
+        _cv.notify_all();
+    }
+
+    void SnapshotWriter::flush() {
+        unique_lock<mutex> lk(_mutex);
+        _cv.wait(lk, [&]{
+                         for (auto& slot : _slots)
+                             if (slot.full)
+                                 return false;
+                         return true;
+                     });
+        if (_err_msg.length()) {
+            string err = _err_msg;
+            _err_msg.clear();
+            THROW_YASK_EXCEPTION(err);
+        }
+    }
+
+    // Find the vars to write and start the writer.
+    // Called from prepare_solution().
+    void StencilContext::_setup_snapshots() {
+        STATE_VARS(this);
+        _snapshot_var_ptrs.clear();
+        for (auto& gname : actl_opts->_snapshot_vars) {
+            if (!all_var_map.count(gname))
+                THROW_YASK_EXCEPTION("var '" + gname + "' in 'snapshot_vars' not found");
+            _snapshot_var_ptrs.push_back(all_var_map.at(gname));
+        }
+        if (_snapshot_var_ptrs.empty())
+            return;
+        if (actl_opts->_snapshot_interval < 1)
+            THROW_YASK_EXCEPTION("'snapshot_interval' must be positive");
+        int codec = _get_codec(actl_opts->_snapshot_codec, "snapshot_codec");
+        if (codec != codec_none && actl_opts->_mpi_io)
+            THROW_YASK_EXCEPTION("'snapshot_codec' cannot be used with 'mpi_io'");
+        if (codec == codec_fixed &&
+            (actl_opts->_snapshot_rate < 2 || actl_opts->_snapshot_rate > 32))
+            THROW_YASK_EXCEPTION("'snapshot_rate' must be between 2 and 32");
+        if (!_snapshot_writer)
+            _snapshot_writer = make_shared<SnapshotWriter>(env->comm, actl_opts->_mpi_io,
+                                                           codec, actl_opts->_snapshot_rate);
+
+        // Hooks cannot be removed, so add only one.
+        if (!_snapshot_hook_added) {
+            _after_run_solution_hooks.push_back([this](yk_solution& soln,
+                                                       idx_t first_step_index,
+                                                       idx_t last_step_index) {
+                                                    _take_snapshot(first_step_index,
+                                                                   last_step_index);
+                                                });
+            _snapshot_hook_added = true;
+        }
+        DEBUG_MSG("Writing snapshots of " << _snapshot_var_ptrs.size() <<
+                  " var(s) every " << actl_opts->_snapshot_interval << " step(s)");
+    }
+
+    // Copy the rank domain of each snapshot var at the last step written
+    // by run_solution() into a staging slot. The I/O thread writes it
+    // while the next steps are computed.
+    void StencilContext::_take_snapshot(idx_t first_step_index,
+                                        idx_t last_step_index) {
+        STATE_VARS(this);
+        if (!_snapshot_writer || _snapshot_var_ptrs.empty())
+            return;
+
+        // Step index of the last values written.
+        idx_t step = (last_step_index >= first_step_index) ?
+            last_step_index + 1 : last_step_index - 1;
+        if (step % actl_opts->_snapshot_interval != 0)
+            return;
+        TRACE_MSG("taking snapshot at step " << step);
+
+        // This will wait if both slots are still being written.
+        auto& slot = _snapshot_writer->get_free_slot();
+        size_t nvars = _snapshot_var_ptrs.size();
+        slot.step = step;
+        slot.fnames.resize(nvars);
+        slot.bufs.resize(nvars);
+        slot.boxes.resize(nvars);
+        for (size_t vi = 0; vi < nvars; vi++) {
+            auto gp = _snapshot_var_ptrs[vi];
+            auto& box = slot.boxes[vi];
+            _get_var_file_box(gp, false, step, box);
+
+            // Copy to staging buffer.
+            // Buffer keeps its capacity between snapshots.
+            slot.bufs[vi].resize(box.num_elems * get_element_bytes());
+            if (box.owner || !actl_opts->_mpi_io)
+                gp->get_elements_in_slice((void*)slot.bufs[vi].data(),
+                                          box.first, box.last, false);
+            slot.fnames[vi] = _get_snapshot_file_name(gp->get_name(), step);
+        }
+        _snapshot_writer->submit(slot);
+    }
+
+    // Wait for the writer.
+    void StencilContext::flush_snapshots() {
+        if (_snapshot_writer)
+            _snapshot_writer->flush();
+    }
+
+    // Name of the file for 'var_name' at 'step'.
+    string StencilContext::_get_snapshot_file_name(const string& var_name,
+                                                   idx_t step) const {
+        STATE_VARS_CONST(this);
+        return get_rank_file_name(actl_opts->_snapshot_prefix + "." + var_name +
+                                  ".t" + to_string(step)) + ".dat";
+    }
+
+    // Read a snapshot file written by this rank (or all ranks with MPI-IO)
+    // back into the var.
+    void StencilContext::read_snapshot(const string& var_name, idx_t step_index) {
+        STATE_VARS(this);
+        if (!is_prepared())
+            THROW_YASK_EXCEPTION("read_snapshot() called without calling prepare_solution() first");
+        if (!all_var_map.count(var_name))
+            THROW_YASK_EXCEPTION("read_snapshot(): var '" + var_name + "' not found");
+        auto gp = all_var_map.at(var_name);
+        auto& gb = gp->gb();
+
+        // Make sure pending writes are done.
+        flush_snapshots();
+        auto fname = _get_snapshot_file_name(var_name, step_index);
+        TRACE_MSG("reading snapshot from '" << fname << "'");
+
+        // Part of var to read.
+        VarFileBox box;
+        _get_var_file_box(gp, false, step_index, box);
+        if (gp->is_dim_used(step_dim))
+            box.first[+step_posn] = box.last[+step_posn] = step_index;
+        vector<char> buf(box.num_elems * get_element_bytes());
+
+        if (actl_opts->_mpi_io) {
+            SharedFile sf;
+            if (!sf.open(env->comm, fname, false))
+                THROW_YASK_EXCEPTION("cannot open snapshot file '" + fname + "' for reading");
+            sf.read_box(0, box, buf.data());
+            sf.close();
+            if (!sf.is_ok())
+                THROW_YASK_EXCEPTION("error reading snapshot file '" + fname + "'");
+        }
+        else {
+            ifstream is(fname, ifstream::in | ifstream::binary);
+            if (!is)
+                THROW_YASK_EXCEPTION("cannot open snapshot file '" + fname + "' for reading");
+            string magic(_snapshot_magic.length(), ' ');
+            is.read(&magic[0], magic.length());
+
+            // Compressed.
+            if (is && magic == _snapshot_magic) {
+                idx_t codec = _ckpt_read_idx(is, fname);
+                idx_t rate = _ckpt_read_idx(is, fname);
+                _ckpt_check(_ckpt_read_idx(is, fname), get_element_bytes(), "element size", fname);
+                _ckpt_check(_ckpt_read_idx(is, fname), box.num_elems, "number of elements", fname);
+                idx_t nstored = _ckpt_read_idx(is, fname);
+                vector<char> zbuf(max(nstored, idx_t(0)));
+                is.read(zbuf.data(), zbuf.size());
+                if (!is || (codec != codec_xor && codec != codec_fixed) ||
+                    (codec == codec_fixed && (rate < 2 || rate > 32)) ||
+                    !_decode(codec, rate, zbuf.data(), zbuf.size(), buf.data(),
+                             box.num_elems * sizeof(real_t)))
+                    THROW_YASK_EXCEPTION("corrupt snapshot file '" + fname + "'");
+            }
+
+            // Raw.
+            else {
+                is.clear();
+                is.seekg(0, ifstream::end);
+                _ckpt_check(idx_t(is.tellg()), idx_t(buf.size()), "number of bytes", fname);
+                is.seekg(0);
+                is.read(buf.data(), buf.size());
+                if (!is)
+                    THROW_YASK_EXCEPTION("error reading snapshot file '" + fname + "'");
+            }
+        }
+        gp->set_elements_in_slice((const void*)buf.data(), box.first, box.last, false);
+        gb.get_coh().mod_host();
+        gb.set_dirty_all(YkVarBase::self, true);
+    }
+
+} // namespace yask.
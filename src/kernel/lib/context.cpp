@@ -55,6 +55,7 @@ namespace yask {
         // Disable offload.
         bool save_offload = KernelEnv::_use_offload;
         KernelEnv::_use_offload = false;
+        _start_reductions(last_step_index);
 
         // Determine step dir from order of first/last.
         idx_t step_dir = (last_step_index >= first_step_index) ? 1 : -1;
@@ -208,6 +209,7 @@ namespace yask {
 
         // Final halo exchange.
         exchange_halos();
+        _finish_reductions();
 
         run_time.stop();
 
@@ -232,6 +234,8 @@ namespace yask {
         // Since any APIs may have been called in other ranks, mark all
         // neighbor vars as possibly dirty.
         set_all_neighbor_vars_dirty();
+        _sync_node_shared_vars();
+        _start_reductions(last_step_index);
 
         // Determine step dir from order of first/last.
         idx_t step_dir = (last_step_index >= first_step_index) ? 1 : -1;
@@ -341,6 +345,13 @@ namespace yask {
             // Make sure threads are set properly for a mega-block.
             set_num_outer_threads();
 
+            // Blocks must be statically assigned to outer threads
+            // to match the NUMA placement of slabs.
+            if (_outer_thread_numa_nodes.size())
+                omp_set_schedule(omp_sched_static, 0);
+            else
+                omp_set_schedule(omp_sched_dynamic, 1);
+
             // Initial halo exchange.
             MpiSection mpisec(this);
             exchange_halos(mpisec);
@@ -613,7 +624,8 @@ namespace yask {
             #endif
 
         } // Something to do.
-        
+        _finish_reductions();
+
         // Stop timer.
         run_time.stop();
 
@@ -623,6 +635,97 @@ namespace yask {
 
     } // run_solution().
 
+    // Prepare the stencil parts to accumulate fused reductions
+    // when evaluating 'last_step_index'.
+    void StencilContext::_start_reductions(idx_t last_step_index) {
+        STATE_VARS(this);
+        _red_active = false;
+        bool any_reds = false;
+        for (auto* sp : st_parts)
+            if (sp->red_var_names.size())
+                any_reds = true;
+        if (!any_reds)
+            return;
+
+        #ifdef USE_OFFLOAD
+        THROW_YASK_EXCEPTION("fused reductions are not supported with offload");
+        #endif
+
+        // Make a slot for every thread that may call a part. Slots are
+        // indexed by outer * num_inner_threads + inner, both for the
+        // nested threads used by calc_nano_block() and for the flat
+        // threads used by calc_in_domain(), which use inner index 0.
+        int nouter = max(max(actl_opts->max_threads, 1),
+                         max(omp_get_max_threads(), yask_get_num_threads()));
+        int nthr = nouter * max(actl_opts->num_inner_threads, 1);
+        for (auto* sp : st_parts)
+            sp->reset_reductions(nthr);
+        _red_results.clear();
+        _red_step = last_step_index;
+        _red_active = true;
+    }
+
+    // Combine the fused reductions across parts, threads, and ranks.
+    void StencilContext::_finish_reductions() {
+        STATE_VARS(this);
+        if (!_red_active)
+            return;
+        _red_active = false;
+
+        // Join across parts and threads. A var may be written by
+        // more than one part, e.g., under different sub-domain
+        // conditions.
+        for (auto* sp : st_parts) {
+            for (size_t ri = 0; ri < sp->red_var_names.size(); ri++) {
+                auto& rp = _red_results[sp->red_var_names[ri]];
+                if (!rp)
+                    rp = make_shared<YkVarBase::red_res>();
+                sp->join_reductions(ri, *rp);
+            }
+        }
+
+        // Join across ranks. The map has the same keys on all ranks.
+        #ifdef USE_MPI
+        if (env->num_ranks > 1) {
+            size_t nr = _red_results.size();
+            vector<double> sums(nr * 3), mins(nr), maxs(nr);
+            size_t i = 0;
+            for (auto& rr : _red_results) {
+                sums[i * 3] = rr.second->_sum;
+                sums[i * 3 + 1] = rr.second->_sum_sq;
+                sums[i * 3 + 2] = double(rr.second->_nred);
+                mins[i] = rr.second->_min;
+                maxs[i] = rr.second->_max;
+                i++;
+            }
+            MPI_Allreduce(MPI_IN_PLACE, sums.data(), nr * 3, MPI_DOUBLE, MPI_SUM, env->comm);
+            MPI_Allreduce(MPI_IN_PLACE, mins.data(), nr, MPI_DOUBLE, MPI_MIN, env->comm);
+            MPI_Allreduce(MPI_IN_PLACE, maxs.data(), nr, MPI_DOUBLE, MPI_MAX, env->comm);
+            i = 0;
+            for (auto& rr : _red_results) {
+                rr.second->_sum = sums[i * 3];
+                rr.second->_sum_sq = sums[i * 3 + 1];
+                rr.second->_nred = idx_t(sums[i * 3 + 2]);
+                rr.second->_min = mins[i];
+                rr.second->_max = maxs[i];
+                i++;
+            }
+        }
+        #endif
+    }
+
+    // Get a fused reduction from the last run.
+    yk_var::yk_reduction_result_ptr
+    StencilContext::get_reduction_result(const string& var_name) const {
+        auto it = _red_results.find(var_name);
+        if (it == _red_results.end())
+            THROW_YASK_EXCEPTION("get_reduction_result(): no reductions of var '" +
+                                 var_name + "' are available; the var must be written by "
+                                 "an equation with reductions, and run_solution() must "
+                                 "be called first");
+        return it->second;
+    }
+
     // Calculate results within a mega-block.  Each mega-block is typically computed
     // via a separate OpenMP 'for' region.  In this function, we loop over
     // the time steps and stages and evaluate a stage in each of
@@ -644,6 +747,9 @@ namespace yask {
         else
             int_time.start();
 
+        // Start reading file-backed vars for the next mega-block.
+        _prefetch_mmap_vars(rank_idxs);
+
         // Init mega-block begin & end from rank start & stop indices.
         ScanIndices mega_block_idxs = rank_idxs.create_inner();
 
@@ -1543,6 +1649,35 @@ namespace yask {
             errs += gb.compare(rgbp);
         }
 
+        // Fused reductions from the last step.
+        for (auto& rr : ref._red_results) {
+            auto it = _red_results.find(rr.first);
+            if (it == _red_results.end()) {
+                TRACE_MSG("** reductions of '" << rr.first << "' not found");
+                errs++;
+                continue;
+            }
+            auto& r = *rr.second;
+            auto& v = *it->second;
+            bool ok = v._nred == r._nred &&
+                within_tolerance(v._sum, r._sum, EPSILON) &&
+                within_tolerance(v._sum_sq, r._sum_sq, EPSILON) &&
+                (!(r._mask & yk_var::yk_min_reduction) ||
+                 within_tolerance(v._min, r._min, EPSILON)) &&
+                (!(r._mask & yk_var::yk_max_reduction) ||
+                 within_tolerance(v._max, r._max, EPSILON));
+            if (!ok) {
+                DEBUG_MSG("** mismatch in reductions of '" << rr.first << "': " <<
+                          v._nred << " elements, sum " << v._sum <<
+                          ", sum of squares " << v._sum_sq <<
+                          ", min " << v._min << ", max " << v._max <<
+                          " != reference " << r._nred << " elements, sum " << r._sum <<
+                          ", sum of squares " << r._sum_sq <<
+                          ", min " << r._min << ", max " << r._max);
+                errs++;
+            }
+        }
+
         return errs;
     }
 
@@ -196,6 +196,76 @@ namespace yask {
         get_elapsed_secs() { return run_time; }
     };
 
+    // Part of a var held by this rank and its position in the global
+    // array stored in a shared file.
+    struct VarFileBox {
+        Indices first, last;    // var indices of the part on this rank.
+        idx_t num_elems = 1;    // number of elements in the part.
+        std::vector<int> gsizes, lsizes, starts; // sizes of global array and part, and offsets of part.
+        bool owner = true;      // false if another rank writes the same data.
+    };
+
+    // Writes buffers to files from a dedicated I/O thread, so that
+    // snapshots can be written while the next steps are computed.  There
+    // are two staging slots, so one can be filled while the other is
+    // being written.
+    class SnapshotWriter {
+    public:
+
+        // Data for one snapshot: one buffer and file per var.
+        struct Slot {
+            idx_t step = 0;
+            string_vec fnames;
+            std::vector<std::vector<char>> bufs;
+            std::vector<VarFileBox> boxes;
+            bool full = false;
+        };
+
+    protected:
+        static constexpr int _nslots = 2;
+        Slot _slots[_nslots];
+        int _next_slot = 0;     // next slot to fill.
+        std::mutex _mutex;      // protects all members below and 'full' flags.
+        std::condition_variable _cv;
+        bool _stop = false;
+        std::string _err_msg;   // first I/O error, if any.
+        std::thread _thread;
+
+        // Communicator used only by the I/O thread for MPI-IO, or
+        // MPI_COMM_NULL to write one file per rank.
+        MPI_Comm _io_comm = MPI_COMM_NULL;
+
+        // Write from the calling thread if MPI can't be called from
+        // the I/O thread.
+        bool _sync = false;
+
+        // Codec and bits per value used to compress per-rank files.
+        int _codec = 0, _rate = 0;
+        std::vector<char> _zbuf; // used only by the writing thread.
+
+        // Main loop of the I/O thread.
+        void _run();
+
+        // Write one slot. Returns error message or empty string.
+        std::string _write_slot(Slot& slot);
+
+    public:
+        SnapshotWriter(MPI_Comm comm, bool use_mpi_io,
+                       int codec, int rate);
+        virtual ~SnapshotWriter();
+
+        // Wait until the next slot is free and return it.
+        Slot& get_free_slot();
+
+        // Queue 'slot' for writing.
+        void submit(Slot& slot);
+
+        // Wait until all queued slots are written.
+        // Throw an exception if any write failed.
+        void flush();
+    };
+    typedef std::shared_ptr<SnapshotWriter> SnapshotWriterPtr;
+
     // Things in a context.
     class StencilPartBase;
     class Stage;
@@ -213,6 +283,9 @@ namespace yask {
         Indices _rank_sizes;
         Indices _rank_domain_offsets;
 
+        // Whether streaming stores may be used. Set by update_var_info().
+        bool _use_streaming = true;
+
         void set_core(const StencilContext *cxt);
     };
 
@@ -245,6 +318,112 @@ namespace yask {
         virtual void _alloc_data(AllocMap& alloc_reqs,
                                  const std::string& type);
 
+        // Names of vars shared by all ranks on this node.
+        std::set<std::string> _node_shared_var_names;
+        virtual void _setup_node_shared_vars();
+
+        // Make writes to shared vars by any rank on this node
+        // visible to the other ranks.
+        virtual void _sync_node_shared_vars();
+
+        // NUMA node of each outer thread.
+        // Set only when a var uses the yask_numa_slabs policy.
+        std::vector<int> _outer_thread_numa_nodes;
+        virtual void _find_outer_thread_numa_nodes();
+
+        // Find the outer thread that computes a rank-relative index in
+        // the first domain dim.
+        int _get_outer_thread_of_index(idx_t x, int nthr) const;
+
+        // Layout of a var's storage in slabs along the first domain dim.
+        struct VarSlabLayout {
+            char* base = 0;         // start of var storage.
+            size_t elem_bytes = 0;  // bytes in one layout element.
+            idx_t stride = 0;       // layout stride of the slab dim.
+            idx_t vlen = 1;         // vec len of the slab dim.
+            idx_t first_idx = 0;    // rank-relative index of first slab.
+            idx_t nslabs = 0;       // layout size of the slab dim.
+            std::vector<idx_t> outer_ofs; // offset of each outer slice, e.g., step.
+        };
+        bool _get_var_slab_layout(YkVarPtr gp, VarSlabLayout& sl) const;
+
+        // Visit slabs of a var's storage with the outer thread that
+        // computes each one.
+        typedef std::function<void (char* p, size_t nbytes, int owner)> slab_visitor_t;
+        bool _visit_var_slabs(YkVarPtr gp, int nthr,
+                              slab_visitor_t visitor) const;
+
+        // Vars stored in memory-mapped files.
+        VarPtrs _mmap_var_ptrs;
+
+        // Start reading the slabs of the memory-mapped vars that are
+        // needed by the mega-block after the one in 'mb_idxs'.
+        virtual void _prefetch_mmap_vars(const ScanIndices& mb_idxs);
+
+        // Bind pages of a var to the NUMA nodes of the outer threads
+        // that compute them.
+        virtual void _bind_numa_slabs(YkVarPtr gp);
+
+        // First-touch pages from the outer threads that use them.
+        virtual void _first_touch_vars(const VarPtrs& gps);
+        virtual void _first_touch_scratch_vars();
+
+        // Snapshots written after run_solution().
+        SnapshotWriterPtr _snapshot_writer;
+        VarPtrs _snapshot_var_ptrs;
+        bool _snapshot_hook_added = false;
+
+        // Get the part of 'gp' held by this rank.  If 'is_ckpt', all
+        // valid steps and halos outside the overall domain are included.
+        // Otherwise, only 'step' and the domain are included.
+        virtual void _get_var_file_box(YkVarPtr gp, bool is_ckpt,
+                                       idx_t step, VarFileBox& box) const;
+
+        // Write a checkpoint of the vars in 'gps'.
+        virtual void _write_checkpoint(const std::string& file_name,
+                                       const VarPtrs& gps);
+
+        // Write or read a checkpoint in one file shared by all ranks.
+        virtual void _write_shared_checkpoint(const std::string& fname,
+                                              const VarPtrs& gps);
+        virtual void _read_shared_checkpoint(const std::string& fname);
+
+        // Start the snapshot writer if any vars are requested.
+        virtual void _setup_snapshots();
+
+        // Copy the snapshot vars into a staging slot to be written.
+        virtual void _take_snapshot(idx_t first_step_index,
+                                    idx_t last_step_index);
+
+        // Saved states used by run_reverse().
+        struct RevSlot {
+            idx_t step = 0;     // step index at which state was saved.
+            std::string fname;  // checkpoint file, or empty to save in memory.
+            std::vector<std::vector<char>> bufs; // raw storage of each var in '_rev_var_ptrs'.
+            idx_t_vec first_steps; // first valid step of each var.
+            idx_t steps_done = 0;
+        };
+        std::vector<RevSlot> _rev_slots;
+        VarPtrs _rev_var_ptrs;  // vars in each state.
+        idx_t _rev_cur_step = -1; // step of current state if same as a slot.
+        idx_t _rev_nsteps = 0;    // forward steps computed.
+        virtual void _rev_save(int slot, idx_t step);
+        virtual void _rev_restore(int slot);
+        virtual void _rev_sweep(idx_t first, idx_t end, int slot,
+                                hook_fn_2idx_t& adjoint_fn);
+
+        // Fused reductions accumulated by the stencil parts during the
+        // last step of run_solution() or run_ref().
+        bool _red_active = false;
+        idx_t _red_step = 0;
+        std::map<std::string, std::shared_ptr<YkVarBase::red_res>> _red_results;
+        virtual void _start_reductions(idx_t last_step_index);
+        virtual void _finish_reductions();
+
+        // Name of snapshot file for this rank.
+        virtual std::string _get_snapshot_file_name(const std::string& var_name,
+                                                    idx_t step) const;
+
         // Callbacks.
         typedef std::vector<hook_fn_t> hook_fn_vec;
         hook_fn_vec _before_prepare_solution_hooks;
@@ -498,6 +677,12 @@ namespace yask {
         void run_ref(idx_t first_step_index,
                      idx_t last_step_index);
 
+        // Whether fused reductions should be accumulated when
+        // evaluating step 't'.
+        bool is_reduction_step(idx_t t) const {
+            return _red_active && t == _red_step;
+        }
+
         // Calculate results within a mega-block.
         void calc_mega_block(StagePtr& sel_bp,
                              const ScanIndices& rank_idxs,
@@ -708,6 +893,16 @@ namespace yask {
             run_solution(step_index, step_index);
         }
         virtual void fuse_vars(yk_solution_ptr other);
+        virtual void write_checkpoint(const std::string& file_name);
+        virtual void read_checkpoint(const std::string& file_name);
+        virtual void flush_snapshots();
+        virtual void read_snapshot(const std::string& var_name,
+                                   idx_t step_index);
+        virtual yk_var::yk_reduction_result_ptr
+        get_reduction_result(const std::string& var_name) const;
+
+        // Get name of checkpoint or snapshot file for this rank.
+        virtual std::string get_rank_file_name(const std::string& file_name) const;
 
         // APIs that access settings.
         #define GET_SOLN_API(api_name) \
@@ -774,6 +969,10 @@ namespace yask {
         call_after_run_solution(hook_fn_2idx_t hook_fn) {
             _after_run_solution_hooks.push_back(hook_fn);
         }
+        virtual void
+        run_reverse(idx_t first_step_index,
+                    idx_t last_step_index,
+                    hook_fn_2idx_t adjoint_fn);
 
         // Auto-tuner methods.
         virtual void eval_auto_tuner();
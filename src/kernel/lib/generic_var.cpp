@@ -202,5 +202,7 @@ namespace yask {
     // Explicitly allowed instantiations.
     template class GenericVarTyped<real_t>;
     template class GenericVarTyped<real_vec_t>;
+    template class GenericVarTyped<uint8_t>;
+    template class GenericVarTyped<uint16_t>;
 
 } // yask namespace.
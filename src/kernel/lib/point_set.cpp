@@ -0,0 +1,318 @@
+/*****************************************************************************
+
+YASK: Yet Another Stencil Kit
+Copyright (c) 2014-2023, Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to
+deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*****************************************************************************/
+
+// This file contains implementations of YkPointSet methods for
+// injecting values into and extracting values from a var at a batch of
+// arbitrary (off-grid) points, e.g., for seismic sources and receivers.
+
+#include "yask_stencil.hpp"
+using namespace std;
+
+namespace yask {
+
+    // Radius and shape of the windowed-sinc interpolator.
+    // Beta is the value recommended by Hicks (2002) for radius 4.
+    constexpr int _sinc_radius = 4;
+    constexpr double _kaiser_beta = 6.31;
+
+    // Modified Bessel function of the first kind, order 0.
+    static double _bessel_i0(double x) {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 32; k++) {
+            double h = x / (2.0 * k);
+            term *= h * h;
+            sum += term;
+        }
+        return sum;
+    }
+
+    // Set indices and weights of the elements used to interpolate
+    // at 'pos' in one dim.
+    static void _get_interp_weights(double pos, int interp_type,
+                                    vector<idx_t>& idxs,
+                                    vector<double>& wts) {
+        idxs.clear();
+        wts.clear();
+        if (interp_type == yk_var::yk_nearest_interp) {
+            idxs.push_back(idx_t(floor(pos + 0.5)));
+            wts.push_back(1.0);
+        }
+        else if (interp_type == yk_var::yk_linear_interp) {
+            idx_t i0 = idx_t(floor(pos));
+            double f = pos - double(i0);
+            idxs.push_back(i0);
+            wts.push_back(1.0 - f);
+            idxs.push_back(i0 + 1);
+            wts.push_back(f);
+        }
+        else {
+            idx_t i0 = idx_t(floor(pos));
+            const double i0b = _bessel_i0(_kaiser_beta);
+            for (idx_t i = i0 - _sinc_radius + 1; i <= i0 + _sinc_radius; i++) {
+                double d = pos - double(i);
+                double s = (d == 0.0) ? 1.0 : sin(M_PI * d) / (M_PI * d);
+                double u = d / _sinc_radius;
+                double win = (u * u < 1.0) ?
+                    _bessel_i0(_kaiser_beta * sqrt(1.0 - u * u)) / i0b : 0.0;
+                idxs.push_back(i);
+                wts.push_back(s * win);
+            }
+        }
+    }
+
+    // APIs to make a point set.
+    yk_var::yk_point_set_ptr
+    YkVarImpl::new_point_set(const vector<double>& coords,
+                             int interp_type) {
+        return make_shared<YkPointSet>(_gbp, coords, interp_type);
+    }
+
+    // Compute the elements and weights for each point that are in this
+    // rank's domain. This is done once so that injection and extraction
+    // at each step are simple gathers and scatters.
+    YkPointSet::YkPointSet(const VarBasePtr& gbp,
+                           const vector<double>& coords,
+                           int interp_type) :
+        _var(gbp) {
+        STATE_VARS(_var.gbp());
+        auto& gb = _var.gb();
+        if (!_var.is_storage_allocated())
+            THROW_YASK_EXCEPTION("call to 'new_point_set' with no storage allocated for var '" +
+                                 _var.get_name() + "'");
+
+        // Elements are accessed directly as reals.
+        if (!gb.has_real_elems())
+            THROW_YASK_EXCEPTION("call to 'new_point_set' on material-index var '" +
+                                 _var.get_name() + "'; only vars of reals are supported");
+        if (interp_type != yk_var::yk_nearest_interp &&
+            interp_type != yk_var::yk_linear_interp &&
+            interp_type != yk_var::yk_sinc_interp)
+            FORMAT_AND_THROW_YASK_EXCEPTION("call to 'new_point_set' with unknown interpolation type " <<
+                                            interp_type);
+        for (int k = 0; k < _var.get_num_dims(); k++) {
+            auto& dname = _var.get_dim_name(k);
+            if (misc_dims.lookup(dname))
+                THROW_YASK_EXCEPTION("call to 'new_point_set' on var '" + _var.get_name() +
+                                     "' with misc dim '" + dname + "'");
+        }
+        if (coords.size() % nddims != 0)
+            FORMAT_AND_THROW_YASK_EXCEPTION("call to 'new_point_set' with " << coords.size() <<
+                                            " coordinates, which is not a multiple of " <<
+                                            nddims << " domain dims");
+        _npts = coords.size() / nddims;
+
+        // Var position and local range of each domain dim.
+        // A domain dim not in the var gets index 0 and full weight.
+        vector<int> posns(nddims, -1);
+        vector<idx_t> firsts(nddims, 0), lasts(nddims, 0);
+        DOMAIN_VAR_LOOP(i, j) {
+            auto& dname = domain_dims.get_dim_name(j);
+            posns[j] = gb.get_dim_posn(dname);
+            if (posns[j] >= 0) {
+                firsts[j] = _var.get_first_rank_domain_index(dname);
+                lasts[j] = _var.get_last_rank_domain_index(dname);
+            }
+        }
+
+        // Elements at allocated step 0 and 1 are a fixed distance apart.
+        auto* base = (real_t*)gb.get_storage();
+        Indices idxs(gb.get_num_dims());
+        idxs.set_from_const(0);
+        for (int j = 0; j < nddims; j++)
+            if (posns[j] >= 0)
+                idxs[posns[j]] = firsts[j];
+        if (gb._has_step_dim && _var.get_alloc_size(step_dim) > 1)
+            _step_stride = gb.get_elem_ptr(idxs, 1, false) - gb.get_elem_ptr(idxs, 0, false);
+
+        // Per-point entries.
+        vector<vector<idx_t>> didxs(nddims);
+        vector<vector<double>> dwts(nddims);
+        vector<size_t> ctr(nddims);
+        _pt_begin.assign(_npts + 1, 0);
+        for (idx_t p = 0; p < _npts; p++) {
+            bool is_local = true;
+            for (int j = 0; j < nddims; j++) {
+                if (posns[j] < 0) {
+                    didxs[j].assign(1, 0);
+                    dwts[j].assign(1, 1.0);
+                }
+                else {
+                    _get_interp_weights(coords[p * nddims + j], interp_type,
+                                        didxs[j], dwts[j]);
+
+                    // Quick reject if no element is in this rank.
+                    if (didxs[j].back() < firsts[j] || didxs[j].front() > lasts[j])
+                        is_local = false;
+                }
+            }
+            idx_t nents = 0;
+            if (is_local) {
+
+                // Visit all combinations of the per-dim elements.
+                ctr.assign(nddims, 0);
+                while (true) {
+                    double w = 1.0;
+                    bool ok = true;
+                    for (int j = 0; j < nddims; j++) {
+                        w *= dwts[j][ctr[j]];
+                        if (posns[j] >= 0) {
+                            idx_t ix = didxs[j][ctr[j]];
+                            if (ix < firsts[j] || ix > lasts[j])
+                                ok = false;
+                            idxs[posns[j]] = ix;
+                        }
+                    }
+                    if (ok && w != 0.0) {
+                        _pt_offsets.push_back(gb.get_elem_ptr(idxs, 0, false) - base);
+                        _pt_weights.push_back(real_t(w));
+                        nents++;
+                    }
+
+                    // Next combination.
+                    int j = nddims - 1;
+                    for (; j >= 0; j--) {
+                        if (++ctr[j] < didxs[j].size())
+                            break;
+                        ctr[j] = 0;
+                    }
+                    if (j < 0)
+                        break;
+                }
+            }
+            _pt_begin[p + 1] = _pt_begin[p] + nents;
+            if (nents)
+                _nlocal++;
+        }
+
+        // Group the entries by element.
+        idx_t ne = _pt_offsets.size();
+        vector<idx_t> pts(ne), order(ne);
+        for (idx_t p = 0; p < _npts; p++)
+            for (idx_t e = _pt_begin[p]; e < _pt_begin[p + 1]; e++)
+                pts[e] = p;
+        for (idx_t e = 0; e < ne; e++)
+            order[e] = e;
+        stable_sort(order.begin(), order.end(),
+                    [&](idx_t a, idx_t b) { return _pt_offsets[a] < _pt_offsets[b]; });
+        for (idx_t k = 0; k < ne; k++) {
+            idx_t e = order[k];
+            if (k == 0 || _pt_offsets[e] != _elem_offsets.back()) {
+                _elem_offsets.push_back(_pt_offsets[e]);
+                _elem_begin.push_back(k);
+            }
+            _elem_pts.push_back(pts[e]);
+            _elem_weights.push_back(_pt_weights[e]);
+        }
+        _elem_begin.push_back(ne);
+
+        DEBUG_MSG("Point set on var '" << _var.get_name() << "' has " <<
+                  _npts << " point(s), " << _nlocal << " in this rank, updating " <<
+                  _elem_offsets.size() << " element(s)");
+    }
+
+    // Get storage for 'step_index'.
+    real_t* YkPointSet::_get_base(idx_t step_index, idx_t& alloc_step_idx) const {
+        auto& gb = _var.gb();
+        alloc_step_idx = 0;
+        if (gb._has_step_dim) {
+            if (step_index < _var.get_first_valid_step_index() ||
+                step_index > _var.get_last_valid_step_index())
+                FORMAT_AND_THROW_YASK_EXCEPTION("point-set access to var '" << _var.get_name() <<
+                                                "' at step " << step_index <<
+                                                ", which is not in the valid range " <<
+                                                _var.get_first_valid_step_index() << "..." <<
+                                                _var.get_last_valid_step_index());
+            alloc_step_idx = gb._wrap_step(step_index);
+        }
+        auto* base = (real_t*)gb.get_storage();
+        if (!base)
+            THROW_YASK_EXCEPTION("point-set access to var '" + _var.get_name() +
+                                 "' with no storage allocated");
+        return base + alloc_step_idx * _step_stride;
+    }
+
+    // Add weighted values to the elements around each point.
+    idx_t YkPointSet::add_to_elements(const double* vals,
+                                      idx_t step_index) {
+        auto& gb = _var.gb();
+        idx_t asi = 0;
+        real_t* p = _get_base(step_index, asi);
+        idx_t ne = _elem_offsets.size();
+        if (!ne)
+            return 0;
+
+        #ifdef USE_OFFLOAD_NO_USM
+        if (gb._coh.need_to_update_host())
+            gb.copy_data_from_device(); // TODO: make more efficient.
+        #endif
+
+        // Each element is updated by one thread, so no atomics are needed.
+        yask_parallel_for(0, ne, 256,
+                          [&](idx_t start, idx_t stop, idx_t thread_num) {
+                              for (idx_t k = start; k < stop; k++) {
+                                  double sum = 0.0;
+                                  for (idx_t e = _elem_begin[k]; e < _elem_begin[k + 1]; e++)
+                                      sum += _elem_weights[e] * vals[_elem_pts[e]];
+                                  p[_elem_offsets[k]] += real_t(sum);
+                              }
+                          });
+
+        // Set appropriate dirty flags.
+        gb._coh.mod_host();
+        gb.set_dirty_using_alloc_index(YkVarBase::self, true, asi);
+        return ne;
+    }
+
+    // Interpolate values at each point. Each point is in the domain of
+    // zero or more ranks, so partial sums are combined across ranks.
+    void YkPointSet::get_elements(double* vals,
+                                  idx_t step_index) const {
+        STATE_VARS_CONST(_var.gbp());
+        auto& gb = _var.gb();
+        idx_t asi = 0;
+        const real_t* p = _get_base(step_index, asi);
+
+        #ifdef USE_OFFLOAD_NO_USM
+        if (gb._coh.need_to_update_host())
+            gb.const_copy_data_from_device(); // TODO: make more efficient.
+        #endif
+
+        yask_parallel_for(0, _npts, 256,
+                          [&](idx_t start, idx_t stop, idx_t thread_num) {
+                              for (idx_t i = start; i < stop; i++) {
+                                  double sum = 0.0;
+                                  for (idx_t e = _pt_begin[i]; e < _pt_begin[i + 1]; e++)
+                                      sum += _pt_weights[e] * p[_pt_offsets[e]];
+                                  vals[i] = sum;
+                              }
+                          });
+
+        #ifdef USE_MPI
+        if (env->num_ranks > 1)
+            MPI_Allreduce(MPI_IN_PLACE, vals, _npts, MPI_DOUBLE, MPI_SUM, env->comm);
+        #endif
+    }
+
+} // namespace yask.
@@ -152,7 +152,8 @@ namespace yask {
         for (int i=0; i<VLEN; i++)
     #endif
 
-    // fence needed before loads after streaming stores.
+    // fence needed before loads after streaming stores
+    // from real_vec_t::stream_to().
     ALWAYS_INLINE void make_stores_visible() {
         #if defined(USE_STREAMING_STORE)
         _mm_mfence();
@@ -492,16 +493,50 @@ namespace yask {
         ALWAYS_INLINE void store_to(real_vec_t* __restrict to) const {
 
             #if defined(NO_INTRINSICS) || defined(NO_STORE_INTRINSICS)
-            #if (VLEN > 1) && defined(USE_STREAMING_STORE)
+            REAL_VEC_LOOP(i) (*to)[i] = u.r[i];
+            #else
+            INAME(store)((imem_t*)to, u.mr);
+            #endif
+            check_stored_value(to);
+        }
+
+        // aligned streaming store from 'this'.
+        // Same as store_to() unless USE_STREAMING_STORE is defined
+        // and 'use_stream' is true.
+        // Call make_stores_visible() before the values are read.
+        ALWAYS_INLINE void stream_to(real_vec_t* __restrict to,
+                                     bool use_stream = true) const {
+
+            #if !defined(USE_STREAMING_STORE)
+            store_to(to);
+            #else
+            if (!use_stream) {
+                store_to(to);
+                return;
+            }
+            #if defined(NO_INTRINSICS) || defined(NO_STORE_INTRINSICS)
+            #if (VLEN > 1)
             _VEC_STREAMING
                 #endif
                 REAL_VEC_LOOP(i) (*to)[i] = u.r[i];
-            #elif !defined(USE_STREAMING_STORE)
-            INAME(store)((imem_t*)to, u.mr);
             #else
             INAME(stream)((imem_t*)to, u.mr);
             #endif
             check_stored_value(to);
+            #endif
+        }
+
+        // No masked streaming stores, so only a full
+        // mask uses a streaming store.
+        ALWAYS_INLINE void stream_to_masked(real_vec_t* __restrict to, uidx_t k1,
+                                            bool use_stream = true) const {
+            #if defined(USE_STREAMING_STORE)
+            constexpr uidx_t full_mask = (VLEN >= 64) ? ~uidx_t(0) : ((uidx_t(1) << VLEN) - 1);
+            if (use_stream && (k1 & full_mask) == full_mask)
+                stream_to(to);
+            else
+            #endif
+                store_to_masked(to, k1);
         }
         ALWAYS_INLINE void store_to_masked(real_vec_t* __restrict to, uidx_t k1) const {
 
@@ -702,22 +737,107 @@ namespace yask {
         }
     #endif
 
+    // Inline SIMD approximations selected by 'YASK_VEC_MATH', which is
+    // set by the stencil compiler. The level of each function can be
+    // overridden w/'YASK_VEC_MATH_<FN>'; 0 uses the SVML or libm version.
+    // Only available w/AVX2 or AVX-512 integer ops.
+    #if !defined(NO_INTRINSICS) && (defined(USE_AVX2) || defined(USE_AVX512)) && \
+        defined(YASK_VEC_MATH) && (YASK_VEC_MATH > 0)
+    #define USE_VEC_MATH
+    #include "realv_math.hpp"
+    #define VEC_MATH_1ARG(yask_fn, svml_fn, libm_dpfn, libm_spfn, vm_fn) \
+        SVML_1ARG_SCALAR(yask_fn, libm_dpfn, libm_spfn)                 \
+        ALWAYS_INLINE real_vec_t yask_fn(const real_vec_t& a) {         \
+            real_vec_t res;                                             \
+            res.u.mr = vm_fn(a.u.mr);                                   \
+            return res;                                                 \
+        }
+    #ifndef YASK_VEC_MATH_SQRT
+    #define YASK_VEC_MATH_SQRT YASK_VEC_MATH
+    #endif
+    #ifndef YASK_VEC_MATH_CBRT
+    #define YASK_VEC_MATH_CBRT YASK_VEC_MATH
+    #endif
+    #ifndef YASK_VEC_MATH_FABS
+    #define YASK_VEC_MATH_FABS YASK_VEC_MATH
+    #endif
+    #ifndef YASK_VEC_MATH_ERF
+    #if (YASK_VEC_MATH == 2) && (REAL_BYTES == 4)
+    #define YASK_VEC_MATH_ERF 2
+    #else
+    #define YASK_VEC_MATH_ERF 0 // inline version is not accurate enough.
+    #endif
+    #endif
+    #ifndef YASK_VEC_MATH_EXP
+    #define YASK_VEC_MATH_EXP YASK_VEC_MATH
+    #endif
+    #ifndef YASK_VEC_MATH_LOG
+    #define YASK_VEC_MATH_LOG YASK_VEC_MATH
+    #endif
+    #ifndef YASK_VEC_MATH_SIN
+    #define YASK_VEC_MATH_SIN YASK_VEC_MATH
+    #endif
+    #ifndef YASK_VEC_MATH_COS
+    #define YASK_VEC_MATH_COS YASK_VEC_MATH
+    #endif
+    #ifndef YASK_VEC_MATH_ATAN
+    #define YASK_VEC_MATH_ATAN YASK_VEC_MATH
+    #endif
+    #endif
+
     // Use safe sqrt when running checked code to avoid NaNs.
     // In production usage, it is the responsibility of the user
     // to guarantee that the arguments to sqrt() are non-negative.
-    #ifdef CHECK
+    // The SIMD version uses the HW instruction at any level.
+    #if defined(USE_VEC_MATH) && YASK_VEC_MATH_SQRT && defined(CHECK)
+    VEC_MATH_1ARG(yask_sqrt, sqrt_abs, sqrt_abs, sqrt_absf, vm_sqrt_abs) // square root.
+    #elif defined(USE_VEC_MATH) && YASK_VEC_MATH_SQRT
+    VEC_MATH_1ARG(yask_sqrt, sqrt, sqrt, sqrtf, vm_sqrt) // square root.
+    #elif defined(CHECK)
     SVML_1ARG(yask_sqrt, sqrt_abs, sqrt_abs, sqrt_absf) // square root.
     #else
     SVML_1ARG(yask_sqrt, sqrt, sqrt, sqrtf) // square root.
     #endif
+    #if defined(USE_VEC_MATH) && YASK_VEC_MATH_CBRT
+    VEC_MATH_1ARG(yask_cbrt, cbrt, cbrt, cbrtf, vm_cbrt<YASK_VEC_MATH_CBRT>) // cube root.
+    #else
     SVML_1ARG(yask_cbrt, cbrt, cbrt, cbrtf) // cube root.
+    #endif
+    #if defined(USE_VEC_MATH) && YASK_VEC_MATH_FABS
+    VEC_MATH_1ARG(yask_fabs, abs, fabs, fabsf, vm_fabs) // abs value.
+    #else
     SVML_1ARG(yask_fabs, abs, fabs, fabsf) // abs value.
+    #endif
+    #if defined(USE_VEC_MATH) && YASK_VEC_MATH_ERF
+    VEC_MATH_1ARG(yask_erf, erf, erf, erff, vm_erf<YASK_VEC_MATH_ERF>) // error fn.
+    #else
     SVML_1ARG(yask_erf, erf, erf, erff) // error fn.
+    #endif
+    #if defined(USE_VEC_MATH) && YASK_VEC_MATH_EXP
+    VEC_MATH_1ARG(yask_exp, exp, exp, expf, vm_exp<YASK_VEC_MATH_EXP>) // natural exp.
+    #else
     SVML_1ARG(yask_exp, exp, exp, expf) // natural exp.
+    #endif
+    #if defined(USE_VEC_MATH) && YASK_VEC_MATH_LOG
+    VEC_MATH_1ARG(yask_log, log, log, logf, vm_log<YASK_VEC_MATH_LOG>) // natural log.
+    #else
     SVML_1ARG(yask_log, log, log, logf) // natural log.
+    #endif
+    #if defined(USE_VEC_MATH) && YASK_VEC_MATH_SIN
+    VEC_MATH_1ARG(yask_sin, sin, sin, sinf, vm_sin<YASK_VEC_MATH_SIN>) // sine.
+    #else
     SVML_1ARG(yask_sin, sin, sin, sinf) // sine.
+    #endif
+    #if defined(USE_VEC_MATH) && YASK_VEC_MATH_COS
+    VEC_MATH_1ARG(yask_cos, cos, cos, cosf, vm_cos<YASK_VEC_MATH_COS>) // cosine.
+    #else
     SVML_1ARG(yask_cos, cos, cos, cosf) // cosine.
+    #endif
+    #if defined(USE_VEC_MATH) && YASK_VEC_MATH_ATAN
+    VEC_MATH_1ARG(yask_atan, atan, atan, atanf, vm_atan<YASK_VEC_MATH_ATAN>) // inv (arc) tangent.
+    #else
     SVML_1ARG(yask_atan, atan, atan, atanf) // inv (arc) tangent.
+    #endif
     SVML_2ARG(yask_pow, pow, pow, powf) // power.
     SVML_2ARG(yask_min, min, std::min, std::min) // min.
     SVML_2ARG(yask_max, max, std::max, std::max) // max.
@@ -725,6 +845,7 @@ namespace yask {
     #undef SVML_1ARG
     #undef SVML_2ARG_SCALAR
     #undef SVML_2ARG
+    #undef VEC_MATH_1ARG
 
     // Sin+cos.
     ALWAYS_INLINE void yask_sin_and_cos(real_t& sin_res, real_t& cos_res, real_t a) {
@@ -740,7 +861,9 @@ namespace yask {
     ALWAYS_INLINE void yask_sin_and_cos(real_vec_t& sin_res,
                                         real_vec_t& cos_res,
                                         const real_vec_t& a) {
-        #if defined(NO_INTRINSICS) || defined(NO_SVML)
+        #if defined(USE_VEC_MATH) && YASK_VEC_MATH_SIN && YASK_VEC_MATH_COS
+        vm_sin_cos<YASK_VEC_MATH_SIN>(a.u.mr, sin_res.u.mr, cos_res.u.mr);
+        #elif defined(NO_INTRINSICS) || defined(NO_SVML)
         REAL_VEC_LOOP(i) yask_sin_and_cos(sin_res[i], cos_res[i], a[i]);
         #else
         sin_res.u.mr = INAME(sincos)(&cos_res.u.mr, a.u.mr);
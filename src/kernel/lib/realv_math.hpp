@@ -0,0 +1,346 @@
+/*****************************************************************************
+
+YASK: Yet Another Stencil Kit
+Copyright (c) 2014-2023, Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to
+deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*****************************************************************************/
+
+// This file defines inline SIMD approximations of math functions using
+// AVX2 or AVX-512 intrinsics. It is included from realv.hpp inside the
+// 'yask' namespace when 'YASK_VEC_MATH' > 0.
+// The template arg 'level' selects the accuracy:
+// 1: polynomials long enough to give errors near the precision of 'real_t'.
+// 2: shorter polynomials w/relative errors up to about 1e-4 for floats and
+//    1e-8 for doubles.
+// erf() is only accurate enough for level 2 w/floats; see vm_erf().
+// To keep them short and branch-free, these functions do not handle
+// special values: args to exp() are clamped to the range that gives normal
+// results, args to log() must be positive normal numbers, and the range
+// reduction in sin() and cos() loses accuracy for very large args.
+
+#pragma once
+
+    // Casts, int constants, and compares for each vector type.
+    #if defined(USE_INTRIN512)
+    #if REAL_BYTES == 4
+    #define VM_AS_INT(a) _mm512_castps_si512(a)
+    #define VM_AS_REAL(a) _mm512_castsi512_ps(a)
+    #define VM_SET1I(v) _mm512_set1_epi32(v)
+    #define VM_CMP_MASK(a, b, c) _mm512_cmp_ps_mask(a, b, c)
+    #define VM_TEST_MASK(a, b) _mm512_test_epi32_mask(a, b)
+    #else
+    #define VM_AS_INT(a) _mm512_castpd_si512(a)
+    #define VM_AS_REAL(a) _mm512_castsi512_pd(a)
+    #define VM_SET1I(v) _mm512_set1_epi64(v)
+    #define VM_CMP_MASK(a, b, c) _mm512_cmp_pd_mask(a, b, c)
+    #define VM_TEST_MASK(a, b) _mm512_test_epi64_mask(a, b)
+    #endif
+    #else
+    #if REAL_BYTES == 4
+    #define VM_AS_INT(a) _mm256_castps_si256(a)
+    #define VM_AS_REAL(a) _mm256_castsi256_ps(a)
+    #define VM_SET1I(v) _mm256_set1_epi32(v)
+    #else
+    #define VM_AS_INT(a) _mm256_castpd_si256(a)
+    #define VM_AS_REAL(a) _mm256_castsi256_pd(a)
+    #define VM_SET1I(v) _mm256_set1_epi64x(v)
+    #endif
+    #endif
+
+    // Layout of 'real_t'.
+    #if REAL_BYTES == 4
+    typedef ::int32_t vm_int_t;
+    constexpr int vm_mant_bits = 23;
+    constexpr vm_int_t vm_exp_bias = 127;
+    #else
+    typedef ::int64_t vm_int_t;
+    constexpr int vm_mant_bits = 52;
+    constexpr vm_int_t vm_exp_bias = 1023;
+    #endif
+    constexpr int vm_int_bits = REAL_BYTES * 8;
+
+    // 2^vm_mant_bits: adding it to a small non-negative int puts the int
+    // in the low mantissa bits.
+    constexpr real_t vm_two_m = real_t(vm_int_t(1) << vm_mant_bits);
+
+    ALWAYS_INLINE simd_t vm_set1(real_t v) {
+        return INAME(set1)(v);
+    }
+
+    // 'a * b + c'.
+    ALWAYS_INLINE simd_t vm_fma(simd_t a, simd_t b, simd_t c) {
+        #ifdef __FMA__
+        return INAME(fmadd)(a, b, c);
+        #else
+        return INAME(add)(INAME(mul)(a, b), c);
+        #endif
+    }
+
+    // 'a < b ? x : y' in each lane.
+    ALWAYS_INLINE simd_t vm_select_lt(simd_t a, simd_t b, simd_t x, simd_t y) {
+        #if defined(USE_INTRIN512)
+        return INAME(mask_blend)(VM_CMP_MASK(a, b, _CMP_LT_OQ), y, x);
+        #else
+        return INAME(blendv)(y, x, INAME(cmp)(a, b, _CMP_LT_OQ));
+        #endif
+    }
+
+    // '(bits & (1 << bit)) ? x : y' in each lane.
+    ALWAYS_INLINE simd_t vm_select_bit(isimd_t bits, int bit, simd_t x, simd_t y) {
+        #if defined(USE_INTRIN512)
+        return INAME(mask_blend)(VM_TEST_MASK(bits, VM_SET1I(vm_int_t(1) << bit)), y, x);
+        #else
+        // 'blendv' uses the sign bit of the selector.
+        return INAME(blendv)(y, x, VM_AS_REAL(INAMEI(slli)(bits, vm_int_bits - 1 - bit)));
+        #endif
+    }
+
+    // Negate 'a' in lanes where bit 'bit' of 'bits' is set.
+    ALWAYS_INLINE simd_t vm_negate_bit(simd_t a, isimd_t bits, int bit) {
+
+        // Move 'bit' to the sign bit and add it, i.e., flip the sign.
+        auto sign = INAMEI(slli)(INAMEI(srli)(bits, bit), vm_int_bits - 1);
+        return VM_AS_REAL(INAMEI(add)(VM_AS_INT(a), sign));
+    }
+
+    // Convert small non-negative ints to reals.
+    ALWAYS_INLINE simd_t vm_small_int_to_real(isimd_t i) {
+        return INAME(sub)(VM_AS_REAL(INAMEI(add)(i, VM_AS_INT(vm_set1(vm_two_m)))),
+                          vm_set1(vm_two_m));
+    }
+
+    // Evaluate 'c[0] + c[1] * x + ... + c[n-1] * x^(n-1)'.
+    ALWAYS_INLINE simd_t vm_poly(simd_t x, const real_t* c, int n) {
+        simd_t p = vm_set1(c[n - 1]);
+        for (int i = n - 2; i >= 0; i--)
+            p = vm_fma(p, x, vm_set1(c[i]));
+        return p;
+    }
+
+    ALWAYS_INLINE simd_t vm_fabs(simd_t a) {
+        return INAME(max)(a, INAME(sub)(INAME(setzero)(), a));
+    }
+
+    ALWAYS_INLINE simd_t vm_sqrt(simd_t a) {
+        return INAME(sqrt)(a);
+    }
+
+    ALWAYS_INLINE simd_t vm_sqrt_abs(simd_t a) {
+        return INAME(sqrt)(vm_fabs(a));
+    }
+
+    // exp(a) = 2^n * exp(r), where n = round(a / ln(2)) and
+    // r = a - n * ln(2), |r| <= ln(2) / 2.
+    template <int level>
+    ALWAYS_INLINE simd_t vm_exp(simd_t a) {
+        const real_t c[] = { 1., 1., 1./2., 1./6., 1./24., 1./120., 1./720.,
+                             1./5040., 1./40320., 1./362880., 1./3628800.,
+                             1./39916800., 1./479001600., 1./6227020800. };
+        #if REAL_BYTES == 4
+        const real_t lo = -87.3, hi = 88.;
+        const real_t ln2_hi = 0.693359375, ln2_lo = -2.12194440e-4;
+        const int nc = (level == 1) ? 8 : 5;
+        #else
+        const real_t lo = -708.3, hi = 709.;
+        const real_t ln2_hi = 6.93147180369123816490e-01, ln2_lo = 1.90821492927058770002e-10;
+        const int nc = (level == 1) ? 14 : 8;
+        #endif
+        a = INAME(min)(INAME(max)(a, vm_set1(lo)), vm_set1(hi));
+
+        // Adding 'shifter' rounds to an int and leaves 'n' + exponent
+        // bias in the low mantissa bits of 't'.
+        const real_t shifter = real_t(1.5) * vm_two_m + real_t(vm_exp_bias);
+        simd_t t = vm_fma(a, vm_set1(M_LOG2E), vm_set1(shifter));
+        simd_t n = INAME(sub)(t, vm_set1(shifter));
+        simd_t r = vm_fma(n, vm_set1(-ln2_hi), a);
+        r = vm_fma(n, vm_set1(-ln2_lo), r);
+        simd_t p = vm_poly(r, c, nc);
+
+        // Make 2^n by shifting the biased 'n' into the exponent.
+        simd_t s = VM_AS_REAL(INAMEI(slli)(VM_AS_INT(t), vm_mant_bits));
+        return INAME(mul)(p, s);
+    }
+
+    // log(a) = k * ln(2) + log(z), where a = 2^k * z, sqrt(1/2) <= z <
+    // sqrt(2), and log(z) = 2 * atanh(s), s = (z - 1) / (z + 1).
+    template <int level>
+    ALWAYS_INLINE simd_t vm_log(simd_t a) {
+        const real_t c[] = { 1., 1./3., 1./5., 1./7., 1./9., 1./11.,
+                             1./13., 1./15., 1./17., 1./19., 1./21. };
+        #if REAL_BYTES == 4
+        const vm_int_t zoff = 0x3f3504f3; // sqrt(1/2).
+        const vm_int_t kbias = 128;
+        const real_t ln2_hi = 0.693359375, ln2_lo = -2.12194440e-4;
+        const int nc = (level == 1) ? 5 : 3;
+        #else
+        const vm_int_t zoff = 0x3fe6a09e667f3bcdLL; // sqrt(1/2).
+        const vm_int_t kbias = 1024;
+        const real_t ln2_hi = 6.93147180369123816490e-01, ln2_lo = 1.90821492927058770002e-10;
+        const int nc = (level == 1) ? 11 : 5;
+        #endif
+
+        // Get 'k' + 'kbias' from the exponent of 'a' / sqrt(1/2).
+        // 'kbias' keeps the difference non-negative for all normal 'a'.
+        auto ia = VM_AS_INT(a);
+        auto kb = VM_SET1I(kbias << vm_mant_bits);
+        auto ik = INAMEI(srli)(INAMEI(add)(INAMEI(sub)(ia, VM_SET1I(zoff)), kb),
+                               vm_mant_bits);
+        simd_t k = INAME(sub)(vm_small_int_to_real(ik), vm_set1(real_t(kbias)));
+
+        // Remove 'k' from the exponent to get 'z'.
+        simd_t z = VM_AS_REAL(INAMEI(add)(INAMEI(sub)(ia, INAMEI(slli)(ik, vm_mant_bits)), kb));
+        simd_t one = vm_set1(1.);
+        simd_t s = INAME(div)(INAME(sub)(z, one), INAME(add)(z, one));
+        simd_t s2 = INAME(mul)(s, s);
+        simd_t p = INAME(mul)(INAME(add)(s, s), vm_poly(s2, c, nc));
+        return vm_fma(k, vm_set1(ln2_hi), vm_fma(k, vm_set1(ln2_lo), p));
+    }
+
+    // cbrt(a) = sign(a) * exp(log(|a|) / 3), w/a Newton step at level 1.
+    template <int level>
+    ALWAYS_INLINE simd_t vm_cbrt(simd_t a) {
+        simd_t x = vm_fabs(a);
+        simd_t y = vm_exp<level>(INAME(mul)(vm_log<level>(x), vm_set1(real_t(1.) / 3.)));
+        if (level == 1) {
+            simd_t y2 = INAME(mul)(y, y);
+            y = INAME(mul)(vm_fma(y, vm_set1(2.), INAME(div)(x, y2)), vm_set1(real_t(1.) / 3.));
+        }
+        y = vm_select_lt(x, vm_set1(std::numeric_limits<real_t>::min()), INAME(setzero)(), y);
+        return vm_select_lt(a, INAME(setzero)(), INAME(sub)(INAME(setzero)(), y), y);
+    }
+
+    // sin(a) and cos(a) from r = a - n * pi/2, |r| <= pi/4, and the
+    // quadrant n mod 4.
+    template <int level>
+    ALWAYS_INLINE void vm_sin_cos(simd_t a, simd_t& sin_res, simd_t& cos_res) {
+        const real_t cs[] = { -1./6., 1./120., -1./5040., 1./362880., -1./39916800.,
+                              1./6227020800., -1./1307674368000., 1./355687428096000. };
+        const real_t cc[] = { 1., -1./2., 1./24., -1./720., 1./40320., -1./3628800.,
+                              1./479001600., -1./87178291200., 1./20922789888000. };
+        #if REAL_BYTES == 4
+        const real_t pio2_1 = 1.5703125, pio2_2 = 4.837512969970703125e-4,
+            pio2_3 = 7.54978995489188216e-8;
+        const int ns = (level == 1) ? 4 : 2;
+        const int nc = (level == 1) ? 5 : 4;
+        #else
+        const real_t pio2_1 = 1.57079632673412561417e+00, pio2_2 = 6.07710050630396597660e-11,
+            pio2_3 = 2.02226624879595063154e-21;
+        const int ns = (level == 1) ? 8 : 4;
+        const int nc = (level == 1) ? 9 : 6;
+        #endif
+
+        // Adding 'shifter' rounds to an int and leaves 'n' mod 4 in the
+        // low bits of 't'.
+        const real_t shifter = real_t(1.5) * vm_two_m;
+        simd_t t = vm_fma(a, vm_set1(M_2_PI), vm_set1(shifter));
+        simd_t n = INAME(sub)(t, vm_set1(shifter));
+        simd_t r = vm_fma(n, vm_set1(-pio2_1), a);
+        r = vm_fma(n, vm_set1(-pio2_2), r);
+        r = vm_fma(n, vm_set1(-pio2_3), r);
+        simd_t r2 = INAME(mul)(r, r);
+        simd_t sr = vm_fma(INAME(mul)(r, r2), vm_poly(r2, cs, ns), r);
+        simd_t cr = vm_poly(r2, cc, nc);
+
+        // Quadrant 0: (sin, cos) = (sr, cr); 1: (cr, -sr);
+        // 2: (-sr, -cr); 3: (-cr, sr).
+        auto q = VM_AS_INT(t);
+        sin_res = vm_negate_bit(vm_select_bit(q, 0, cr, sr), q, 1);
+        auto q1 = INAMEI(add)(q, VM_SET1I(1));
+        cos_res = vm_negate_bit(vm_select_bit(q, 0, sr, cr), q1, 1);
+    }
+    template <int level>
+    ALWAYS_INLINE simd_t vm_sin(simd_t a) {
+        simd_t s, c;
+        vm_sin_cos<level>(a, s, c);
+        return s;
+    }
+    template <int level>
+    ALWAYS_INLINE simd_t vm_cos(simd_t a) {
+        simd_t s, c;
+        vm_sin_cos<level>(a, s, c);
+        return c;
+    }
+
+    // atan(a) = sign(a) * (y0 + atan(t)), where y0 is 0, pi/4, or pi/2
+    // and |t| <= tan(pi/8).
+    template <int level>
+    ALWAYS_INLINE simd_t vm_atan(simd_t a) {
+        #if REAL_BYTES == 4
+        const int nc = (level == 1) ? 7 : 4;
+        #else
+        const int nc = (level == 1) ? 19 : 9;
+        #endif
+        simd_t zero = INAME(setzero)();
+        simd_t one = vm_set1(1.);
+        simd_t x = vm_fabs(a);
+
+        // x > tan(pi/8): atan(x) = pi/4 + atan((x - 1) / (x + 1)).
+        simd_t t_mid = INAME(div)(INAME(sub)(x, one), INAME(add)(x, one));
+        simd_t t = vm_select_lt(vm_set1(0.414213562373095048802), x, t_mid, x);
+        simd_t y0 = vm_select_lt(vm_set1(0.414213562373095048802), x, vm_set1(M_PI_4), zero);
+
+        // x > tan(3pi/8): atan(x) = pi/2 + atan(-1 / x).
+        simd_t t_hi = INAME(div)(vm_set1(-1.), x);
+        t = vm_select_lt(vm_set1(2.41421356237309504880), x, t_hi, t);
+        y0 = vm_select_lt(vm_set1(2.41421356237309504880), x, vm_set1(M_PI_2), y0);
+
+        // atan(t) = t - t^3/3 + t^5/5 - ...
+        simd_t t2 = INAME(mul)(t, t);
+        simd_t p = vm_set1((((nc - 1) % 2) ? 1. : -1.) / real_t(2 * nc + 1));
+        for (int i = nc - 2; i >= 0; i--)
+            p = vm_fma(p, t2, vm_set1(((i % 2) ? 1. : -1.) / real_t(2 * i + 3)));
+        simd_t y = INAME(add)(y0, vm_fma(INAME(mul)(t, t2), p, t));
+        return vm_select_lt(a, zero, INAME(sub)(zero, y), y);
+    }
+
+    // erf(a) from Abramowitz & Stegun 7.1.26 (max abs error 1.5e-7) for
+    // |a| >= 1/2 and from its Taylor series for |a| < 1/2, where the
+    // former has large relative errors. That meets level 2 for floats
+    // only, so realv.hpp uses the SVML or libm version otherwise unless
+    // 'YASK_VEC_MATH_ERF' is 2.
+    template <int level>
+    ALWAYS_INLINE simd_t vm_erf(simd_t a) {
+        static_assert(level == 2, "no inline erf() accurate enough for level 1");
+        const real_t c[] = { 0., 0.254829592, -0.284496736, 1.421413741,
+                             -1.453152027, 1.061405429 };
+
+        // 2/sqrt(pi) * (-1)^n / (n! * (2n + 1)).
+        const real_t cs[] = { 1.12837916709551257390, -0.37612638903183752463,
+                              0.11283791670955125739, -0.02686617064513125176,
+                              0.00522397762544218784, -0.00085483270234508387,
+                              0.00012055332981789664 };
+        simd_t zero = INAME(setzero)();
+        simd_t one = vm_set1(1.);
+        simd_t x = vm_fabs(a);
+        simd_t x2 = INAME(mul)(x, x);
+        simd_t t = INAME(div)(one, vm_fma(x, vm_set1(0.3275911), one));
+        simd_t e = vm_exp<level>(INAME(sub)(zero, x2));
+        simd_t y = INAME(sub)(one, INAME(mul)(vm_poly(t, c, 6), e));
+        simd_t ys = INAME(mul)(x, vm_poly(x2, cs, 7));
+        y = vm_select_lt(x, vm_set1(0.5), ys, y);
+        return vm_select_lt(a, zero, INAME(sub)(zero, y), y);
+    }
+
+    #undef VM_AS_INT
+    #undef VM_AS_REAL
+    #undef VM_SET1I
+    #undef VM_CMP_MASK
+    #undef VM_TEST_MASK
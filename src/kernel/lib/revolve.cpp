@@ -0,0 +1,210 @@
+/*****************************************************************************
+
+YASK: Yet Another Stencil Kit
+Copyright (c) 2014-2023, Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to
+deal in the Software without restriction, including without limitation the
+rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+IN THE SOFTWARE.
+
+*****************************************************************************/
+
+// This file contains implementations of StencilContext methods for
+// visiting the steps of a forward run in reverse order using binomial
+// ("revolve") checkpointing.
+
+#include "yask_stencil.hpp"
+using namespace std;
+
+namespace yask {
+
+    // Max number of steps that can be reversed with 's' free states and
+    // 't' forward sweeps: binomial(s + t, s).  Saturates instead of
+    // overflowing.
+    static idx_t _revolve_beta(idx_t s, idx_t t) {
+        idx_t b = 1;
+        for (idx_t i = 1; i <= s; i++) {
+            if (b > idx_t(1) << 40)
+                return idx_t(1) << 50;
+            b = b * (t + i) / i; // exact: b is binomial(t + i, i).
+        }
+        return b;
+    }
+
+    // Save the current state of the vars in '_rev_var_ptrs' in 'slot'.
+    void StencilContext::_rev_save(int slot, idx_t step) {
+        STATE_VARS(this);
+        auto& rs = _rev_slots.at(slot);
+        rs.step = step;
+        _rev_cur_step = step;
+        if (!rs.fname.empty()) {
+            _write_checkpoint(rs.fname, _rev_var_ptrs);
+            return;
+        }
+
+        // Copy raw storage and valid steps of each var.
+        copy_vars_from_device();
+        size_t nvars = _rev_var_ptrs.size();
+        rs.bufs.resize(nvars);
+        rs.first_steps.resize(nvars);
+        for (size_t vi = 0; vi < nvars; vi++) {
+            auto gp = _rev_var_ptrs[vi];
+            auto* p = (const char*)gp->get_raw_storage_buffer();
+            idx_t nbytes = p ? gp->get_num_storage_bytes() : 0;
+            rs.bufs[vi].assign(p, p + nbytes);
+            rs.first_steps[vi] = gp->is_dim_used(step_dim) ?
+                gp->gb().get_corep()->_local_offsets[+step_posn] : 0;
+        }
+        rs.steps_done = steps_done;
+    }
+
+    // Make the state of the vars in '_rev_var_ptrs' the same as when
+    // 'slot' was saved. Other vars are not changed.
+    void StencilContext::_rev_restore(int slot) {
+        STATE_VARS(this);
+        auto& rs = _rev_slots.at(slot);
+        if (_rev_cur_step == rs.step)
+            return;
+        _rev_cur_step = rs.step;
+        if (!rs.fname.empty()) {
+            read_checkpoint(rs.fname);
+            return;
+        }
+        for (size_t vi = 0; vi < _rev_var_ptrs.size(); vi++) {
+            auto gp = _rev_var_ptrs[vi];
+            auto& gb = gp->gb();
+            auto* p = (char*)gp->get_raw_storage_buffer();
+            auto& buf = rs.bufs[vi];
+            if (p)
+                memcpy(p, buf.data(), buf.size());
+            if (gp->is_dim_used(step_dim))
+                gb.get_corep()->_local_offsets[+step_posn] = rs.first_steps[vi];
+            gb.get_coh().mod_host();
+            gb.set_dirty_all(YkVarBase::self, true);
+        }
+        steps_done = rs.steps_done;
+    }
+
+    // Call 'adjoint_fn' for each step in ['first', 'end') in reverse order,
+    // given that the state before step 'first' is saved in 'slot'.  Each
+    // segment is split where a new state is saved so that the number of
+    // steps recomputed is minimal for the free slots (Griewank & Walther,
+    // "Algorithm 799: revolve").
+    void StencilContext::_rev_sweep(idx_t first, idx_t end, int slot,
+                                    hook_fn_2idx_t& adjoint_fn) {
+        idx_t nsteps = end - first;
+        idx_t nfree = idx_t(_rev_slots.size()) - slot - 1;
+        assert(nsteps > 0);
+
+        // One step: just call the function.
+        if (nsteps == 1) {
+            _rev_restore(slot);
+            adjoint_fn(*this, first, first);
+            _rev_cur_step = -1; // function may have changed the vars.
+            return;
+        }
+
+        // No free slots: recompute from 'first' for each step.
+        if (nfree == 0) {
+            for (idx_t i = end - 1; i >= first; i--) {
+                _rev_restore(slot);
+                if (i > first) {
+                    run_solution(first, i - 1);
+                    _rev_nsteps += i - first;
+                }
+                adjoint_fn(*this, i, i);
+                _rev_cur_step = -1;
+            }
+            return;
+        }
+
+        // Find min number of sweeps needed, then split so that the
+        // right part can be reversed with one fewer slot and the left
+        // part with one fewer sweep.
+        idx_t nsweeps = 1;
+        while (_revolve_beta(nfree, nsweeps) < nsteps)
+            nsweeps++;
+        idx_t mid = first + max(idx_t(1), nsteps - _revolve_beta(nfree - 1, nsweeps));
+        assert(mid > first && mid < end);
+
+        // Advance to 'mid', save it, and do the right part.
+        _rev_restore(slot);
+        run_solution(first, mid - 1);
+        _rev_nsteps += mid - first;
+        _rev_save(slot + 1, mid);
+        _rev_sweep(mid, end, slot + 1, adjoint_fn);
+
+        // Then do the left part.
+        _rev_sweep(first, mid, slot, adjoint_fn);
+    }
+
+    // Run forward from 'first_step_index' to 'last_step_index' while
+    // calling 'adjoint_fn' for each step in reverse order.
+    void StencilContext::run_reverse(idx_t first_step_index,
+                                     idx_t last_step_index,
+                                     hook_fn_2idx_t adjoint_fn) {
+        STATE_VARS(this);
+        if (!is_prepared())
+            THROW_YASK_EXCEPTION("run_reverse() called without calling prepare_solution() first");
+        if (last_step_index < first_step_index)
+            THROW_YASK_EXCEPTION("run_reverse() requires first_step_index <= last_step_index");
+        idx_t nmem = actl_opts->_rev_mem_states;
+        idx_t ndisk = actl_opts->_rev_disk_states;
+        if (nmem < 0 || ndisk < 0 || nmem + ndisk < 1)
+            THROW_YASK_EXCEPTION("'rev_mem_states' + 'rev_disk_states' must be at least one");
+
+        // Vars in each state. By default, only those updated by the
+        // stencils are needed to recompute the forward steps.
+        _rev_var_ptrs.clear();
+        for (auto& gname : actl_opts->_rev_vars) {
+            if (!all_var_map.count(gname))
+                THROW_YASK_EXCEPTION("var '" + gname + "' in 'rev_vars' not found");
+            _rev_var_ptrs.push_back(all_var_map.at(gname));
+        }
+        if (_rev_var_ptrs.empty())
+            _rev_var_ptrs = output_var_ptrs;
+
+        // States in memory are used for the outer slots, which are
+        // saved once and restored most often.
+        _rev_slots.clear();
+        _rev_slots.resize(nmem + ndisk);
+        for (idx_t i = nmem; i < nmem + ndisk; i++)
+            _rev_slots[i].fname = actl_opts->_rev_state_prefix + ".state" + to_string(i - nmem);
+        idx_t nsteps = last_step_index - first_step_index + 1;
+        DEBUG_MSG("Reversing " << nsteps << " step(s) using " << nmem <<
+                  " state(s) in memory and " << ndisk << " on disk...");
+        YaskTimer timer;
+        timer.start();
+
+        _rev_nsteps = 0;
+        _rev_cur_step = -1;
+        _rev_save(0, first_step_index);
+        _rev_sweep(first_step_index, last_step_index + 1, 0, adjoint_fn);
+
+        // Free the states.
+        for (auto& rs : _rev_slots)
+            if (!rs.fname.empty())
+                unlink(get_rank_file_name(rs.fname).c_str());
+        _rev_slots.clear();
+        _rev_var_ptrs.clear();
+        timer.stop();
+        DEBUG_MSG(" computed " << _rev_nsteps << " forward step(s) (" <<
+                  make_num_str(double(_rev_nsteps) / nsteps) << " per step) in " <<
+                  make_num_str(timer.get_elapsed_secs()) << " secs");
+    }
+
+} // namespace yask.
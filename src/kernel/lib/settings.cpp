@@ -367,6 +367,13 @@ namespace yask {
                            "[Advanced] Allow automatic extension of padding"
                            " beyond minimal vector alignment on any or all YASK vars.",
                            _allow_addl_pad));
+        parser.add_option(make_shared<command_line_parser::idx_option>
+                          ("cache_conflict_bytes",
+                           "[Advanced] Size of one way of the L1 data cache in bytes,"
+                           " used to add padding that avoids cache-set and 4K-aliasing"
+                           " conflicts when 'allow_addl_padding' is enabled."
+                           " If zero, the size is detected from the system.",
+                           _cache_conflict_bytes));
         #ifdef USE_MPI
         _add_domain_option(parser, "nr", "Num ranks", _num_ranks);
         _add_domain_option(parser, "ri", "This rank's logical index (0-based)", _rank_indices);
@@ -374,6 +381,12 @@ namespace yask {
                           ("overlap_comms",
                            "Overlap MPI communication with calculation of interior elements whenever possible.",
                            overlap_comms));
+        parser.add_option(make_shared<command_line_parser::bool_option>
+                          ("mpi_io",
+                           "Write and read checkpoints and snapshots using collective "
+                           "MPI-IO to one file shared by all ranks instead of one "
+                           "file per rank.",
+                           _mpi_io));
         parser.add_option(make_shared<command_line_parser::idx_option>
                           ("min_exterior",
                            "[Advanced] Minimum width of exterior section to"
@@ -399,6 +412,19 @@ namespace yask {
                            "Otherwise, use the same non-blocking MPI send and receive calls "
                            "that are used between nodes.",
                            use_shm));
+        parser.add_option(make_shared<command_line_parser::string_list_option>
+                          ("node_shared_vars",
+                           "[Advanced] Allocate each listed var once per node in an MPI shared-memory "
+                           "window instead of once per rank. Each rank uses its own sub-domain "
+                           "of the shared var. "
+                           "Only vars that are not written by the stencils may be listed, "
+                           "and each rank should only set the values in its own domain. "
+                           "Values set by a rank are seen by the other ranks on the node "
+                           "starting at the next call to run_solution(). "
+                           "The var is not shared if the ranks on a node do not cover a rectangular "
+                           "region with vector-aligned rank offsets. "
+                           "Var names must be separated by a single comma (',').",
+                           _node_shared_vars));
         parser.add_option(make_shared<command_line_parser::bool_option>
                           ("force_scalar_exchange",
                            "[Debug] Do not allow vectorized halo packing and unpacking.",
@@ -460,6 +486,99 @@ namespace yask {
                            "a single large chunk when possible. "
                            "If 'false', allocate each YASK var separately.",
                            _bundle_allocs));
+        parser.add_option(make_shared<command_line_parser::bool_option>
+                          ("first_touch",
+                           "[Advanced] Initialize newly-allocated vars to all zeros (0.0) "
+                           "in parallel, where each outer thread touches the slabs of the "
+                           "blocks it computes. Scratch vars are touched by the thread that "
+                           "uses them. This places memory pages near their compute threads "
+                           "under the OS's first-touch policy. Placement matches exactly "
+                           "only when blocks are statically scheduled, e.g., when using "
+                           "the slab NUMA policy; with the default dynamic schedule, it "
+                           "only adds a pass over all vars.",
+                           _first_touch));
+        parser.add_option(make_shared<command_line_parser::string_list_option>
+                          ("mmap_vars",
+                           "[Advanced] Store each listed var in its own memory-mapped file "
+                           "instead of in memory, allowing problems larger than the memory "
+                           "of a node. The files are created in the directory given by "
+                           "-mmap_dir with unique names and are unlinked as soon as they are mapped, "
+                           "so their space is released when the vars are freed. "
+                           "Set the mega-block size in the first domain dimension to "
+                           "process the domain in slabs that fit in memory. "
+                           "Var names must be separated by a single comma (',').",
+                           _mmap_vars));
+        parser.add_option(make_shared<command_line_parser::string_option>
+                          ("mmap_dir",
+                           "[Advanced] Directory for the files used by -mmap_vars, "
+                           "preferably on a fast local SSD.",
+                           _mmap_dir));
+        parser.add_option(make_shared<command_line_parser::bool_option>
+                          ("mmap_prefetch",
+                           "[Advanced] While computing each mega-block, advise the OS to "
+                           "read ahead the slab of each memory-mapped var needed by the "
+                           "next mega-block along the first domain dimension.",
+                           _mmap_prefetch));
+        parser.add_option(make_shared<command_line_parser::string_list_option>
+                          ("snapshot_vars",
+                           "Write the rank domain of each listed var to a file after each call to "
+                           "run_solution() that ends at a multiple of -snapshot_interval. "
+                           "The files are written by a background thread while the next "
+                           "steps are computed. "
+                           "Var names must be separated by a single comma (',').",
+                           _snapshot_vars));
+        parser.add_option(make_shared<command_line_parser::string_option>
+                          ("snapshot_prefix",
+                           "Prefix of the snapshot file names. Each file is named "
+                           "'<prefix>.<var>.t<step>.dat', with '.rank<index>' inserted "
+                           "before '.dat' when running on more than one rank.",
+                           _snapshot_prefix));
+        parser.add_option(make_shared<command_line_parser::idx_option>
+                          ("snapshot_interval",
+                           "Step interval between snapshots.",
+                           _snapshot_interval));
+        parser.add_option(make_shared<command_line_parser::string_option>
+                          ("snapshot_codec",
+                           "Compression of per-rank snapshot files, done by the background "
+                           "thread: 'none', 'xor' (lossless XOR of neighboring values), or "
+                           "'fixed' (lossy block quantization: each block of 64 values is "
+                           "scaled by its largest magnitude and rounded to -snapshot_rate "
+                           "bits per value). "
+                           "Compressed files start with a header and can be read back with "
+                           "read_snapshot(). Not available with -mpi_io.",
+                           _snapshot_codec));
+        parser.add_option(make_shared<command_line_parser::int_option>
+                          ("snapshot_rate",
+                           "Bits per value for the 'fixed' snapshot codec, from 2 to 32.",
+                           _snapshot_rate));
+        parser.add_option(make_shared<command_line_parser::string_option>
+                          ("ckpt_codec",
+                           "Compression of per-rank checkpoint files: 'none' or 'xor' "
+                           "(lossless XOR of neighboring values in the storage layout). "
+                           "The lossy 'fixed' codec cannot be used for checkpoints. "
+                           "Not available with -mpi_io.",
+                           _ckpt_codec));
+        parser.add_option(make_shared<command_line_parser::idx_option>
+                          ("rev_mem_states",
+                           "Max number of solution states kept in memory by run_reverse(). "
+                           "More states reduce the number of forward steps that are recomputed.",
+                           _rev_mem_states));
+        parser.add_option(make_shared<command_line_parser::idx_option>
+                          ("rev_disk_states",
+                           "Max number of additional solution states kept in checkpoint "
+                           "files by run_reverse().",
+                           _rev_disk_states));
+        parser.add_option(make_shared<command_line_parser::string_option>
+                          ("rev_state_prefix",
+                           "Prefix of the names of the checkpoint files written by run_reverse().",
+                           _rev_state_prefix));
+        parser.add_option(make_shared<command_line_parser::string_list_option>
+                          ("rev_vars",
+                           "Vars whose states are saved and restored by run_reverse(). "
+                           "If empty, the vars updated by the stencils are used, so "
+                           "other vars, e.g., those holding adjoint values, are not reverted. "
+                           "Var names must be separated by a single comma (',').",
+                           _rev_vars));
         parser.add_option(make_shared<command_line_parser::bool_option>
                           ("init_scratch_vars",
                            "[Advanced] Initialize scratch vars to all zeros (0.0) "
@@ -474,6 +593,8 @@ namespace yask {
                            " Use values >= 0 to specify the preferred NUMA node. "
                            " Use " + to_string(yask_numa_local) + " for local NUMA-node allocation. " +
                            " Use " + to_string(yask_numa_interleave) + " for interleaving pages across NUMA nodes. " +
+                           " Use " + to_string(yask_numa_slabs) + " for placing slabs of each var on the NUMA nodes "
+                           "of the outer threads that compute them. " +
                            #endif
                            #ifdef USE_OFFLOAD
                            " Use " + to_string(yask_numa_offload) + " for allocation optimized for offloading. " +
@@ -679,6 +800,22 @@ namespace yask {
             "  Num CPU threads per block = inner_threads.\n"
             "  Num CPU threads per micro-block, nano-block, and pico-block = 1.\n";
     }
+    idx_t KernelSettings::get_cache_conflict_bytes() const {
+        if (_cache_conflict_bytes > 0)
+            return _cache_conflict_bytes;
+
+        // Addresses 4KiB apart alias in load/store disambiguation
+        // regardless of the cache geometry.
+        idx_t nbytes = 4096;
+        #ifdef _SC_LEVEL1_DCACHE_ASSOC
+        long csize = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+        long cways = sysconf(_SC_LEVEL1_DCACHE_ASSOC);
+        if (csize > 0 && cways > 0)
+            nbytes = max(nbytes, idx_t(csize / cways));
+        #endif
+        return nbytes;
+    }
+
     void KernelSettings::print_values(ostream& os)
     {
         command_line_parser soln_parser;
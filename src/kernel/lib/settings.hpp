@@ -250,6 +250,7 @@ namespace yask {
         bool use_device_mpi = false;
         bool use_shm = true;
         #endif
+        string_vec _node_shared_vars; // read-only vars to alloc once per node.
 
         // OpenMP settings.
         int max_threads = 0;      // Initial number of host threads to use overall; 0=>OMP default.
@@ -265,13 +266,29 @@ namespace yask {
         // Var behavior, including allocation.
         bool _step_wrap = false; // Allow invalid step indices to alias to valid ones (set via APIs only).
         bool _allow_addl_pad = true; // Allow extending padding beyond what's needed for alignment.
+        idx_t _cache_conflict_bytes = 0; // Cache bytes per way for conflict padding; 0 => detect.
         #ifdef USE_OFFLOAD
         bool _bundle_allocs = false;
         #else
         bool _bundle_allocs = true;
         #endif
         int _numa_pref = NUMA_PREF;
+        bool _first_touch = false; // Touch new var pages from outer threads.
         bool _init_scratch_vars = false; // Init scratch vars to zero.
+        string_vec _mmap_vars;  // vars stored in memory-mapped files.
+        std::string _mmap_dir = "."; // dir for memory-mapped files.
+        bool _mmap_prefetch = true; // read ahead next slab of memory-mapped vars.
+        string_vec _snapshot_vars; // vars to write after run_solution().
+        std::string _snapshot_prefix = "snapshot"; // file-name prefix for snapshots.
+        idx_t _snapshot_interval = 1; // write snapshots at steps that are multiples of this.
+        std::string _snapshot_codec = "none"; // compression of snapshot files.
+        int _snapshot_rate = 16; // bits per value for 'fixed' codec.
+        std::string _ckpt_codec = "none"; // compression of per-rank checkpoint files.
+        idx_t _rev_mem_states = 8; // states kept in memory by run_reverse().
+        idx_t _rev_disk_states = 0; // states kept in checkpoint files by run_reverse().
+        std::string _rev_state_prefix = "revolve"; // file-name prefix for those states.
+        string_vec _rev_vars; // vars saved and restored by run_reverse().
+        bool _mpi_io = false; // write checkpoints and snapshots to shared files via MPI-IO.
 
         // Temporal blocking.
         bool _round_up_tb_angles = false; // Round up block and micro-block angles to fold lengths.
@@ -317,6 +334,10 @@ namespace yask {
         // Prints informational info to debug output in *ksb.
         virtual void adjust_settings(KernelStateBase* ksb = 0);
 
+        // Get number of bytes of memory that map to distinct sets in one
+        // way of the L1 cache, or 4K-aliasing period, whichever is larger.
+        idx_t get_cache_conflict_bytes() const;
+
         // Determine if this is the first or last rank in given dim.
         bool is_first_rank(const std::string dim) {
             return _rank_indices[dim] == 0;
@@ -383,9 +404,16 @@ namespace yask {
         // can communicate with shm. MPI_PROC_NULL otherwise.
         std::vector<int> shm_ranks;
 
+        // Whether this neighbor is on the same node,
+        // regardless of whether shm is used for halos.
+        std::vector<bool> is_node_neighbor;
+
         // Window for halo buffers.
         MPI_Win halo_win;
 
+        // Window for vars shared by all ranks on a node.
+        MPI_Win node_var_win;
+
         // Shm halo buffers for each neighbor.
         std::vector<void*> halo_buf_ptrs;
         std::vector<size_t> halo_buf_sizes;
@@ -408,6 +436,7 @@ namespace yask {
             man_dists.resize(neighborhood_size, 0);
             has_all_vlen_mults.resize(neighborhood_size, false);
             shm_ranks.resize(neighborhood_size, MPI_PROC_NULL);
+            is_node_neighbor.resize(neighborhood_size, false);
             halo_buf_ptrs.resize(neighborhood_size, 0);
             halo_buf_sizes.resize(neighborhood_size, 0);
         }
@@ -412,14 +412,17 @@ namespace yask {
 
                         // Determine whether neighbor is in my shm group.
                         // If so, record rank number in shmcomm.
-                        if (actl_opts->use_shm && env->shm_comm != MPI_COMM_NULL) {
+                        if (env->shm_comm != MPI_COMM_NULL) {
                             int g_rank = rn;
                             int s_rank = MPI_PROC_NULL;
                             MPI_Group_translate_ranks(env->group, 1, &g_rank,
                                                       env->shm_group, &s_rank);
                             if (s_rank != MPI_UNDEFINED) {
-                                mpi_info->shm_ranks.at(rn_ofs) = s_rank;
-                                DEBUG_MSG("  is MPI shared-memory rank " << s_rank);
+                                mpi_info->is_node_neighbor.at(rn_ofs) = true;
+                                if (actl_opts->use_shm) {
+                                    mpi_info->shm_ranks.at(rn_ofs) = s_rank;
+                                    DEBUG_MSG("  is MPI shared-memory rank " << s_rank);
+                                }
                             }
                         }
                     }
@@ -730,6 +733,10 @@ namespace yask {
         }
         assert(num_wf_shifts >= 0);
 
+        // Streamed values would be evicted before they are read by the
+        // next steps of a wave-front or temporal block.
+        corep()->_common_core._use_streaming = (wf_steps == 0);
+
         // Calculate angles and related settings.
         for (auto& dim : domain_dims) {
             auto& dname = dim._get_name();
@@ -237,6 +237,9 @@ namespace yask {
 
         init_work_stats();
 
+        // Start writer for snapshots.
+        _setup_snapshots();
+
         // User-provided code.
         call_hooks(_after_prepare_solution_hooks);
 
@@ -247,6 +250,12 @@ namespace yask {
         STATE_VARS(this);
         TRACE_MSG("end_solution()...");
 
+        // Finish writing snapshots.
+        if (_snapshot_writer) {
+            _snapshot_writer->flush();
+            _snapshot_writer.reset();
+        }
+
         // Release any MPI data.
         env->global_barrier();
         mpi_data.clear();
@@ -257,6 +266,7 @@ namespace yask {
                 continue;
             gp->release_storage();
         }
+        _mmap_var_ptrs.clear();
 
         // Reset threads to original value.
         set_max_threads();
@@ -328,7 +328,49 @@ namespace yask {
                 gb.update_valid_step(t_out);
         }
     }
-    
+
+    // Set all threads' fused-reduction values to the identities.
+    void StencilPartBase::reset_reductions(int nthreads) {
+        idx_t nred = red_var_names.size();
+        if (!nred) {
+            _red_vals.clear();
+            _red_thread_stride = 0;
+            return;
+        }
+
+        // Pad each thread's values to a whole number of cache lines.
+        const idx_t dpcl = CACHELINE_BYTES / sizeof(double);
+        _red_thread_stride = ROUND_UP(nred * _red_slot_size, dpcl);
+        _red_vals.resize(_red_thread_stride * std::max(nthreads, 1));
+        for (size_t i = 0; i < _red_vals.size(); i += _red_thread_stride) {
+            for (idx_t ri = 0; ri < nred; ri++) {
+                double* p = _red_vals.data() + i + ri * _red_slot_size;
+                p[0] = 0.0;
+                p[1] = 0.0;
+                p[2] = std::numeric_limits<double>::max();
+                p[3] = std::numeric_limits<double>::lowest();
+                p[4] = 0.0;
+            }
+        }
+    }
+
+    // Combine the fused-reduction values of all threads for
+    // the var at index 'ri' in 'red_var_names' into 'res'.
+    void StencilPartBase::join_reductions(int ri, YkVarBase::red_res& res) const {
+        assert(ri < int(red_var_names.size()));
+        res._mask |= red_masks.at(ri);
+        if (!_red_thread_stride)
+            return;
+        for (size_t i = 0; i < _red_vals.size(); i += _red_thread_stride) {
+            const double* p = _red_vals.data() + i + ri * _red_slot_size;
+            res._sum += p[0];
+            res._sum_sq += p[1];
+            res._min = std::min(res._min, p[2]);
+            res._max = std::max(res._max, p[3]);
+            res._nred += idx_t(p[4]);
+        }
+    }
+
     // Expand begin & end of 'idxs' by sizes of write halos.
     // Stride indices may also change.
     // NB: it is not necessary that the domain of each var
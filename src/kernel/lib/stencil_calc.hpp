@@ -58,6 +58,24 @@ namespace yask {
         // Max write halos for scratch parts on left and right in each dim.
         IdxTuple max_write_halo_left, max_write_halo_right;
 
+        // Fused-reduction values for each thread: '_red_slot_size'
+        // doubles for each var in 'red_var_names', padded to
+        // '_red_thread_stride' to avoid false sharing.
+        std::vector<double> _red_vals;
+        idx_t _red_thread_stride = 0;
+
+        // Get the fused-reduction values for the given thread.
+        inline double* get_red_vals(idx_t thread_slot) {
+            assert((thread_slot + 1) * _red_thread_stride <= idx_t(_red_vals.size()));
+            return _red_vals.data() + thread_slot * _red_thread_stride;
+        }
+        inline double* get_red_vals(int outer_thread_idx, int inner_thread_idx) {
+            STATE_VARS(this);
+            return get_red_vals(idx_t(outer_thread_idx) *
+                                std::max(actl_opts->num_inner_threads, 1) +
+                                inner_thread_idx);
+        }
+
         // Normalize the 'orig' indices, i.e., divide by vector len in each dim.
         // Ranks offsets must already be subtracted.
         // Each dim in 'orig' must be a multiple of corresponding vec len.
@@ -107,6 +125,15 @@ namespace yask {
         ScratchVecs output_scratch_vecs;
         ScratchVecs input_scratch_vecs;
 
+        // Vars with reductions of the values written by this part
+        // and the yk_var reduction mask for each.
+        std::vector<std::string> red_var_names;
+        std::vector<int> red_masks;
+
+        // Number of doubles per var in each thread's reduction values:
+        // sum, sum of squares, min, and max.
+        static constexpr int _red_slot_size = 5;
+
         // ctor, dtor.
         StencilPartBase(StencilContext* context) :
             ContextLinker(context) { }
@@ -136,6 +163,19 @@ namespace yask {
             return _scratch_children;
         }
 
+        // Add a fused reduction.
+        void add_reduction(const std::string& var_name, int mask) {
+            red_var_names.push_back(var_name);
+            red_masks.push_back(mask);
+        }
+
+        // Set all threads' fused-reduction values to the identities.
+        void reset_reductions(int nthreads);
+
+        // Combine the fused-reduction values of all threads for
+        // the var at index 'ri' in 'red_var_names' into 'res'.
+        void join_reductions(int ri, YkVarBase::red_res& res) const;
+
         // Get scratch children plus self.
         StencilPartList get_reqd_parts() {
             auto sg_list = get_scratch_children(); // Do children first.
@@ -344,6 +384,13 @@ namespace yask {
         calc_in_domain(int scratch_var_idx, const ScanIndices& misc_idxs) override {
             auto* cp = _corep();
 
+            // Accumulate fused reductions at the selected step. The
+            // reference code covers only this rank's domain. Its loops
+            // are not nested, so each thread is an outer thread.
+            bool red_ok = false;
+            if constexpr (StencilPartImplT::_num_reductions > 0)
+                red_ok = _context->is_reduction_step(misc_idxs.start[step_posn]);
+
             // Loop prefix.
             #define MISC_LOOP_INDICES misc_idxs
             #define MISC_BODY_INDICES misc_range
@@ -355,7 +402,8 @@ namespace yask {
             // then execute the reference scalar code.  TODO: fix domain of
             // scratch vars.
             if (_part.is_in_valid_domain(cp, misc_range.start))
-                _part.calc_scalar(cp, scratch_var_idx, misc_range.start);
+                calc_scalar_red(cp, scratch_var_idx, misc_range.start,
+                                red_ok ? get_red_vals(omp_get_thread_num(), 0) : nullptr);
 
             // Loop suffix.
             #define MISC_USE_LOOP_PART_1
@@ -363,20 +411,104 @@ namespace yask {
         }
         
         // Calculate results within a nano-block.
-        // Essentially just a chooser between the debug and optimized versions.
         void
         calc_nano_block(int outer_thread_idx,
                        int inner_thread_idx,
                        KernelSettings& settings,
                        const ScanIndices& micro_block_idxs) override {
+            STATE_VARS(this);
+
+            // Accumulate fused reductions only at the selected step and
+            // only within this rank's domain, i.e., not in any wave-front
+            // extensions, which neighbor ranks also calculate.
+            if constexpr (StencilPartImplT::_num_reductions > 0) {
+                if (_context->is_reduction_step(micro_block_idxs.start[step_posn])) {
+                    double* red_vals = get_red_vals(outer_thread_idx, inner_thread_idx);
+
+                    // Part of nano-block in this rank's domain.
+                    ScanIndices in_idxs(micro_block_idxs);
+                    bool any_in = true, all_in = true;
+                    DOMAIN_VAR_LOOP(i, j) {
+                        auto rbgn = _context->rank_domain_offsets[j];
+                        auto rend = rbgn + actl_opts->_rank_sizes[i];
+                        in_idxs.start[i] = std::max(micro_block_idxs.start[i], rbgn);
+                        in_idxs.stop[i] = std::min(micro_block_idxs.stop[i], rend);
+                        if (in_idxs.stop[i] <= in_idxs.start[i])
+                            any_in = false;
+                        if (in_idxs.start[i] != micro_block_idxs.start[i] ||
+                            in_idxs.stop[i] != micro_block_idxs.stop[i])
+                            all_in = false;
+                    }
+                    if (all_in) {
+                        calc_nano_block2(outer_thread_idx, inner_thread_idx,
+                                         settings, micro_block_idxs, red_vals);
+                        return;
+                    }
+                    if (any_in) {
+                        calc_nano_block2(outer_thread_idx, inner_thread_idx,
+                                         settings, in_idxs, red_vals);
+
+                        // Calculate the slabs outside the rank domain w/o
+                        // reductions: in each dim, those before and after
+                        // 'in_idxs', w/previous dims trimmed to 'in_idxs'.
+                        ScanIndices out_idxs(micro_block_idxs);
+                        DOMAIN_VAR_LOOP(i, j) {
+                            if (micro_block_idxs.start[i] < in_idxs.start[i]) {
+                                ScanIndices slab(out_idxs);
+                                slab.stop[i] = in_idxs.start[i];
+                                calc_nano_block2(outer_thread_idx, inner_thread_idx,
+                                                 settings, slab, nullptr);
+                            }
+                            if (in_idxs.stop[i] < micro_block_idxs.stop[i]) {
+                                ScanIndices slab(out_idxs);
+                                slab.start[i] = in_idxs.stop[i];
+                                calc_nano_block2(outer_thread_idx, inner_thread_idx,
+                                                 settings, slab, nullptr);
+                            }
+                            out_idxs.start[i] = in_idxs.start[i];
+                            out_idxs.stop[i] = in_idxs.stop[i];
+                        }
+                        return;
+                    }
+                }
+            }
+            calc_nano_block2(outer_thread_idx, inner_thread_idx,
+                             settings, micro_block_idxs, nullptr);
+        }
+
+        // Calculate results within a nano-block, accumulating fused
+        // reductions in 'red_vals' if not null.
+        // Essentially just a chooser between the debug and optimized versions.
+        void
+        calc_nano_block2(int outer_thread_idx,
+                         int inner_thread_idx,
+                         KernelSettings& settings,
+                         const ScanIndices& micro_block_idxs,
+                         double* red_vals) {
 
             // Choose between scalar debug and optimized impls.
             if (settings.force_scalar)
                 calc_nano_block_dbg(outer_thread_idx, inner_thread_idx,
-                                      settings, micro_block_idxs);
+                                    settings, micro_block_idxs, red_vals);
             else
                 calc_nano_block_opt(outer_thread_idx, inner_thread_idx,
-                                   settings, micro_block_idxs);
+                                    settings, micro_block_idxs, red_vals);
+        }
+
+        // Call the scalar code with or without fused reductions.
+        // Static to make sure offload doesn't need 'this'.
+        static void
+        calc_scalar_red(StencilCoreDataT* cp,
+                        int core_idx,
+                        const Indices& idxs,
+                        double* red_vals) {
+            if constexpr (StencilPartImplT::_num_reductions > 0) {
+                if (red_vals) {
+                    StencilPartImplT::template calc_scalar<true>(cp, core_idx, idxs, red_vals);
+                    return;
+                }
+            }
+            StencilPartImplT::calc_scalar(cp, core_idx, idxs);
         }
 
         // Calculate results for one nano-block using pure scalar code.
@@ -385,7 +517,8 @@ namespace yask {
         calc_nano_block_dbg(int outer_thread_idx,
                            int inner_thread_idx,
                            KernelSettings& settings,
-                           const ScanIndices& micro_block_idxs) {
+                           const ScanIndices& micro_block_idxs,
+                           double* red_vals) {
             STATE_VARS(this);
             TRACE_MSG("for part '" << get_name() << "': " <<
                       micro_block_idxs.make_range_str(false) <<
@@ -403,7 +536,7 @@ namespace yask {
             sb_idxs.stride.set_from_const(1);
             sb_idxs.align.set_from_const(1);
             
-            calc_nano_block_dbg2(cp, outer_thread_idx, sb_idxs);
+            calc_nano_block_dbg2(cp, outer_thread_idx, sb_idxs, red_vals);
         }
 
         // Scalar calc loop.
@@ -411,7 +544,8 @@ namespace yask {
         static void
         calc_nano_block_dbg2(StencilCoreDataT* cp,
                             int outer_thread_idx,
-                            const ScanIndices& misc_idxs) {
+                            const ScanIndices& misc_idxs,
+                            double* red_vals) {
 
             // Scan through n-D space.
             // Set OMP loop to offload; disable OMP on host.
@@ -430,7 +564,7 @@ namespace yask {
 
             // Loop body.
             // Since stride is always 1, we only need start indices.
-            StencilPartImplT::calc_scalar(cp, outer_thread_idx, misc_range.start);
+            calc_scalar_red(cp, outer_thread_idx, misc_range.start, red_vals);
 
             // Loop suffix.
             #define MISC_USE_LOOP_PART_1
@@ -445,7 +579,8 @@ namespace yask {
         calc_nano_block_opt(int outer_thread_idx,
                            int inner_thread_idx,
                            KernelSettings& settings,
-                           const ScanIndices& micro_block_idxs) {
+                           const ScanIndices& micro_block_idxs,
+                           double* red_vals) {
             STATE_VARS(this);
             TRACE_MSG("for part '" << get_name() << "': " <<
                       micro_block_idxs.make_range_str(false) <<
@@ -698,7 +833,7 @@ namespace yask {
                 // Perform the calculations in this block.
                 idx_t mask = idx_t(-1); // all elements.
                 calc_vectors_opt2(cp, outer_thread_idx, inner_thread_idx,
-                                  thread_limit, norm_fvidxs, mask);
+                                  thread_limit, norm_fvidxs, mask, red_vals);
                 
             } // whole vecs.
 
@@ -846,7 +981,8 @@ namespace yask {
                                 
                                 calc_vectors_opt2(cp,
                                                   outer_thread_idx, inner_thread_idx,
-                                                  thread_limit, pv_part, pv_mask);
+                                                  thread_limit, pv_part, pv_mask,
+                                                  red_vals);
                             }
                             //else TRACE_MSG("partial vectors not needed for " << descr);
                             
@@ -861,6 +997,7 @@ namespace yask {
         // Calculate a tile of vectors using the given mask.
         // All functions called from this one should be inlined.
         // Indices must be vec-len-normalized and rank-relative.
+        // Fused reductions are accumulated in 'red_vals' if not null.
         // Static to make sure offload doesn't need 'this'.
         static void
         calc_vectors_opt2(StencilCoreDataT* corep,
@@ -868,9 +1005,19 @@ namespace yask {
                           int inner_thread_idx,
                           int thread_limit,
                           ScanIndices& norm_idxs,
-                          bit_mask_t mask) {
+                          bit_mask_t mask,
+                          double* red_vals) {
 
             // Call code from stencil compiler.
+            if constexpr (StencilPartImplT::_num_reductions > 0) {
+                if (red_vals) {
+                    StencilPartImplT::template calc_vectors<true>(corep,
+                                                                  outer_thread_idx, inner_thread_idx,
+                                                                  thread_limit, norm_idxs, mask,
+                                                                  red_vals);
+                    return;
+                }
+            }
             StencilPartImplT::calc_vectors(corep,
                                            outer_thread_idx, inner_thread_idx,
                                            thread_limit, norm_idxs, mask);
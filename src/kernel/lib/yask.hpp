@@ -75,6 +75,9 @@ typedef int MPI_Status;
 #include <sstream>
 #include <stdexcept>
 #include <limits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include <malloc.h>
 #include <stddef.h>
@@ -86,6 +89,7 @@ typedef int MPI_Status;
 #include <stdint.h>
 #include <immintrin.h>
 #include <sys/mman.h>
+#include <fcntl.h>
 
 // Type for unsigned indices.
 typedef std::uint64_t uidx_t;
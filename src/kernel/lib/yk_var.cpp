@@ -195,11 +195,88 @@ namespace yask {
                     ", left-wf-exts = " << IDX_STR(_left_wf_exts) <<
                     ", right-wf-exts = " << IDX_STR(_right_wf_exts) <<
                     ", vec-strides = " << IDX_STR(_vec_strides);
+            if (_conflict_pads.get_num_dims() == get_num_dims())
+                oss << ", cache-conflict-pads = " << make_index_string(_conflict_pads);
             oss << ", " << _dirty_steps[self].size() << " dirty flag(s)";
         }
         return oss.str();
     }
 
+    // Number of multiples of each stride checked by
+    // _pad_for_cache_conflicts().  Accesses to this many consecutive
+    // indices in a dim should not map to the same cache set.
+    constexpr idx_t _conflict_mults = 8;
+
+    // Extend right pads to avoid strides in the domain dims that map
+    // nearby indices to the same cache sets or 4K-aliased addresses.
+    // A stride conflicts if any of its first '_conflict_mults' multiples
+    // is within a cache line of a multiple of the conflict size.  When it
+    // does, the next-inner domain dim in the layout is extended by one
+    // vector and the strides are checked again.
+    void YkVarBase::_pad_for_cache_conflicts(IdxTuple& new_allocs,
+                                             Indices& new_right_pads) {
+        STATE_VARS(this);
+        idx_t cbytes = actl_opts->get_cache_conflict_bytes();
+        if (cbytes <= CACHELINE_BYTES)
+            return;
+        const int ndims = get_num_dims();
+
+        // Limit number of adjustments in case padding can't fix a
+        // conflict, e.g., when the inner dims are all misc dims.
+        for (int iter = 0; iter < 16; iter++) {
+
+            // Set sizes to get strides from layout.
+            for (int i = 0; i < ndims; i++)
+                set_dim_size(i, new_allocs[i] / _corep->_var_vec_lens[i]);
+            auto strides = get_vec_strides();
+            idx_t nelems = 1;
+            for (int i = 0; i < ndims; i++)
+                nelems *= get_dim_size(i);
+            if (nelems <= 0)
+                return;
+            idx_t ebytes = get_num_bytes() / nelems;
+
+            // Find a conflicting domain dim and the domain dim just inside it.
+            int cposn = -1, iposn = -1;
+            for (int i = 0; i < ndims && cposn < 0; i++) {
+                if (!(_domain_dim_mask & (1LL << i)))
+                    continue;
+                idx_t sbytes = strides[i] * ebytes;
+                for (idx_t m = 1; m <= _conflict_mults; m++) {
+                    idx_t r = (m * sbytes) % cbytes;
+                    if (r < CACHELINE_BYTES || cbytes - r < CACHELINE_BYTES) {
+                        cposn = i;
+                        break;
+                    }
+                }
+                if (cposn < 0)
+                    continue;
+                for (int j = 0; j < ndims; j++)
+                    if ((_domain_dim_mask & (1LL << j)) &&
+                        strides[j] < strides[cposn] &&
+                        (iposn < 0 || strides[j] > strides[iposn]))
+                        iposn = j;
+
+                // Can't pad innermost domain dim to fix its own stride.
+                if (iposn < 0)
+                    cposn = -1;
+            }
+            if (cposn < 0)
+                return;
+
+            // Add one vector in inner dim.
+            auto svl = _corep->_soln_vec_lens[iposn];
+            new_right_pads[iposn] += svl;
+            new_allocs[iposn] += svl;
+            _conflict_pads[iposn] += svl;
+            TRACE_MSG("var '" << get_name() << "': stride of " <<
+                      make_byte_str(strides[cposn] * ebytes) << " in dim '" <<
+                      get_dim_name(cposn) << "' conflicts in " <<
+                      make_byte_str(cbytes) << " cache sets; extending dim '" <<
+                      get_dim_name(iposn) << "' by " << svl);
+        }
+    }
+
     // Resizes the underlying generic var.
     // Updates dependent core info.
     // Fails if mem different and already alloc'd.
@@ -316,6 +393,14 @@ namespace yask {
             }
         }
 
+        // Adjust padding to avoid cache conflicts.
+        // Only done before allocation, because it can change the sizes.
+        if (!p) {
+            _conflict_pads.set_from_const(0, get_num_dims());
+            if (actl_opts->_allow_addl_pad)
+                _pad_for_cache_conflicts(new_allocs, new_right_pads);
+        }
+
         // Attempt to change alloc with existing storage?
         if (p && old_allocs != new_allocs) {
             THROW_YASK_EXCEPTION("attempt to change allocation size of var '" +
@@ -546,6 +631,75 @@ namespace yask {
         return all_ok;
     }
 
+    // Add reductions of elements in a slice of this rank to 'res'.
+    void YkVarBase::reduce_elements_in_local_slice(red_res& res,
+                                                   const Indices& first_indices,
+                                                   const Indices& last_indices) const {
+        auto rp = reduce_elements_in_slice(res._mask, first_indices, last_indices,
+                                           true, false);
+        res.join(*dynamic_pointer_cast<red_res>(rp));
+    }
+
+    // Reduce elements in a slice across all ranks.  Each rank reduces
+    // only the part of the slice in its domain, so no element is
+    // counted twice. A var that is missing a domain dim is the same in
+    // all ranks along that dim, so only the first of those ranks
+    // contributes. A fixed-size var is local to each rank.
+    yk_var::yk_reduction_result_ptr
+    YkVarBase::reduce_elements_in_global_slice(int reduction_mask,
+                                               const Indices& first_indices,
+                                               const Indices& last_indices) const {
+        STATE_VARS(this);
+        const string fn = "reduce_elements_in_global_slice";
+        check_indices(first_indices, fn, false, false);
+        check_indices(last_indices, fn, false, false);
+        auto resp = make_shared<red_res>();
+        resp->_mask = reduction_mask;
+
+        // Clip to this rank's domain.
+        Indices first(first_indices), last(last_indices);
+        bool is_empty = false;
+        if (!_fixed_size) {
+            for (int j = 0; j < nddims; j++) {
+                auto& dname = domain_dims.get_dim_name(j);
+                int posn = get_dim_posn(dname);
+                if (posn < 0) {
+                    if (actl_opts->_rank_indices[j] != 0)
+                        is_empty = true;
+                    continue;
+                }
+                auto rfirst = _corep->_rank_offsets[posn];
+                auto rlast = rfirst + _corep->_domains[posn] - 1;
+                first[posn] = max(first[posn], rfirst);
+                last[posn] = min(last[posn], rlast);
+            }
+        }
+        for (int i = 0; i < get_num_dims(); i++)
+            if (last[i] < first[i])
+                is_empty = true;
+        if (!is_empty)
+            reduce_elements_in_local_slice(*resp, first, last);
+        TRACE_MSG(fn << ": " << resp->_nred << " element(s) reduced in this rank");
+
+        // Combine across ranks.
+        #ifdef USE_MPI
+        if (!_fixed_size && env->num_ranks > 1) {
+            double sums[3] { resp->_sum, resp->_sum_sq, double(resp->_nred) };
+            double maxs[2] { resp->_max, -resp->_min };
+            MPI_Allreduce(MPI_IN_PLACE, sums, 3, MPI_DOUBLE, MPI_SUM, env->comm);
+            MPI_Allreduce(MPI_IN_PLACE, maxs, 2, MPI_DOUBLE, MPI_MAX, env->comm);
+            if (reduction_mask & yk_var::yk_product_reduction)
+                MPI_Allreduce(MPI_IN_PLACE, &resp->_prod, 1, MPI_DOUBLE, MPI_PROD, env->comm);
+            resp->_sum = sums[0];
+            resp->_sum_sq = sums[1];
+            resp->_nred = idx_t(sums[2]);
+            resp->_max = maxs[0];
+            resp->_min = -maxs[1];
+        }
+        #endif
+        return resp;
+    }
+
     // Update what steps are valid.
     void YkVarBase::update_valid_step(idx_t t) {
         STATE_VARS(this);
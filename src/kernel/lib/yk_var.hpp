@@ -152,13 +152,16 @@ namespace yask {
                   "Needed for OpenMP offload");
 
     // Core data for YASK var of real elements.
-    template <typename LayoutFn, bool _use_step_idx>
+    // Elements are stored as type 'T', which is an unsigned int type
+    // for material-index vars; they are converted to/from 'real_t'
+    // on read/write.
+    template <typename LayoutFn, bool _use_step_idx, typename T = real_t>
     struct YkElemVarCore final : public YkVarBaseCore {
 
         // Core for generic storage is owned here by composition.
         // We do this to reduce the number of structs that need to be
         // copied to the offload device.
-        typedef GenericVarCore<real_t, LayoutFn> _data_t;
+        typedef GenericVarCore<T, LayoutFn> _data_t;
         static_assert(std::is_trivially_copyable<_data_t>::value,
                       "Needed for OpenMP offload");
         _data_t _data;
@@ -167,6 +170,24 @@ namespace yask {
         YkElemVarCore(int ndims) :
             YkVarBaseCore(ndims) { }
 
+        // Convert a real to an element.
+        // For material-index vars, the value is truncated and clamped
+        // to the range of 'T' because converting a negative,
+        // too-large, or NaN real to an unsigned int type is undefined.
+        ALWAYS_INLINE
+        static T to_elem(real_t val) {
+            if constexpr (std::is_same<T, real_t>::value)
+                return val;
+            else {
+                constexpr T maxv = std::numeric_limits<T>::max();
+                if (!(val > real_t(0)))
+                    return T(0);
+                if (val >= real_t(maxv))
+                    return maxv;
+                return T(val);
+            }
+        }
+
     protected:
 
         // Calc one adjusted index and recurse to i-1.
@@ -208,9 +229,9 @@ namespace yask {
         // 'alloc_step_idx' must be within allocation bounds and consistent
         // with 'idxs[step_posn]'.
         template <bool is_global>
-        const real_t* _get_elem_ptr(const Indices& idxs,
-                                    idx_t alloc_step_idx,
-                                    bool check_bounds) const {
+        const T* _get_elem_ptr(const Indices& idxs,
+                               idx_t alloc_step_idx,
+                               bool check_bounds) const {
             constexpr auto n = LayoutFn::get_num_sizes();
             Indices adj_idxs(n);
             _get_adj_idx<is_global, n - 1>(adj_idxs, idxs, alloc_step_idx);
@@ -221,37 +242,37 @@ namespace yask {
 
     public:
         ALWAYS_INLINE
-        const real_t* get_elem_ptr(const Indices& global_idxs,
-                                   idx_t alloc_step_idx,
-                                   bool check_bounds=true) const {
+        const T* get_elem_ptr(const Indices& global_idxs,
+                              idx_t alloc_step_idx,
+                              bool check_bounds=true) const {
             return _get_elem_ptr<true>(global_idxs, alloc_step_idx, check_bounds);
         }
         ALWAYS_INLINE
-        const real_t* get_elem_ptr_local(const Indices& local_idxs,
-                                         idx_t alloc_step_idx,
-                                         bool check_bounds=true) const {
+        const T* get_elem_ptr_local(const Indices& local_idxs,
+                                    idx_t alloc_step_idx,
+                                    bool check_bounds=true) const {
             return _get_elem_ptr<false>(local_idxs, alloc_step_idx, check_bounds);
         }
 
         // Non-const versions.
         // Implemented via casting.
         ALWAYS_INLINE
-        real_t* get_elem_ptr(const Indices& global_idxs,
-                             idx_t alloc_step_idx,
-                             bool check_bounds=true) {
-            const real_t* p =
+        T* get_elem_ptr(const Indices& global_idxs,
+                        idx_t alloc_step_idx,
+                        bool check_bounds=true) {
+            const T* p =
                 const_cast<const YkElemVarCore*>(this)->
                 get_elem_ptr(global_idxs, alloc_step_idx, check_bounds);
-            return const_cast<real_t*>(p);
+            return const_cast<T*>(p);
         }
         ALWAYS_INLINE
-        real_t* get_elem_ptr_local(const Indices& local_idxs,
-                                   idx_t alloc_step_idx,
-                                   bool check_bounds=true) {
-            const real_t* p =
+        T* get_elem_ptr_local(const Indices& local_idxs,
+                              idx_t alloc_step_idx,
+                              bool check_bounds=true) {
+            const T* p =
                 const_cast<const YkElemVarCore*>(this)->
                 get_elem_ptr_local(local_idxs, alloc_step_idx, check_bounds);
-            return const_cast<real_t*>(p);
+            return const_cast<T*>(p);
         }
 
         // Read one element.
@@ -259,8 +280,8 @@ namespace yask {
         ALWAYS_INLINE
         real_t read_elem(const Indices& idxs,
                          idx_t alloc_step_idx) const {
-            const real_t* ep = get_elem_ptr(idxs, alloc_step_idx);
-            return *ep;
+            const T* ep = get_elem_ptr(idxs, alloc_step_idx);
+            return real_t(*ep);
         }
 
         // Write one element.
@@ -269,8 +290,8 @@ namespace yask {
         void write_elem(real_t val,
                         const Indices& idxs,
                         idx_t alloc_step_idx) {
-            real_t* ep = get_elem_ptr(idxs, alloc_step_idx);
-            *ep = val;
+            T* ep = get_elem_ptr(idxs, alloc_step_idx);
+            *ep = to_elem(val);
         }
 
 
@@ -279,8 +300,8 @@ namespace yask {
         ALWAYS_INLINE
         real_t read_elem_local(const Indices& idxs,
                                idx_t alloc_step_idx) const {
-            const real_t* ep = get_elem_ptr_local(idxs, alloc_step_idx);
-            return *ep;
+            const T* ep = get_elem_ptr_local(idxs, alloc_step_idx);
+            return real_t(*ep);
         }
 
         // Write one element.
@@ -289,8 +310,8 @@ namespace yask {
         void write_elem_local(real_t val,
                               const Indices& idxs,
                               idx_t alloc_step_idx) {
-            real_t* ep = get_elem_ptr_local(idxs, alloc_step_idx);
-            *ep = val;
+            T* ep = get_elem_ptr_local(idxs, alloc_step_idx);
+            *ep = to_elem(val);
         }
 
     }; // YkElemVarCore.
@@ -557,6 +578,7 @@ namespace yask {
     class YkVarBase :
         public KernelStateBase {
         friend class YkVarImpl;
+        friend class YkPointSet;
 
     public:
 
@@ -575,10 +597,20 @@ namespace yask {
             double _sum = 0.0;
             double _sum_sq = 0.0;
             double _prod = 1.0;
-            double _max = std::numeric_limits<double>::min();
+            double _max = std::numeric_limits<double>::lowest();
             double _min = std::numeric_limits<double>::max();
 
             virtual ~red_res() { }
+
+            // Combine results from 'other' into these.
+            void join(const red_res& other) {
+                _nred += other._nred;
+                _sum += other._sum;
+                _sum_sq += other._sum_sq;
+                _prod *= other._prod;
+                _max = std::max(_max, other._max);
+                _min = std::min(_min, other._min);
+            }
         
             /// Get the allowed reductions.
             int get_reduction_mask() const {
@@ -598,7 +630,7 @@ namespace yask {
             }
             double get_sum_squares() const {
                 if (_mask & yk_var::yk_sum_squares_reduction)
-                    return _sum;
+                    return _sum_sq;
                 THROW_YASK_EXCEPTION("Sum-of-squares reduction result was not requested in reduction_mask");
             }
             double get_product() const {
@@ -612,7 +644,7 @@ namespace yask {
                 THROW_YASK_EXCEPTION("Max reduction result was not requested in reduction_mask");
             }
             double get_min() const {
-                if (_mask & yk_var::yk_sum_reduction)
+                if (_mask & yk_var::yk_min_reduction)
                     return _min;
                 THROW_YASK_EXCEPTION("Min reduction result was not requested in reduction_mask");
             }
@@ -655,6 +687,9 @@ namespace yask {
         // Whether this was created via an API.
         bool _is_user_var = false;
 
+        // Padding added in each dim by _pad_for_cache_conflicts().
+        Indices _conflict_pads;
+
         // Tracking flags for data modified since last halo exchange.
         // [self]: Data needs to be copied to neighbors' halos of this var.
         // [others]: Data *may* need to be copied from one or neighbors into
@@ -702,6 +737,11 @@ namespace yask {
         // Resize or fail if already allocated.
         void resize();
 
+        // Extend right pads to avoid cache-set conflicts between
+        // neighboring indices in the domain dims.
+        void _pad_for_cache_conflicts(IdxTuple& new_allocs,
+                                      Indices& new_right_pads);
+
         // Set my dirty flags in range.
         void set_dirty_in_slice(const Indices& first_indices,
                                 const Indices& last_indices);
@@ -788,6 +828,11 @@ namespace yask {
             return get_gvbp()->set_storage(base, offset);
         };
 
+        // Padding added to avoid cache conflicts.
+        const Indices& get_conflict_pads() const {
+            return _conflict_pads;
+        }
+
         // Num dims in this var.
         // Not necessarily same as stencil problem.
         inline int get_num_dims() const {
@@ -847,6 +892,11 @@ namespace yask {
         // Does this var cover the n-D domain?
         virtual bool is_domain_var() const;
 
+        // Are elements reals, i.e., not material indices?
+        virtual bool has_real_elems() const {
+            return true;
+        }
+
         // Scratch accessors.
         virtual bool is_scratch() const {
             return _is_scratch;
@@ -1016,6 +1066,20 @@ namespace yask {
                                  bool strict_indices,
                                  bool on_device) const =0;
 
+        // Reduce elements in a slice across all ranks.
+        // Must be called from all ranks.
+        virtual yk_var::yk_reduction_result_ptr
+        reduce_elements_in_global_slice(int reduction_mask,
+                                        const Indices& first_indices,
+                                        const Indices& last_indices) const;
+
+        // Add reductions of elements in a slice of this rank to 'res'
+        // using the reductions in 'res._mask'.
+        // Indices must be within the local allocation.
+        virtual void reduce_elements_in_local_slice(red_res& res,
+                                                    const Indices& first_indices,
+                                                    const Indices& last_indices) const;
+
         // Possibly vectorized version of set/get_elements_in_slice().
         virtual idx_t set_vecs_in_slice(const void* buffer_ptr,
                                         const Indices& first_indices,
@@ -1433,15 +1497,8 @@ namespace yask {
             resp->_nred = n;
 
             // Join per-thread results.
-            for (int i = 0; i < nthr; i++) {
-                auto* p = resp.get();
-                auto* resp = &rrv.at(i);
-                p->_sum += resp->_sum;
-                p->_sum_sq += resp->_sum;
-                p->_prod *= resp->_prod;
-                p->_max = std::max(p->_max, resp->_max);
-                p->_min = std::min(p->_min, resp->_min);
-            }
+            for (int i = 0; i < nthr; i++)
+                resp->join(rrv.at(i));
 
             return resp;
         }      
@@ -1452,12 +1509,16 @@ namespace yask {
     // YASK var of real elements.
     // Used for vars that do not contain folded vectors.
     // If '_use_step_idx', then index to step dim will wrap around.
-    template <typename LayoutFn, bool _use_step_idx>
+    // Elements are stored as type 'T'; see YkElemVarCore.
+    template <typename LayoutFn, bool _use_step_idx, typename T = real_t>
     class YkElemVar final : public YkVarBase {
 
     public:
         // Type for core data.
-        typedef YkElemVarCore<LayoutFn, _use_step_idx> core_t;
+        typedef YkElemVarCore<LayoutFn, _use_step_idx, T> core_t;
+
+        // Whether elements are reals, i.e., not material indices.
+        static constexpr bool _is_real = std::is_same<T, real_t>::value;
         static_assert(std::is_trivially_copyable<core_t>::value,
                       "Needed for OpenMP offload");
 
@@ -1470,7 +1531,7 @@ namespace yask {
         // Storage meta-data.
         // Owned here via composition.
         // This contains a pointer to _core._data.
-        GenericVar<real_t, LayoutFn> _data;
+        GenericVar<T, LayoutFn> _data;
 
         // Accessors to GenericVar.
         virtual GenericVarBase* get_gvbp() override final {
@@ -1531,37 +1592,53 @@ namespace yask {
         
         // Make a human-readable description.
         virtual std::string _make_info_string() const override final {
-            return _data.make_info_string("FP");
+            return _data.make_info_string(_is_real ? "FP" : "material-index");
+        }
+
+        // Are elements reals?
+        bool has_real_elems() const override final {
+            return _is_real;
         }
 
         // Init data.
         void set_all_elements_same(double val) override final {
             TRACE_MSG("setting all elements in '" + get_name() + "' to " << val);
             _coh._force_state(Coherency::not_init); // because all values will be written.
-            _data.set_elems_same(val);
+            _data.set_elems_same(core_t::to_elem(real_t(val)));
             set_dirty_all(self, true);
             _coh.mod_both();
         }
         void set_all_elements_in_seq(double seed) override final {
             TRACE_MSG("setting all elements in '" + get_name() + "' using seed " << seed);
             _coh._force_state(Coherency::not_init); // because all values will be written.
-            _data.set_elems_in_seq(seed);
+
+            // Material indices are set to small positive ints regardless of seed.
+            _data.set_elems_in_seq(_is_real ? T(seed) : T(1));
             set_dirty_all(self, true);
             _coh.mod_both();
         }
 
         // Get a pointer to given element.
+        // Not available for material-index vars.
         const real_t* get_elem_ptr(const Indices& idxs,
                                    idx_t alloc_step_idx,
                                    bool check_bounds=true) const override final {
-            return _core.get_elem_ptr(idxs, alloc_step_idx, check_bounds);
+            if constexpr (_is_real)
+                return _core.get_elem_ptr(idxs, alloc_step_idx, check_bounds);
+            else
+                THROW_YASK_EXCEPTION("cannot get a pointer to a real element in material-index var '" +
+                                     get_name() + "'");
         }
 
         // Non-const version.
         real_t* get_elem_ptr(const Indices& idxs,
                              idx_t alloc_step_idx,
                              bool check_bounds=true) override final {
-            return _core.get_elem_ptr(idxs, alloc_step_idx, check_bounds);
+            if constexpr (_is_real)
+                return _core.get_elem_ptr(idxs, alloc_step_idx, check_bounds);
+            else
+                THROW_YASK_EXCEPTION("cannot get a pointer to a real element in material-index var '" +
+                                     get_name() + "'");
         }
 
         // Read one element.
@@ -2128,12 +2205,233 @@ namespace yask {
             return _data.get_strides();
         }
 
+        // Split the slice from 'first_indices' to 'last_indices' into the
+        // part made of whole vectors and the slabs at its edges. Call
+        // 'edge_fn(first, last)' for each edge slab and then
+        // 'vec_fn(vfirst, vlast)' for the whole vectors. If there are no
+        // whole vectors, call 'edge_fn' once for the whole slice.
+        template <typename EdgeFn, typename VecFn>
+        void _visit_vecs_in_slice(const Indices& first_indices,
+                                  const Indices& last_indices,
+                                  EdgeFn edge_fn,
+                                  VecFn vec_fn) const {
+            const int nd = get_num_dims();
+
+            // Find the part of the slice made of whole vectors.
+            Indices vfirst(first_indices), vlast(last_indices);
+            bool any_vecs = true;
+            for (int i = 0; i < nd; i++) {
+                idx_t vl = _corep->_var_vec_lens[i];
+                if (vl > 1) {
+                    idx_t ofs = _corep->_rank_offsets[i];
+                    vfirst[i] = round_up_flr(first_indices[i] - ofs, vl) + ofs;
+                    vlast[i] = round_down_flr(last_indices[i] + 1 - ofs, vl) + ofs - 1;
+                    if (imod_flr(_corep->_local_offsets[i], vl) != 0)
+                        any_vecs = false;
+                }
+                if (vlast[i] < vfirst[i])
+                    any_vecs = false;
+            }
+            if (!any_vecs) {
+                edge_fn(first_indices, last_indices);
+                return;
+            }
+
+            // The edges: in each dim, the slabs before and after
+            // the vectors, with the previous dims trimmed to the vectors.
+            Indices efirst(first_indices), elast(last_indices);
+            for (int i = 0; i < nd; i++) {
+                if (first_indices[i] < vfirst[i]) {
+                    Indices slast(elast);
+                    slast[i] = vfirst[i] - 1;
+                    edge_fn(efirst, slast);
+                }
+                if (vlast[i] < last_indices[i]) {
+                    Indices sfirst(efirst);
+                    sfirst[i] = vlast[i] + 1;
+                    edge_fn(sfirst, elast);
+                }
+                efirst[i] = vfirst[i];
+                elast[i] = vlast[i];
+            }
+
+            // The vectors.
+            vec_fn(vfirst, vlast);
+        }
+
+        // Copy elements between a row-major buffer and the slice from
+        // 'first_indices' to 'last_indices' on the host. If 'to_var', copy
+        // from the buffer to *this; else, from *this to the buffer.  The
+        // part of the slice made of whole vectors is copied one vector at
+        // a time using a pre-computed map from each vector lane to its
+        // offset in the buffer. Only the elements at the edges of the
+        // slice use per-element index calculations.
+        template <typename T, bool to_var>
+        idx_t _copy_elements_in_slice(T* buffer_ptr,
+                                      size_t buffer_size,
+                                      const Indices& first_indices,
+                                      const Indices& last_indices) const {
+            STATE_VARS(this);
+            const char* fname = to_var ? "set_elements_in_slice" : "get_elements_in_slice";
+            if (get_storage() == 0)
+                THROW_YASK_EXCEPTION(std::string("call to '") + fname +
+                                     "' with no storage allocated for var '" +
+                                     get_name() + "'");
+            if (buffer_ptr == 0)
+                THROW_YASK_EXCEPTION(std::string("call to '") + fname +
+                                     "' with NULL buffer pointer");
+            check_indices(first_indices, fname, true, true);
+            check_indices(last_indices, fname, true, true);
+            const int nd = get_num_dims();
+            auto range = get_slice_range(first_indices, last_indices);
+            auto ne = range.product();
+            if (ne <= 0)
+                return 0;
+            if (buffer_size < size_t(ne))
+                THROW_YASK_EXCEPTION(std::string("call to '") + fname +
+                                     "' with buffer of size " +
+                                     std::to_string(buffer_size) + "; " +
+                                     std::to_string(ne) + " needed");
+            auto* varp = const_cast<YkVecVar*>(this);
+            const core_t* core_p = &_core;
+
+            // Strides of the buffer, which is in row-major order.
+            Indices bstrides(range);
+            bstrides[nd - 1] = 1;
+            for (int i = nd - 2; i >= 0; i--)
+                bstrides[i] = bstrides[i + 1] * range[i + 1];
+
+            // Copy the elements of a sub-slice one at a time.
+            auto copy_elems = [&](const Indices& sfirst, const Indices& slast) {
+                auto srange = get_slice_range(sfirst, slast);
+                srange.visit_all_points_in_parallel
+                    (false,
+                     [&](const Indices& ofs, size_t idx, int thread) {
+                         auto pt = sfirst.add_elements(ofs);
+                         idx_t bofs = 0;
+                         for (int i = 0; i < nd; i++)
+                             bofs += (pt[i] - first_indices[i]) * bstrides[i];
+                         idx_t ti = _has_step_dim ? _wrap_step(pt[+step_posn]) : 0;
+                         if constexpr (to_var)
+                             varp->write_elem(real_t(buffer_ptr[bofs]), pt, ti, __LINE__);
+                         else
+                             buffer_ptr[bofs] = T(read_elem(pt, ti, __LINE__));
+                         return true;    // keep going.
+                     });
+            };
+
+            // Copy the edges one element at a time and the rest one
+            // vector at a time.
+            _visit_vecs_in_slice
+                (first_indices, last_indices, copy_elems,
+                 [&](const Indices& vfirst_in, const Indices& vlast) {
+                     Indices vfirst(vfirst_in);
+
+                     // Offset in the buffer of each lane in a vector.
+                     idx_t lane_bofs[VLEN];
+                     bool is_contig = true;
+                     for (idx_t n = 0; n < VLEN; n++) {
+                         Indices fold_ofs(NUM_VEC_FOLD_DIMS);
+                         idx_t bofs = 0, r = n;
+                         for (int f = NUM_VEC_FOLD_DIMS - 1; f >= 0; f--) {
+                             idx_t fpts = dims->_vec_fold_pts[f];
+                             fold_ofs[f] = r % fpts;
+                             r /= fpts;
+                             bofs += fold_ofs[f] * bstrides[core_p->_vec_fold_posns[f]];
+                         }
+                         idx_t k = dims->get_elem_index_in_vec(fold_ofs);
+                         lane_bofs[k] = bofs;
+                     }
+                     for (idx_t k = 0; k < VLEN; k++)
+                         if (lane_bofs[k] != k)
+                             is_contig = false;
+
+                     // Vector indices.
+                     Indices firstv, lastv;
+                     check_indices(vfirst, fname, true, true, true, &firstv);
+                     check_indices(vlast, fname, true, true, true, &lastv);
+                     auto vec_range = get_slice_range(firstv, lastv);
+
+                     // Step index in outer loop.
+                     auto sp = +step_posn;
+                     idx_t first_t = 0, last_t = 0;
+                     if (_has_step_dim) {
+                         first_t = firstv[sp];
+                         last_t = lastv[sp];
+                         vec_range[sp] = 1;
+                     }
+
+                     // Whole range of last dim in each inner loop.
+                     auto ip = nd - 1;
+                     idx_t ni = vec_range[ip];
+                     vec_range[ip] = 1;
+                     idx_t si = core_p->_vec_strides[ip];
+                     idx_t bsi = _corep->_var_vec_lens[ip] * bstrides[ip];
+
+                     for (idx_t t = first_t; t <= last_t; t++) {
+                         idx_t ti = 0;
+                         if (_has_step_dim) {
+                             ti = _wrap_step(t);
+                             firstv[sp] = t;
+                             vfirst[sp] = t;
+                         }
+                         vec_range.visit_all_points_in_parallel
+                             (false,
+                              [&](const Indices& ofs, size_t idx, int thread) {
+                                  auto pt = firstv.add_elements(ofs);
+                                  auto* vp = const_cast<real_vec_t*>(core_p->get_vec_ptr_norm(pt, ti));
+
+                                  // Offset in buffer of first element of first vector.
+                                  idx_t bofs = 0;
+                                  for (int i = 0; i < nd; i++)
+                                      bofs += (vfirst[i] - first_indices[i] +
+                                               ofs[i] * _corep->_var_vec_lens[i]) * bstrides[i];
+
+                                  // Inner loop.
+                                  for (idx_t i = 0; i < ni; i++) {
+                                      T* bp = buffer_ptr + bofs;
+                                      if constexpr (to_var) {
+                                          real_vec_t v;
+                                          if (is_contig) {
+                                              REAL_VEC_LOOP(k)
+                                                  v[k] = real_t(bp[k]);
+                                          } else {
+                                              REAL_VEC_LOOP(k)
+                                                  v[k] = real_t(bp[lane_bofs[k]]);
+                                          }
+                                          v.store_to(vp);
+                                      } else {
+                                          real_vec_t v;
+                                          v.load_from(vp);
+                                          if (is_contig) {
+                                              REAL_VEC_LOOP(k)
+                                                  bp[k] = T(v[k]);
+                                          } else {
+                                              REAL_VEC_LOOP(k)
+                                                  bp[lane_bofs[k]] = T(v[k]);
+                                          }
+                                      }
+                                      vp += si;
+                                      bofs += bsi;
+                                  }
+                                  return true;    // keep going.
+                              });
+                     }
+                 });
+            return ne;
+        }
+
         // Read into buffer from *this.
         virtual idx_t get_elements_in_slice(double* buffer_ptr,
                                             size_t buffer_size,
                                             const Indices& first_indices,
                                             const Indices& last_indices,
                                             bool on_device) const override {
+            if (!on_device) {
+                const_copy_data_from_device();
+                return _copy_elements_in_slice<double, false>(buffer_ptr, buffer_size,
+                                                              first_indices, last_indices);
+            }
             return _get_elements_in_slice<double, YkVecVar>(buffer_ptr, buffer_size,
                                                             first_indices, last_indices,
                                                             on_device);
@@ -2143,6 +2441,11 @@ namespace yask {
                                             const Indices& first_indices,
                                             const Indices& last_indices,
                                             bool on_device) const override {
+            if (!on_device) {
+                const_copy_data_from_device();
+                return _copy_elements_in_slice<float, false>(buffer_ptr, buffer_size,
+                                                             first_indices, last_indices);
+            }
             return _get_elements_in_slice<float, YkVecVar>(buffer_ptr, buffer_size,
                                                            first_indices, last_indices,
                                                            on_device);
@@ -2154,6 +2457,9 @@ namespace yask {
                                             const Indices& first_indices,
                                             const Indices& last_indices,
                                             bool on_device) override {
+            if (!on_device)
+                return _set_elements_in_slice_host<double>(buffer_ptr, buffer_size,
+                                                           first_indices, last_indices);
             return _set_elements_in_slice<double, YkVecVar>(buffer_ptr, buffer_size,
                                                             first_indices, last_indices,
                                                             on_device);
@@ -2163,10 +2469,25 @@ namespace yask {
                                             const Indices& first_indices,
                                             const Indices& last_indices,
                                             bool on_device) override {
+            if (!on_device)
+                return _set_elements_in_slice_host<float>(buffer_ptr, buffer_size,
+                                                          first_indices, last_indices);
             return _set_elements_in_slice<float, YkVecVar>(buffer_ptr, buffer_size,
                                                            first_indices, last_indices,
                                                            on_device);
         }
+        template <typename T>
+        idx_t _set_elements_in_slice_host(const T* buffer_ptr,
+                                          size_t buffer_size,
+                                          const Indices& first_indices,
+                                          const Indices& last_indices) {
+            const_copy_data_from_device();
+            auto n = _copy_elements_in_slice<T, true>(const_cast<T*>(buffer_ptr), buffer_size,
+                                                      first_indices, last_indices);
+            _coh.mod_host();
+            set_dirty_in_slice(first_indices, last_indices);
+            return n;
+        }
 
         // Write to *this from val.
         virtual idx_t set_elements_in_slice_same(double val,
@@ -2190,7 +2511,107 @@ namespace yask {
                                                                first_indices, last_indices,
                                                                strict_indices, on_device);
         }
-        
+
+        // Add reductions of elements in a slice of this rank to 'res'.
+        // Whole vectors are reduced one vector at a time; the remaining
+        // elements at the edges of the slice use the scalar visitor.
+        virtual void reduce_elements_in_local_slice(red_res& res,
+                                                    const Indices& first_indices,
+                                                    const Indices& last_indices) const override final {
+            STATE_VARS(this);
+            const int nd = get_num_dims();
+            auto reduce_elems = [&](const Indices& sfirst, const Indices& slast) {
+                YkVarBase::reduce_elements_in_local_slice(res, sfirst, slast);
+            };
+
+            // Reduce the edges one element at a time and the rest one
+            // vector at a time.
+            _visit_vecs_in_slice
+                (first_indices, last_indices, reduce_elems,
+                 [&](const Indices& vfirst, const Indices& vlast) {
+                     const_copy_data_from_device();
+                     const core_t* core_p = &_core;
+                     Indices firstv, lastv;
+                     check_indices(vfirst, "reduce_elements_in_global_slice", true, true, true, &firstv);
+                     check_indices(vlast, "reduce_elements_in_global_slice", true, true, true, &lastv);
+                     auto vec_range = get_slice_range(firstv, lastv);
+                     res._nred += vec_range.product() * VLEN;
+
+                     // Step index in outer loop.
+                     auto sp = +step_posn;
+                     idx_t first_t = 0, last_t = 0;
+                     if (_has_step_dim) {
+                         first_t = firstv[sp];
+                         last_t = lastv[sp];
+                         vec_range[sp] = 1;
+                     }
+
+                     // Whole range of last dim in each inner loop.
+                     auto ip = nd - 1;
+                     idx_t ni = vec_range[ip];
+                     vec_range[ip] = 1;
+                     idx_t si = core_p->_vec_strides[ip];
+
+                     // One result for each thread.
+                     const int mask = res._mask;
+                     int nthr = yask_get_num_threads();
+                     std::vector<red_res> rrv(nthr);
+                     for (idx_t t = first_t; t <= last_t; t++) {
+                         idx_t ti = 0;
+                         if (_has_step_dim) {
+                             ti = _wrap_step(t);
+                             firstv[sp] = t;
+                         }
+                         vec_range.visit_all_points_in_parallel
+                             (false,
+                              [&](const Indices& ofs, size_t idx, int thread) {
+                                  assert(thread < nthr);
+                                  auto& rr = rrv[thread];
+                                  auto pt = firstv.add_elements(ofs);
+                                  auto* vp = core_p->get_vec_ptr_norm(pt, ti);
+
+                                  // Accumulate one row: max and min in vector
+                                  // registers; sums in double precision per lane.
+                                  double vsum[VLEN] = { 0.0 }, vsum_sq[VLEN] = { 0.0 };
+                                  real_vec_t vmax = std::numeric_limits<real_t>::lowest();
+                                  real_vec_t vmin = std::numeric_limits<real_t>::max();
+                                  for (idx_t i = 0; i < ni; i++) {
+                                      real_vec_t v;
+                                      v.load_from(vp);
+                                      if (mask & yk_var::yk_sum_reduction) {
+                                          REAL_VEC_LOOP(j)
+                                              vsum[j] += double(v[j]);
+                                      }
+                                      if (mask & yk_var::yk_sum_squares_reduction) {
+                                          REAL_VEC_LOOP(j)
+                                              vsum_sq[j] += double(v[j]) * double(v[j]);
+                                      }
+                                      if (mask & yk_var::yk_max_reduction)
+                                          vmax = yask_max(vmax, v);
+                                      if (mask & yk_var::yk_min_reduction)
+                                          vmin = yask_min(vmin, v);
+                                      if (mask & yk_var::yk_product_reduction) {
+                                          REAL_VEC_LOOP(j)
+                                              rr._prod *= v[j];
+                                      }
+                                      vp += si;
+                                  }
+
+                                  // Add row to thread's results.
+                                  REAL_VEC_LOOP(j) {
+                                      rr._sum += vsum[j];
+                                      rr._sum_sq += vsum_sq[j];
+                                      rr._max = std::max(rr._max, double(vmax[j]));
+                                      rr._min = std::min(rr._min, double(vmin[j]));
+                                  }
+                                  return true;    // keep going.
+                              });
+                     }
+                     for (auto& rr : rrv)
+                         res.join(rr);
+                 });
+        }
+
     };                          // YkVecVar.
 
     // Implementation of yk_var interface.  Class contains no real data,
@@ -2537,6 +2958,14 @@ namespace yask {
             const Indices last(last_indices);
             return reduce_elements_in_slice(reduction_mask, first, last, strict_indices, false);
         }
+        virtual yk_var::yk_reduction_result_ptr
+        reduce_elements_in_global_slice(int reduction_mask,
+                                        const idx_t_vec& first_indices,
+                                        const idx_t_vec& last_indices) {
+            const Indices first(first_indices);
+            const Indices last(last_indices);
+            return gb().reduce_elements_in_global_slice(reduction_mask, first, last);
+        }
         virtual idx_t set_elements_in_slice_same(double val,
                                                  const VarIndices& first_indices,
                                                  const VarIndices& last_indices,
@@ -2627,6 +3056,51 @@ namespace yask {
         virtual void set_storage(std::shared_ptr<char> base, size_t offset) {
             gb().set_storage(base, offset);
         }
+        virtual yk_point_set_ptr
+        new_point_set(const std::vector<double>& coords,
+                      int interp_type);
+    };
+
+    // Points with precomputed element offsets and weights.
+    // See point_set.cpp.
+    class YkPointSet : public yk_var::yk_point_set {
+    protected:
+        YkVarImpl _var;         // shares the var data.
+        idx_t _npts = 0;
+        idx_t _nlocal = 0;
+        idx_t _step_stride = 0; // elements between allocated steps.
+
+        // Elements and weights for each point in this rank's domain:
+        // entries [_pt_begin[i], _pt_begin[i+1]) are for point 'i'.
+        // Offsets are from the start of the storage at alloc step 0.
+        std::vector<idx_t> _pt_begin, _pt_offsets;
+        std::vector<real_t> _pt_weights;
+
+        // Same entries grouped by element, so each element is updated
+        // once without atomics: entries [_elem_begin[j], _elem_begin[j+1])
+        // are for element '_elem_offsets[j]'.
+        std::vector<idx_t> _elem_offsets, _elem_begin, _elem_pts;
+        std::vector<real_t> _elem_weights;
+
+        // Storage at 'step_index'.
+        real_t* _get_base(idx_t step_index, idx_t& alloc_step_idx) const;
+
+    public:
+        YkPointSet(const VarBasePtr& gbp,
+                   const std::vector<double>& coords,
+                   int interp_type);
+        virtual ~YkPointSet() { }
+
+        virtual idx_t get_num_points() const {
+            return _npts;
+        }
+        virtual idx_t get_num_local_points() const {
+            return _nlocal;
+        }
+        virtual idx_t add_to_elements(const double* vals,
+                                      idx_t step_index);
+        virtual void get_elements(double* vals,
+                                  idx_t step_index) const;
     };
 
 }                               // namespace.
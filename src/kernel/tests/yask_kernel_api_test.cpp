@@ -30,6 +30,7 @@ IN THE SOFTWARE.
 #include <iostream>
 #include <vector>
 #include <set>
+#include <algorithm>
 #include <sys/types.h>
 #include <unistd.h>
 #include <string.h>
@@ -371,6 +372,123 @@ int main(int argc, char** argv) {
         os << "Running for 4 more steps...\n";
         soln->run_solution(1, 4);
 
+        // Save the state, run more steps, and restore it.
+        yk_var_ptr var0;
+        for (auto var : soln->get_vars()) {
+            auto vdims = var->get_dim_names();
+            if (find(vdims.begin(), vdims.end(), soln->get_step_dim_name()) != vdims.end()) {
+                var0 = var;
+                break;
+            }
+        }
+        assert(var0);
+
+        // Find the rank domain of 'var0' at its last valid step.
+        auto ddims = soln->get_domain_dim_names();
+        auto ckpt_last_step = var0->get_last_valid_step_index();
+        idx_t_vec ckpt_first, ckpt_last;
+        size_t ckpt_nelems = 1, step_posn = 0;
+        for (auto& dname : var0->get_dim_names()) {
+            if (dname == soln->get_step_dim_name()) {
+                step_posn = ckpt_first.size();
+                ckpt_first.push_back(ckpt_last_step);
+                ckpt_last.push_back(ckpt_last_step);
+            }
+            else if (find(ddims.begin(), ddims.end(), dname) != ddims.end()) {
+                ckpt_first.push_back(soln->get_first_rank_domain_index(dname));
+                ckpt_last.push_back(soln->get_last_rank_domain_index(dname));
+            }
+            else {
+                ckpt_first.push_back(var0->get_first_local_index(dname));
+                ckpt_last.push_back(var0->get_last_local_index(dname));
+            }
+            ckpt_nelems *= ckpt_last.back() - ckpt_first.back() + 1;
+        }
+
+        // Set a point in its center so the next steps change the values
+        // around it, then save them.
+        idx_t_vec mid;
+        for (size_t i = 0; i < ckpt_first.size(); i++)
+            mid.push_back((ckpt_first[i] + ckpt_last[i]) / 2);
+        var0->set_element(1.0, mid);
+        vector<double> ckpt_vals(ckpt_nelems), vals(ckpt_nelems);
+        var0->get_elements_in_slice(ckpt_vals.data(), ckpt_nelems, ckpt_first, ckpt_last);
+        os << "Writing checkpoint...\n";
+        string ckpt_name = "yask_kernel_api_test.ckpt";
+        soln->write_checkpoint(ckpt_name);
+
+        os << "Running for 2 more steps...\n";
+        soln->run_solution(5, 6);
+        auto new_first = ckpt_first, new_last = ckpt_last;
+        new_first[step_posn] = new_last[step_posn] = var0->get_last_valid_step_index();
+        var0->get_elements_in_slice(vals.data(), ckpt_nelems, new_first, new_last);
+        assert(vals != ckpt_vals);
+        os << "Reading checkpoint...\n";
+        soln->read_checkpoint(ckpt_name);
+        assert(var0->get_last_valid_step_index() == ckpt_last_step);
+        var0->get_elements_in_slice(vals.data(), ckpt_nelems, ckpt_first, ckpt_last);
+        assert(vals == ckpt_vals);
+        unlink(ckpt_name.c_str());
+        if (env->get_num_ranks() > 1)
+            unlink((ckpt_name + ".rank" + to_string(env->get_rank_index())).c_str());
+
+        // Inject at and extract from a point between elements
+        // near the center of the overall domain.
+        if (var0->get_num_dims() == int(ddims.size()) + 1) {
+            os << "Injecting at and extracting from a point...\n";
+            vector<double> coords;
+            for (auto& dname : ddims)
+                coords.push_back(soln->get_overall_domain_size(dname) / 2 + 0.25);
+            auto pts = var0->new_point_set(coords, yk_var::yk_linear_interp);
+            assert(pts->get_num_points() == 1);
+            double before = 0.0, after = 0.0, src = 1.0;
+            pts->get_elements(&before, ckpt_last_step);
+            pts->add_to_elements(&src, ckpt_last_step);
+            pts->get_elements(&after, ckpt_last_step);
+            os << "  value changed from " << before << " to " << after << ".\n";
+            assert(after > before);
+
+            // Set the domain in each rank and reduce over all ranks.
+            os << "Reducing over the overall domain...\n";
+            idx_t_vec first, last, rfirst, rlast;
+            first.push_back(ckpt_last_step);
+            last.push_back(ckpt_last_step);
+            rfirst = first;
+            rlast = last;
+            idx_t npts = 1;
+            for (auto& dname : ddims) {
+                first.push_back(0);
+                last.push_back(soln->get_overall_domain_size(dname) - 1);
+                rfirst.push_back(soln->get_first_rank_domain_index(dname));
+                rlast.push_back(soln->get_last_rank_domain_index(dname));
+                npts *= soln->get_overall_domain_size(dname);
+            }
+            var0->set_elements_in_slice_same(0.5, rfirst, rlast);
+            auto rp = var0->reduce_elements_in_global_slice(yk_var::yk_sum_reduction |
+                                                            yk_var::yk_max_reduction,
+                                                            first, last);
+            os << "  sum of " << rp->get_num_elements_reduced() << " elements is " <<
+                rp->get_sum() << ".\n";
+            assert(rp->get_num_elements_reduced() == npts);
+            assert(rp->get_sum() == 0.5 * npts);
+            assert(rp->get_max() == 0.5);
+        }
+
+        // Visit 3 steps in reverse order, accumulating into a var that is
+        // not updated by the stencils, so it must not be restored.
+        os << "Running 3 steps in reverse order...\n";
+        auto fidxs = fvar->get_first_local_index_vec();
+        fvar->set_element(0.0, fidxs);
+        idx_t nadj = 0;
+        soln->run_reverse(5, 7,
+                          [&](yk_solution& sol, idx_t first, idx_t last) {
+                              assert(first == 7 - nadj);
+                              fvar->add_to_element(1.0, fidxs);
+                              nadj++;
+                          });
+        assert(nadj == 3);
+        assert(fvar->get_element(fidxs) == 3.0);
+
         soln->end_solution();
         soln->get_stats();
         env->finalize();
@@ -379,6 +379,45 @@ namespace {
     // '-stencil' commmand-line option or the 'stencil=' build option.
     REGISTER_SOLUTION(TestMisc2dStencil);
 
+    // Test material-index vars used to look up values in tables.
+    class TestMaterialStencil3 : public TestBase {
+
+    protected:
+
+        // Misc index for the table entries.
+        MAKE_MISC_INDEX(m);
+
+        // Vars.
+        MAKE_VAR(A, t, x, y, z); // time-varying var.
+        MAKE_VAR(M, x, y, z); // 8-bit material index.
+        MAKE_VAR(N, y); // 16-bit material index.
+        MAKE_VAR(P, m); // tables indexed by material.
+        MAKE_VAR(Q, m);
+        MAKE_VAR(R, z, m); // table that also varies in 'z'.
+
+    public:
+
+        TestMaterialStencil3(int radius=1) :
+            TestBase("test_material_3d", radius) { }
+
+        // Define equation to apply to all points in 'A' var.
+        virtual void define() {
+            M.get_var()->set_material_index_bytes(1);
+            N.get_var()->set_material_index_bytes(2);
+
+            // Mix table lookups at various offsets with a regular stencil.
+            A(t+1, x, y, z) EQUALS
+                def_t3d(A, t, x, 0, 1, y, 1, 0, z, 0, 0) * P(M(x, y, z)) +
+                Q(M(x+1, y, z-1)) - P(M(x, y-1, z)) +
+                Q(N(y)) + R(z, N(y+1));
+        }
+    };
+
+    // Create an object of type 'TestMaterialStencil3',
+    // making it available in the YASK compiler utility via the
+    // '-stencil' commmand-line option or the 'stencil=' build option.
+    REGISTER_SOLUTION(TestMaterialStencil3);
+
     // "Stream-like" stencils that just read and write
     // with no spatial offsets.
     // The radius controls how many reads are done in the time domain.
@@ -870,6 +909,53 @@ namespace {
     // '-stencil' commmand-line option or the 'stencil=' build option.
     REGISTER_SOLUTION(TestBoundaryStencil3);
 
+    // Test fused reductions, including a var written in two sub-domains.
+    class TestReductionStencil3 : public TestBase {
+
+    protected:
+
+        // Vars.
+        MAKE_VAR(A, t, x, y, z); // time-varying var.
+        MAKE_VAR(B, t, x, y, z); // time-varying var.
+
+    public:
+
+        TestReductionStencil3(int radius=2) :
+            TestBase("test_reduction_3d", radius) { }
+
+        // Define equation to apply to all points in 'A' and 'B' vars.
+        virtual void define() {
+
+            // Sub-domain is rectangle interior.
+            auto sd0 =
+                (x >= first_domain_index(x) + 5) && (x <= last_domain_index(x) - 3) &&
+                (y >= first_domain_index(y) + 4) && (y <= last_domain_index(y) - 6) &&
+                (z >= first_domain_index(z) + 6) && (z <= last_domain_index(z) - 4);
+
+            // Reduce A over both sub-domains.
+            int amask = yc_equation_node::yc_sum_reduction |
+                yc_equation_node::yc_sum_squares_reduction;
+            auto eq0 = A(t+1, x, y, z) EQUALS
+                def_t3d(A, t, x, 0, 2, y, 1, 0, z, 0, 1) IF_DOMAIN sd0;
+            eq0->set_reductions(amask);
+            auto eq1 = A(t+1, x, y, z) EQUALS
+                def_t3d(A, t, x, 1, 0, y, 0, 2, z, 1, 0) IF_DOMAIN !sd0;
+            eq1->set_reductions(amask);
+
+            // Reduce B everywhere.
+            auto eq2 = B(t+1, x, y, z) EQUALS
+                B(t, x, y, z) - A(t, x, y+1, z) + A(t, x, y, z-1);
+            eq2->set_reductions(yc_equation_node::yc_min_reduction |
+                                yc_equation_node::yc_max_reduction |
+                                yc_equation_node::yc_sum_reduction);
+        }
+    };
+
+    // Create an object of type 'TestReductionStencil3',
+    // making it available in the YASK compiler utility via the
+    // '-stencil' commmand-line option or the 'stencil=' build option.
+    REGISTER_SOLUTION(TestReductionStencil3);
+
     // Test step condition.
     class TestStepCondStencil1 : public TestBase {
 
@@ -994,6 +1080,43 @@ namespace {
     // '-stencil' commmand-line option or the 'stencil=' build option.
     REGISTER_SOLUTION(TestFuncStencil1);
 
+    // A stencil that uses every math function that has an inline SIMD
+    // version, for testing the 'vec_math' build option.  Each value
+    // stays bounded, and the args of 'sqrt' and 'log' are never
+    // negative.
+    class TestMathStencil1 : public TestBase {
+
+    protected:
+
+        // Vars.
+        MAKE_VAR(A, t, x);
+        MAKE_VAR(B, t, x);
+        MAKE_VAR(C, t, x);
+
+    public:
+
+        TestMathStencil1(int radius=1) :
+            TestBase("test_math_1d", radius) { }
+
+        virtual void define() {
+
+            // 'A' is in [-2, 2].
+            A(t+1, x) EQUALS sin(A(t, x-1)) + cos(A(t, x+1));
+
+            // 'B' is positive.
+            B(t+1, x) EQUALS exp(-fabs(A(t, x))) * log(2.0 + B(t, x) * B(t, x));
+
+            // 'C' is in (-pi/2 - 1, pi/2 + 1).
+            C(t+1, x) EQUALS atan(cbrt(C(t, x) - B(t, x+1))) +
+                erf(sqrt(fabs(A(t, x-1)) + B(t, x)));
+        }
+    };
+
+    // Create an object of type 'TestMathStencil1',
+    // making it available in the YASK compiler utility via the
+    // '-stencil' commmand-line option or the 'stencil=' build option.
+    REGISTER_SOLUTION(TestMathStencil1);
+
     // A stencil that no vars and no stencil equation.
     // Kernel must be built with domain_dims and step_dim options.
     class TestEmptyStencil0: public TestBase {